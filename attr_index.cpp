@@ -0,0 +1,296 @@
+// attr_index.cpp
+
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE                          
+*               National Center for Biotechnology Information
+*                                                                          
+*  This software/database is a "United States Government Work" under the   
+*  terms of the United States Copyright Act.  It was written as part of    
+*  the author's official duties as a United States Government employee and 
+*  thus cannot be copyrighted.  This software/database is freely available 
+*  to the public for use. The National Library of Medicine and the U.S.    
+*  Government have not placed any restriction on its use or reproduction.  
+*                                                                          
+*  Although all reasonable efforts have been taken to ensure the accuracy  
+*  and reliability of the software and data, the NLM and the U.S.          
+*  Government do not and cannot warrant the performance or results that    
+*  may be obtained by using this software or data. The NLM and the U.S.    
+*  Government disclaim all warranties, express or implied, including       
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.                                                                
+*                                                                          
+*  Please cite the author in any work or product based on this material.   
+*
+* ===========================================================================
+*
+* Author: Vyacheslav Brover
+*
+* File Description:
+*   Binary inverted index of attributes
+*
+*/
+
+
+#undef NDEBUG
+#include "common.inc"
+
+#include "attr_index.hpp"
+
+
+
+
+namespace Common_sp
+{
+ 
+
+
+#ifndef _MSC_VER
+
+// AttrIndex
+
+namespace
+{
+  
+constexpr size_t header_size = 8/*magic*/ + 5 * sizeof (uint64_t);
+
+
+size_t align8 (size_t n)
+  { return (n + 7) / 8 * 8; }
+
+}
+
+
+
+AttrIndex::AttrIndex (const string &fName)
+: mf (new MappedFile (fName))
+{
+  const string_view data (mf->getView ());
+  const auto bad = [&fName] () { return runtime_error ("Invalid attribute index file " + shellQuote (fName)); };
+  if (data. size () < header_size)
+    throw bad ();
+  if (data. substr (0, 8) != magic)
+    throw bad ();
+  const uint64_t* h = reinterpret_cast<const uint64_t*> (data. data () + 8);
+  objs_size  = (size_t) h [0];
+  attrs_size = (size_t) h [1];
+  const size_t objNames_size  = (size_t) h [2];
+  const size_t attrNames_size = (size_t) h [3];
+  const size_t postings_size  = (size_t) h [4];
+  if (data. size () !=   header_size 
+                       + sizeof (uint64_t) * (objs_size + 1 + 3 * (attrs_size + 1) - 1) 
+                       + align8 (objNames_size) 
+                       + align8 (attrNames_size) 
+                       + postings_size
+     )
+    throw bad ();
+  
+  const char* p = data. data () + header_size;
+  objOffsets     = reinterpret_cast<const uint64_t*> (p);  p += sizeof (uint64_t) * (objs_size + 1);
+  attrOffsets    = reinterpret_cast<const uint64_t*> (p);  p += sizeof (uint64_t) * (attrs_size + 1);
+  postingOffsets = reinterpret_cast<const uint64_t*> (p);  p += sizeof (uint64_t) * (attrs_size + 1);
+  textSizes      = reinterpret_cast<const uint64_t*> (p);  p += sizeof (uint64_t) * attrs_size;
+  objNames  = p;  p += align8 (objNames_size);
+  attrNames = p;  p += align8 (attrNames_size);
+  postings = reinterpret_cast<const unsigned char*> (p);
+  
+  if (   objOffsets     [objs_size]  != objNames_size
+      || attrOffsets    [attrs_size] != attrNames_size
+      || postingOffsets [attrs_size] != postings_size
+     )
+    throw bad ();
+}
+
+
+
+void AttrIndex::dir2file (const string &dirName,
+                          const string &fName)
+{
+  StringVector attrs;
+  {
+    DirItemGenerator dig (1000, dirName, false);  // PAR
+    attrs = dig. toVector ();
+  }
+  attrs. sort ();
+  QC_ASSERT (attrs. isUniq ());
+  
+  // Object numbers in the order of appearance
+  StringVector objs;
+  Vector<vector<ObjNum>> attrPostings;  attrPostings. reserve (attrs. size ());
+  Vector<uint64_t> attrTextSizes;  attrTextSizes. reserve (attrs. size ());
+  {
+    unordered_map<string,ObjNum> obj2num;
+    Progress prog (attrs. size (), 1000);  // PAR
+    for (const string& attr : attrs)
+    {
+      prog (attr);
+      const string attrFName (dirName + "/" + attr);
+      attrTextSizes << (uint64_t) getFileSize (attrFName);
+      vector<ObjNum> posting;
+      LineInput f (attrFName);
+      while (f. nextLine ())
+      {
+        trim (f. line);
+        const auto it = obj2num. find (f. line);
+        if (it == obj2num. end ())
+        {
+          if (objs. size () >= (size_t) numeric_limits<ObjNum>::max ())
+            throw runtime_error ("Too many objects");
+          const ObjNum num = (ObjNum) objs. size ();
+          obj2num [f. line] = num;
+          objs << f. line;
+          posting. push_back (num);
+        }
+        else
+          posting. push_back (it->second);
+      }
+      attrPostings << move (posting);
+    }
+  }
+  
+  // Sorted object numbers
+  {
+    Vector<ObjNum> order;  order. reserve (objs. size ());
+    FFOR (size_t, i, objs. size ())
+      order << (ObjNum) i;
+    Common_sp::sort (order, [&objs] (ObjNum a, ObjNum b) { return objs [a] < objs [b]; });
+    Vector<ObjNum> old2new (objs. size (), 0);
+    StringVector sortedObjs;  sortedObjs. reserve (objs. size ());
+    FFOR (size_t, i, order. size ())
+    {
+      old2new [order [i]] = (ObjNum) i;
+      sortedObjs << move (objs [order [i]]);
+    }
+    objs = move (sortedObjs);
+    for (vector<ObjNum>& posting : attrPostings)
+    {
+      for (ObjNum& num : posting)
+        num = old2new [num];
+      std::sort (posting. begin (), posting. end ());
+    }
+  }
+  
+  // Postings
+  string postingsS;
+  Vector<uint64_t> postingOffsets_;  postingOffsets_. reserve (attrs. size () + 1);
+  for (const vector<ObjNum>& posting : attrPostings)
+  {
+    postingOffsets_ << postingsS. size ();
+    ObjNum prev = 0;
+    for (const ObjNum num : posting)
+    {
+      ASSERT (num >= prev);
+      uint32_t delta = num - prev;
+      // Varint
+      while (delta >= 0x80)
+      {
+        postingsS += (char) ((delta & 0x7F) | 0x80);
+        delta >>= 7;
+      }
+      postingsS += (char) delta;
+      prev = num;
+    }
+  }
+  postingOffsets_ << postingsS. size ();
+  
+  const auto strings2offsets = [] (const StringVector &vec, string &blob)
+    { Vector<uint64_t> offsets;  offsets. reserve (vec. size () + 1);
+      for (const string& s : vec)
+      { offsets << blob. size ();
+        blob += s;
+      }
+      offsets << blob. size ();
+      return offsets;
+    };
+  string objNamesS;
+  string attrNamesS;
+  const Vector<uint64_t> objOffsets_  (strings2offsets (objs,  objNamesS));
+  const Vector<uint64_t> attrOffsets_ (strings2offsets (attrs, attrNamesS));
+  
+  ofstream f (fName, ios::binary);
+  const auto writeU64 = [&f] (const Vector<uint64_t> &vec)
+    { f. write (reinterpret_cast<const char*> (vec. data ()), (streamsize) (vec. size () * sizeof (uint64_t))); };
+  const auto writePadded = [&f] (const string &s)
+    { f. write (s. data (), (streamsize) s. size ());
+      f << string (align8 (s. size ()) - s. size (), '\0');
+    };
+  f << magic;
+  writeU64 (Vector<uint64_t> {objs. size (), attrs. size (), objNamesS. size (), attrNamesS. size (), postingsS. size ()});
+  writeU64 (objOffsets_);
+  writeU64 (attrOffsets_);
+  writeU64 (postingOffsets_);
+  writeU64 (attrTextSizes);
+  writePadded (objNamesS);
+  writePadded (attrNamesS);
+  f. write (postingsS. data (), (streamsize) postingsS. size ());
+  if (! f. good ())
+    throw runtime_error ("Cannot write file " + shellQuote (fName));
+}
+
+
+
+void AttrIndex::qc () const
+{
+  if (! qc_on)
+    return;
+  
+  QC_ASSERT (mf. get ());
+  FFOR_START (size_t, i, 1, objs_size)
+    QC_ASSERT (getObj ((ObjNum) (i - 1)) < getObj ((ObjNum) i));
+  FFOR_START (size_t, i, 1, attrs_size)
+    QC_ASSERT (getAttr (i - 1) < getAttr (i));
+  FFOR (size_t, i, attrs_size)
+    QC_ASSERT (postingOffsets [i] <= postingOffsets [i + 1]);
+}
+
+
+
+size_t AttrIndex::findAttr (string_view attr) const
+{
+  size_t lo = 0;
+  size_t hi = attrs_size;
+  while (lo < hi)
+  {
+    const size_t mid = (lo + hi) / 2;
+    if (getAttr (mid) < attr)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo < attrs_size && getAttr (lo) == attr)
+    return lo;
+  return no_index;
+}
+
+
+
+void AttrIndex::getPosting (size_t attrNum,
+                            vector<ObjNum> &objNums) const
+{
+  objNums. clear ();
+  const unsigned char* p   = postings + postingOffsets [attrNum];
+  const unsigned char* end = postings + postingOffsets [attrNum + 1];
+  ObjNum num = 0;
+  while (p < end)
+  {
+    uint32_t delta = 0;
+    uint shift = 0;
+    while (*p & 0x80)
+    {
+      delta |= (uint32_t) (*p & 0x7F) << shift;
+      shift += 7;
+      p++;
+    }
+    delta |= (uint32_t) *p << shift;
+    p++;
+    num += delta;
+    ASSERT (num < objs_size);
+    objNums. push_back (num);
+  }
+}
+
+#endif
+
+
+
+}
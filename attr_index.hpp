@@ -0,0 +1,109 @@
+// attr_index.hpp
+
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE                          
+*               National Center for Biotechnology Information
+*                                                                          
+*  This software/database is a "United States Government Work" under the   
+*  terms of the United States Copyright Act.  It was written as part of    
+*  the author's official duties as a United States Government employee and 
+*  thus cannot be copyrighted.  This software/database is freely available 
+*  to the public for use. The National Library of Medicine and the U.S.    
+*  Government have not placed any restriction on its use or reproduction.  
+*                                                                          
+*  Although all reasonable efforts have been taken to ensure the accuracy  
+*  and reliability of the software and data, the NLM and the U.S.          
+*  Government do not and cannot warrant the performance or results that    
+*  may be obtained by using this software or data. The NLM and the U.S.    
+*  Government disclaim all warranties, express or implied, including       
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.                                                                
+*                                                                          
+*  Please cite the author in any work or product based on this material.   
+*
+* ===========================================================================
+*
+* Author: Vyacheslav Brover
+*
+* File Description:
+*   Binary inverted index of attributes
+*
+*/
+
+
+#ifndef ATTR_INDEX_HPP_20461  // random number
+#define ATTR_INDEX_HPP_20461
+
+
+#include "common.hpp"
+using namespace Common_sp;
+
+
+
+namespace Common_sp
+{
+
+
+
+#ifndef _MSC_VER
+struct AttrIndex : Root
+// Single-file inverted index: attribute -> object numbers
+// Object names and attribute names are sorted dictionaries
+// Posting list of an attribute: sorted object numbers (with repetitions) as varint-encoded deltas
+// File: memory-mapped, numbers are native-endian
+{
+  typedef  uint32_t  ObjNum;
+private:
+  unique_ptr<const MappedFile> mf;
+  size_t objs_size {0};
+  size_t attrs_size {0};
+  const uint64_t* objOffsets {nullptr};
+    // size() = objs_size + 1
+  const uint64_t* attrOffsets {nullptr};
+    // size() = attrs_size + 1
+  const uint64_t* postingOffsets {nullptr};
+    // size() = attrs_size + 1
+  const uint64_t* textSizes {nullptr};
+    // size() = attrs_size
+  const char* objNames {nullptr};
+  const char* attrNames {nullptr};
+  const unsigned char* postings {nullptr};
+  static constexpr const char* magic {"ATTRIDX1"};
+public:
+  
+
+  explicit AttrIndex (const string &fName);
+  static void dir2file (const string &dirName,
+                        const string &fName);
+    // Input: dirName: an attribute is a file with a list of objects
+  void qc () const override;
+
+
+  size_t objsSize () const
+    { return objs_size; }
+  size_t attrsSize () const
+    { return attrs_size; }
+  string_view getObj (ObjNum objNum) const
+    { return string_view (objNames + objOffsets [objNum], objOffsets [objNum + 1] - objOffsets [objNum]); }
+  string_view getAttr (size_t attrNum) const
+    { return string_view (attrNames + attrOffsets [attrNum], attrOffsets [attrNum + 1] - attrOffsets [attrNum]); }
+  size_t findAttr (string_view attr) const;
+    // Return: no_index <=> attr is not in the index
+    // Time: O(log(attrsSize()))
+  size_t getTextSize (size_t attrNum) const
+    { return textSizes [attrNum]; }
+    // Return: size of the object list of attrNum as a text file
+  void getPosting (size_t attrNum,
+                   vector<ObjNum> &objNums) const;
+    // Output: objNums: ascending
+};
+#endif
+
+
+
+}
+
+
+
+#endif
@@ -41,11 +41,14 @@
 #include <cstring>
 #include <regex>
 #include <csignal>  
+#include <chrono>
 
 #ifndef _MSC_VER
   #include <execinfo.h>
   #include <sys/types.h>
   #include <sys/stat.h>
+  #include <sys/mman.h>
+  #include <fcntl.h>
   #include <unistd.h>
   #include <dirent.h>
   #ifdef __APPLE__
@@ -321,6 +324,198 @@ void throwf (const string &s)
 // Chronometer
 
 bool Chronometer::enabled = false;
+
+
+
+namespace
+{
+
+double cpuTime ()
+// Return: seconds of CPU time of this thread
+{
+#ifdef _MSC_VER
+  return (double) clock () / CLOCKS_PER_SEC;
+#else
+  timespec ts;
+  clock_gettime (CLOCK_THREAD_CPUTIME_ID, & ts);
+  return (double) ts. tv_sec + (double) ts. tv_nsec * 1e-9;
+#endif
+}
+
+
+
+double wallTime ()
+{
+  return chrono::duration<double> (chrono::steady_clock::now (). time_since_epoch ()). count ();
+}
+
+
+
+struct ChronNode
+{
+  double wall {0.0};
+  double cpu {0.0};
+  size_t calls {0};
+  map<const Chronometer*, ChronNode> children;
+
+
+  void merge (const ChronNode &other)
+    { wall  += other. wall;
+      cpu   += other. cpu;
+      calls += other. calls;
+      for (const auto& it : other. children)
+        children [it. first]. merge (it. second);
+    }
+  void total (const Chronometer* chron,
+              ChronNode &res) const
+    // Update: res: wall, cpu, calls
+    { for (const auto& it : children)
+      { if (it. first == chron)
+        { res. wall  += it. second. wall;
+          res. cpu   += it. second. cpu;
+          res. calls += it. second. calls;
+        }
+        it. second. total (chron, res);
+      }
+    }
+  Vector<pair<const Chronometer*, const ChronNode*>> getChildren () const
+    // Return: sorted by name
+    { Vector<pair<const Chronometer*, const ChronNode*>> vec;  vec. reserve (children. size ());
+      for (const auto& it : children)
+        vec << pair<const Chronometer*, const ChronNode*> (it. first, & it. second);
+      Common_sp::sort (vec, [] (const auto &a, const auto &b) { return a. first->name < b. first->name; });
+      return vec;
+    }
+  void print (ostream &os,
+              size_t depth) const
+    { for (const auto& it : getChildren ())
+      { os << "CHRON: " << string (2 * depth, ' ') << it. first->name << ": ";
+        { const ONumber onm (os, 2, false);
+          os << it. second->wall << " sec. wall, " << it. second->cpu << " sec. CPU";
+        }
+        os << ", " << it. second->calls << " calls" << endl;
+        it. second->print (os, depth + 1);
+      }
+    }
+  void saveJson (JsonContainer* parent) const
+    { for (const auto& it : getChildren ())
+      { auto j = new JsonMap (parent);
+        new JsonString (it. first->name, j, "name");
+        new JsonDouble (it. second->wall, 6, j, "wall");
+        new JsonDouble (it. second->cpu, 6, j, "cpu");
+        new JsonInt ((long long) it. second->calls, j, "calls");
+        if (! it. second->children. empty ())
+          it. second->saveJson (new JsonArray (j, "children"));
+      }
+    }
+};
+
+
+
+ChronNode chronRoot;
+  // Threads which have exited
+std::mutex chronRootMtx;
+
+
+
+struct ThreadChron : Nocopy
+{
+  ChronNode root;
+  struct Active
+  {
+    const Chronometer* chron {nullptr};
+    ChronNode* node {nullptr};
+    double wallStart {0.0};
+    double cpuStart {0.0};
+  };
+  Vector<Active> stack;
+
+
+  ThreadChron () = default;
+ ~ThreadChron ()
+    { const lock_guard<mutex> lg (chronRootMtx);
+      chronRoot. merge (root);
+    }
+};
+
+
+
+thread_local ThreadChron threadChron;
+
+
+
+ChronNode getChronTotal ()
+// Return: chronRoot + threadChron
+{
+  ChronNode res;
+  {
+    const lock_guard<mutex> lg (chronRootMtx);
+    res. merge (chronRoot);
+  }
+  res. merge (threadChron. root);
+  return res;
+}
+
+}
+
+
+
+void Chronometer::start_ ()
+{
+  ThreadChron& tc = threadChron;
+  for (const ThreadChron::Active& active : tc. stack)
+    if (active. chron == this)
+      throwf ("Chronometer \""  + name + "\" is not stopped");
+  ChronNode& parent = tc. stack. empty () ? tc. root : * tc. stack. back (). node;
+  ThreadChron::Active active;
+  active. chron = this;
+  active. node = & parent. children [this];
+  active. wallStart = wallTime ();
+  active. cpuStart = cpuTime ();
+  tc. stack << active;
+}
+
+
+
+void Chronometer::stop_ ()
+{
+  ThreadChron& tc = threadChron;
+  if (tc. stack. empty () || tc. stack. back (). chron != this)
+    throwf ("Chronometer \"" + name + "\" is not started");
+  const ThreadChron::Active& active = tc. stack. back ();
+  active. node->wall += wallTime () - active. wallStart;
+  active. node->cpu  += cpuTime ()  - active. cpuStart;
+  active. node->calls++;
+  tc. stack. pop ();
+}
+
+
+
+void Chronometer::print (ostream &os) const
+{
+  if (! on ())
+    return;
+  ChronNode res;
+  getChronTotal (). total (this, res);
+  os << "CHRON: " << name << ": ";
+  const ONumber onm (os, 2, false);
+  os << res. wall << " sec. wall, " << res. cpu << " sec. CPU" << endl;
+}
+
+
+
+void Chronometer::report (ostream &os)
+{
+  getChronTotal (). print (os, 0);
+}
+
+
+
+void Chronometer::report (JsonContainer* parent)
+{
+  ASSERT (parent);
+  getChronTotal (). saveJson (parent);
+}
   
  
 
@@ -1051,6 +1246,179 @@ Filetype getFiletype (const string &path,
 
 
 
+
+// Arena
+
+thread_local Arena* Arena::current = nullptr;
+
+
+
+Arena::~Arena ()
+{
+  for (char* chunk : chunks)
+    delete [] chunk;
+}
+
+
+
+void* Arena::allocate (size_t size)
+{
+  ASSERT (size);
+  size = (size + header_size - 1) / header_size * header_size;
+
+  for (FreeList& fl : freeLists)
+    if (fl. size == size)
+    {
+      if (void* p = fl. head)
+      {
+        fl. head = * static_cast <void**> (p);
+        return p;
+      }
+      break;
+    }
+
+  if (size > chunk_size)
+  {
+    // Remains in chunks, chunks.back() is not changed
+    char* p = new char [size];
+    chunks. insert (chunks. begin (), p);
+    return p;
+  }
+  if (chunk_free < size)
+  {
+    chunks. push_back (new char [chunk_size]);
+    chunk_free = chunk_size;
+  }
+  char* p = chunks. back () + (chunk_size - chunk_free);
+  chunk_free -= size;
+  return p;
+}
+
+
+
+void Arena::deallocate (void* p,
+                        size_t size)
+{
+  ASSERT (p);
+  size = (size + header_size - 1) / header_size * header_size;
+
+  for (FreeList& fl : freeLists)
+    if (fl. size == size)
+    {
+      * static_cast <void**> (p) = fl. head;
+      fl. head = p;
+      return;
+    }
+  * static_cast <void**> (p) = nullptr;
+  freeLists. push_back (FreeList {size, p});
+}
+
+
+
+namespace
+{
+  struct ArenaHeader
+  {
+    Arena* arena {nullptr};
+      // nullptr <=> global new
+    size_t size {0};
+  };
+}
+
+
+
+void* Arena::newObject (size_t size)
+{
+  static_assert (sizeof (ArenaHeader) <= header_size, "ArenaHeader");
+  size += header_size;
+  char* p = current 
+              ? static_cast <char*> (current->allocate (size)) 
+              : static_cast <char*> (::operator new (size));
+  new (p) ArenaHeader {current, size};
+  return p + header_size;
+}
+
+
+
+void Arena::deleteObject (void* p)
+{
+  if (! p)
+    return;
+  char* start = static_cast <char*> (p) - header_size;
+  const ArenaHeader* h = reinterpret_cast <const ArenaHeader*> (start);
+  if (h->arena)
+    h->arena->deallocate (start, h->size);
+  else
+    ::operator delete (start);
+}
+
+
+
+
+MappedFile::MappedFile (const string &fName_arg)
+: fName (fName_arg)
+{
+  const int fd = open (fName. c_str (), O_RDONLY);
+  if (fd == -1)
+    throw runtime_error ("Cannot open file " + shellQuote (fName));
+  struct stat st;
+  if (fstat (fd, & st))
+  {
+    close (fd);
+    throw runtime_error ("Cannot get the size of file " + shellQuote (fName));
+  }
+  if (! S_ISREG (st. st_mode))
+  {
+    if (S_ISDIR (st. st_mode))
+    {
+      close (fd);
+      throw runtime_error (shellQuote (fName) + " is a directory");
+    }
+    array<char, 1 << 16> buf;  // PAR
+    for (;;)
+    {
+      const ssize_t n = read (fd, buf. data (), buf. size ());
+      if (n == -1 && errno == EINTR)
+        continue;
+      if (n == -1)
+      {
+        close (fd);
+        throw runtime_error ("Cannot read file " + shellQuote (fName));
+      }
+      if (! n)
+        break;
+      text. append (buf. data (), (size_t) n);
+    }
+    close (fd);
+    data = text. data ();
+    size = text. size ();
+    return;
+  }
+  size = (size_t) st. st_size;
+  if (size)
+  {
+    void* p = mmap (nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED)
+    {
+      close (fd);
+      throw runtime_error ("Cannot map file " + shellQuote (fName) + " into memory");
+    }
+    madvise (p, size, MADV_SEQUENTIAL);
+    data = static_cast<const char*> (p);
+  }
+  close (fd);
+}
+
+
+
+MappedFile::~MappedFile ()
+{
+  if (data && data != text. data ())
+    munmap (var_cast (data), size);
+}
+
+
+
 void createDirectory (const string &dirName)
 {
   if (mkdir (dirName. c_str (), 0777) != 0)  // PAR
@@ -3213,7 +3581,7 @@ void Application::addDefaultArgs ()
 	  addFlag ("qc", "Integrity checks (quality control)");
     addKey ("verbose", "Level of verbosity", "0");
     addFlag ("noprogress", "Turn off progress printout");
-    addFlag ("profile", "Use chronometers to profile");
+    addFlag ("profile", "Use chronometers to profile: print the wall-clock and CPU time of nested scopes summed over threads to stderr and to -json");
     addKey ("seed", "Positive integer seed for random number generator", "1");
     addKey ("threads", "Max. number of threads", "1");
     addKey ("json", "Output file in Json format");
@@ -3575,8 +3943,6 @@ int Application::run (int argc,
   	threads_max = str2<size_t> (getArg ("threads"));
   	if (! threads_max)
   		throw runtime_error ("Number of threads cannot be 0");	
-  	if (threads_max > 1 && Chronometer::enabled)
-  		throw runtime_error ("Cannot profile with threads");
 
 
   	const Verbose vrb (gnu ? 0 : str2<int> (getArg ("verbose")));
@@ -3587,6 +3953,13 @@ int Application::run (int argc,
   	body ();
 
   
+    if (Chronometer::enabled)
+    {
+      Chronometer::report (cerr);
+      if (jRoot)
+        Chronometer::report (new JsonArray (jRoot, "profile"));
+    }
+
   	if (! jsonFName. empty ())
   	{
   	  ASSERT (jRoot);
@@ -61,6 +61,7 @@
 #include <cstring>
 #include <cmath>
 #include <string>
+#include <string_view>
 #include <stdexcept>
 #include <limits>
 #include <array>
@@ -177,6 +178,60 @@ template <typename T> bool Singleton<T>::beingRun = false;
 
 
 
+struct Arena : Nocopy
+// Memory for many small objects of a few sizes which live not longer than the Arena
+// Deleted objects are reused by objects of the same size
+// Not thread-safe
+{
+private:
+  static constexpr size_t chunk_size = 64 * 1024;  // PAR
+  static constexpr size_t header_size = 16;
+    // Alignment of new
+  vector<char*> chunks;
+  size_t chunk_free {0};
+    // In chunks.back()
+  struct FreeList
+  {
+    size_t size {0};
+    void* head {nullptr};
+  };
+  vector<FreeList> freeLists;
+public:
+  static thread_local Arena* current;
+    // Used by newObject()
+
+
+  Arena () = default;
+ ~Arena ();
+
+
+  void* allocate (size_t size);
+  void deallocate (void* p,
+                   size_t size);
+    // Requires: p = allocate(size)
+
+  struct Scope : Nocopy
+  // Sets current
+  {
+  private:
+    Arena* prev {nullptr};
+  public:
+    explicit Scope (Arena &arena)
+      : prev (current)
+      { current = & arena; }
+   ~Scope ()
+      { current = prev; }
+  };
+
+  // For class-specific operator new/delete
+  static void* newObject (size_t size);
+    // From current if current is not nullptr
+  static void deleteObject (void* p);
+    // Requires: p = newObject()
+};
+
+
+
 struct Color
 {
   enum Type { none    =  0
@@ -320,17 +375,17 @@ inline void section (const string &title,
 
 
 
+struct JsonContainer;
+
+
+
 struct Chronometer : Nocopy
-// CPU (not astronomical) time
-// Requires: no thread is used
+// Wall-clock and CPU time of a scope between start() and stop()
+// Scopes are nested per thread: the time is accumulated in a tree of scopes of the thread, the trees of the threads are merged on thread exit
+// Thread-safe
 {
-  static constexpr clock_t noclock {(clock_t) -1};
   static bool enabled;
   const string name;
-  clock_t time {0};
-protected:
-  clock_t startTime {noclock};
-public:
 
 
   explicit Chronometer (const string &name_arg)
@@ -339,30 +394,39 @@ public:
 
 
   bool on () const
-    { return enabled && threads_max == 1; }
+    { return enabled; }
   void start ()
-    { if (! on ())
-        return;
-      if (startTime != noclock)
-        throwf ("Chronometer \""  + name + "\" is not stopped");
-      startTime = clock (); 
-    }  
-  void stop () 
-    { if (! on ())
-        return;
-      if (startTime == noclock)
-        throwf ("Chronometer \"" + name + "\" is not started");
-      time += clock () - startTime; 
-      startTime = noclock;
+    { if (enabled)
+        start_ ();
     }
-
-  void print (ostream &os) const
-    { if (! on ())
-        return;       
-      os << "CHRON: " << name << ": ";
-      const ONumber onm (os, 2, false);
-      os << (double) time / CLOCKS_PER_SEC << " sec." << endl;
+  void stop ()
+    { if (enabled)
+        stop_ ();
     }
+private:
+  void start_ ();
+  void stop_ ();
+public:
+
+  void print (ostream &os) const;
+    // Total time in all threads which have exited and in this thread
+
+  static void report (ostream &os);
+  static void report (JsonContainer* parent);
+    // Hierarchy of the scopes of all threads which have exited and of this thread
+
+
+  struct Scope : Nocopy
+  {
+  private:
+    Chronometer& chron;
+  public:
+    explicit Scope (Chronometer &chron_arg)
+      : chron (chron_arg)
+      { chron. start (); }
+   ~Scope ()
+      { chron. stop (); }
+  };
 };
 
 
@@ -1333,6 +1397,26 @@ void copyText (const string &inFName,
 
   Filetype getFiletype (const string &path,
                         bool expandLink);
+  
+  
+  struct MappedFile : Nocopy
+  // Read-only memory-mapped file
+  // A file which is not regular (pipe, /dev/stdin, <(...)) is read into memory
+  {
+    const string fName;
+  private:
+    const char* data {nullptr};
+    size_t size {0};
+    string text;
+      // For a file which is not regular
+  public:
+    
+    explicit MappedFile (const string &fName_arg);
+   ~MappedFile ();
+    
+    string_view getView () const
+      { return string_view (data, size); }
+  };
 #endif
 
 
@@ -39,6 +39,8 @@
 using namespace Common_sp;
 #include "version.inc"
 
+#include <atomic>
+
 
 
 namespace 
@@ -49,13 +51,254 @@ static const string ext ("component");
 
 
 
-struct Item : Named, DisjointCluster
+Vector<size_t> getChunkBounds (string_view text)
+// Return: bounds of chunks of whole lines; size() >= 2
+{
+  Vector<size_t> bounds;  bounds. reserve (threads_max + 1);
+  bounds << 0;
+  const size_t chunk_min = 1024 * 1024;  // PAR
+  const size_t chunks_n = max<size_t> (1, min<size_t> (threads_max, text. size () / chunk_min));
+  FOR_START (size_t, i, 1, chunks_n)
+  {
+    size_t pos = max (bounds. back (), text. size () / chunks_n * i);
+    if (pos && text [pos - 1] != '\n')
+    {
+      pos = text. find ('\n', pos);
+      pos = pos == string_view::npos ? text. size () : pos + 1;
+    }
+    bounds << pos;
+  }
+  bounds << text. size ();
+  return bounds;
+}
+
+
+
+struct ItemIndex
+// Distinct items with an open-addressing hash table
+{
+  Vector<string_view> items;
+private:
+  Vector<size_t> table;
+    // Index in items + 1, 0 <=> empty slot
+  size_t mask {0};
+public:
+
+
+  ItemIndex ()
+    { resize (1024); }  // PAR
+  explicit ItemIndex (Vector<string_view> &&items_arg)
+    : items (move (items_arg))
+    { size_t size = 2;
+      while (size < 2 * items. size ())
+        size *= 2;
+      resize (size);
+    }
+
+
+  size_t find (string_view item) const
+    // Return: index in items, or no_index
+    { size_t i = hash (item) & mask;
+      while (const size_t r = table [i])
+      { if (items [r - 1] == item)
+          return r - 1;
+        i = (i + 1) & mask;
+      }
+      return no_index;
+    }
+  void add (string_view item)
+    { size_t i = hash (item) & mask;
+      while (const size_t r = table [i])
+      { if (items [r - 1] == item)
+          return;
+        i = (i + 1) & mask;
+      }
+      items << item;
+      table [i] = items. size ();
+      if (2 * items. size () > table. size ())
+        resize (2 * table. size ());
+    }
+private:
+  static size_t hash (string_view item)
+    { return std::hash<string_view> () (item); }
+  void resize (size_t size)
+    { table. clear ();
+      table. resize (size, 0);
+      mask = size - 1;
+      FFOR (size_t, rank, items. size ())
+      { size_t i = hash (items [rank]) & mask;
+        while (table [i])
+          i = (i + 1) & mask;
+        table [i] = rank + 1;
+      }
+    }
+};
+
+
+
+struct PairParser
+// Pairs of items in a chunk of lines
 {
-  explicit Item (const string &name_arg)
-    : Named (name_arg)
+private:
+  string_view text;
+  size_t pos {0};
+  const ItemIndex* subset {nullptr};
+public:
+
+
+  PairParser (string_view text_arg,
+              const ItemIndex* subset_arg)
+    : text (text_arg)
+    , subset (subset_arg)
     {}
+
+
+  bool next (string_view &item1,
+             string_view &item2)
+    // Return: false <=> end of text
+    // Output: item1, item2: in subset if subset is not nullptr
+    { for (;;)
+      { if (pos >= text. size ())
+          return false;
+        size_t eol = text. find ('\n', pos);
+        if (eol == string_view::npos)
+          eol = text. size ();
+        const string_view line (text. substr (pos, eol - pos));
+        pos = eol + 1;
+        size_t i = 0;
+        item1 = nextToken (line, i);
+        item2 = nextToken (line, i);
+        if (item2. empty ())
+          throw runtime_error ("Two items are expected in the line: " + strQuote (string (line)));
+        if (subset)
+        {
+          if (subset->find (item1) == no_index)
+            continue;
+          if (subset->find (item2) == no_index)
+            continue;
+        }
+        return true;
+      }
+    }
+private:
+  static string_view nextToken (string_view line,
+                                size_t &i)
+    { while (i < line. size () && isSpace (line [i]))
+        i++;
+      const size_t start = i;
+      while (i < line. size () && ! isSpace (line [i]))
+        i++;
+      return line. substr (start, i - start);
+    }
+};
+
+
+
+void collectItems (size_t from,
+                   size_t to,
+                   ItemIndex &index,
+                   string_view text,
+                   const Vector<size_t> &bounds,
+                   const ItemIndex* subset)
+// Output: index
+{
+  FOR_START (size_t, i, from, to)
+  {
+    PairParser parser (text. substr (bounds [i], bounds [i + 1] - bounds [i]), subset);
+    string_view item1, item2;
+    while (parser. next (item1, item2))
+    {
+      index. add (item1);
+      index. add (item2);
+    }
+  }
+}
+
+
+
+struct UnionFind : Nocopy
+// Lock-free disjoint sets of 0 .. size()-1
+// The root of a set is its minimum element
+{
+private:
+  vector<atomic<size_t>> parents;
+public:
+
+
+  explicit UnionFind (size_t n)
+    : parents (n)
+    { FFOR (size_t, i, n)
+        parents [i]. store (i, memory_order_relaxed);
+    }
+
+
+  size_t size () const
+    { return parents. size (); }
+  size_t find (size_t i)
+    // Path halving
+    { for (;;)
+      { size_t parent = parents [i]. load (memory_order_relaxed);
+        if (parent == i)
+          return i;
+        const size_t grandParent = parents [parent]. load (memory_order_relaxed);
+        if (grandParent != parent)
+          parents [i]. compare_exchange_weak (parent, grandParent, memory_order_relaxed);
+        i = grandParent;
+      }
+    }
+  void merge (size_t i,
+              size_t j)
+    { for (;;)
+      { i = find (i);
+        j = find (j);
+        if (i == j)
+          return;
+        if (i > j)
+          swap (i, j);
+        // i < j
+        size_t expected = j;
+        if (parents [j]. compare_exchange_strong (expected, i, memory_order_relaxed))
+          return;
+      }
+    }
+  Vector<size_t> getRoots ()
+    // Requires: no concurrent merge()
+    { Vector<size_t> roots;  roots. resize (size ());
+      FFOR (size_t, i, size ())
+      { const size_t parent = parents [i]. load (memory_order_relaxed);
+        ASSERT (parent <= i);
+        roots [i] = parent == i ? i : roots [parent];
+      }
+      return roots;
+    }
 };
 
+
+
+void mergeItems (size_t from,
+                 size_t to,
+                 Notype /*&res*/,
+                 string_view text,
+                 const Vector<size_t> &bounds,
+                 const ItemIndex* subset,
+                 const ItemIndex &index,
+                 UnionFind &uf)
+{
+  FOR_START (size_t, i, from, to)
+  {
+    PairParser parser (text. substr (bounds [i], bounds [i + 1] - bounds [i]), subset);
+    string_view item1, item2;
+    while (parser. next (item1, item2))
+    {
+      const size_t num1 = index. find (item1);
+      const size_t num2 = index. find (item2);
+      ASSERT (num1 != no_index);
+      ASSERT (num2 != no_index);
+      uf. merge (num1, num2);
+    }
+  }
+}
+
   
   
 
@@ -69,6 +312,7 @@ struct ThisApplication : Application
 	  addPositional ("out", "Output directory with the sets of connected items. Each set is named by its lexicographycally smaller item with the added extension " + strQuote ("." + ext));
 	  addKey ("subset", "List of items. Item pairs are restricted to this list");
 	  addFlag ("pairs", "<out> is a list of pairs: <item1> <item_min>, where <item_min> is lexicographycally smallest item of the cluster");
+	  addFlag ("sets", "<out> is a file with a line per set of connected items separated by spaces, the first item is lexicographycally smallest");
 	}
 
 
@@ -78,63 +322,97 @@ struct ThisApplication : Application
 		const string outFName    = getArg ("out");
 		const string subsetFName = getArg ("subset");
 		const bool   pairs  = getFlag ("pairs");
+		const bool   sets   = getFlag ("sets");
+		
+		if (pairs && sets)
+		  throw runtime_error ("-pairs and -sets are incompatible");
 
 
     unique_ptr<StringVector> subset;
+    unique_ptr<const ItemIndex> subsetIndex;
     if (! subsetFName. empty ())
     {
       subset. reset (new StringVector (subsetFName, (size_t) 10000, true));  // PAR 
       subset->sort ();
       QC_ASSERT (subset->isUniq ());
+      Vector<string_view> items;  items. reserve (subset->size ());
+      for (const string& s : *subset)
+        items << s;
+      subsetIndex. reset (new ItemIndex (move (items)));
     }
+    const ItemIndex* subsetPtr = subsetIndex. get ();
       
-    unordered_map<string/*Item::name*/,Item*> items;  items. rehash (100000);  // PAR
-      // Not delete'd
+    const MappedFile mf (inFName);
+    const string_view text (mf. getView ());
+    const Vector<size_t> bounds (getChunkBounds (text));
+    const size_t chunks_n = bounds. size () - 1;
+    
+    // Interning: items are numbered in lexicographic order
+    unique_ptr<const ItemIndex> index;
     {
-      LineInput fIn (inFName);  
-      string s1, s2;
-      Istringstream iss;
-      while (fIn. nextLine ())
+      Vector<string_view> items;
       {
-        iss. reset (fIn. line);
-        s2. clear ();
-        iss >> s1 >> s2;
-        QC_ASSERT (! s2. empty ());
-        if (subset. get ())
-        {
-          if (! subset->containsFast (s1))
-            continue;
-          if (! subset->containsFast (s2))
-            continue;
-        }
-        if (! contains (items, s1))
-          items [s1] = new Item (s1);
-        if (! contains (items, s2))
-          items [s2] = new Item (s2);
-        items [s1] -> DisjointCluster::merge (* items [s2]);
+        vector<ItemIndex> chunkIndexes;
+        arrayThreads (true, collectItems, chunks_n, chunkIndexes, text, cref (bounds), subsetPtr);
+        size_t n = 0;
+        for (const ItemIndex& chunkIndex : chunkIndexes)
+          n += chunkIndex. items. size ();
+        items. reserve (n);
+        for (const ItemIndex& chunkIndex : chunkIndexes)
+          items << chunkIndex. items;
       }
+      items. sort ();
+      items. uniq ();
+      index. reset (new ItemIndex (move (items)));
+    }
+    const Vector<string_view>& items = index->items;
+    
+    UnionFind uf (items. size ());
+    {
+      vector<Notype> notypes;
+      arrayThreads (true, mergeItems, chunks_n, notypes, text, cref (bounds), subsetPtr, cref (*index), ref (uf));
     }
+    const Vector<size_t> roots (uf. getRoots ());
     
-    map<const DisjointCluster*,VectorPtr<Item>> clusters;
-    for (auto& it : items)
-      clusters [it. second->getDisjointCluster ()] << it. second;
+    // Counting sort by root
+    Vector<size_t> clusterStart (items. size () + 1, 0);
+    for (const size_t root : roots)
+      clusterStart [root + 1] ++;
+    FFOR (size_t, i, items. size ())
+      clusterStart [i + 1] += clusterStart [i];
+    Vector<size_t> clustered (items. size (), no_index);
+    {
+      Vector<size_t> pos (clusterStart);
+      FFOR (size_t, i, items. size ())
+        clustered [pos [roots [i]] ++] = i;
+    }
       
     unique_ptr<OFStream> fOut;
-    if (pairs)
+    if (pairs || sets)
       fOut. reset (new OFStream (outFName));
-    for (auto& it : clusters)
+    FFOR (size_t, root, items. size ())
     {
-      VectorPtr<Item>& cluster = it. second;
-      cluster. sort (Named::lessPtr);
-      ASSERT (! cluster . empty ());
-      if (! pairs)
-        fOut. reset (new OFStream (outFName, cluster [0] -> name, ext));
-      for (const Item* item : cluster)
+      const size_t start = clusterStart [root];
+      const size_t end   = clusterStart [root + 1];
+      if (start == end)
+        continue;
+      ASSERT (clustered [start] == root);
+      const string_view rootName (items [root]);
+      if (! (pairs || sets))
+        fOut. reset (new OFStream (outFName, string (rootName), ext));
+      FOR_START (size_t, i, start, end)
+      {
+        const string_view item (items [clustered [i]]);
         if (pairs)
-          *fOut << item->name << '\t' << cluster [0] -> name << endl;
+          *fOut << item << '\t' << rootName << '\n';
+        else if (sets)
+          *fOut << (i == start ? "" : " ") << item;
         else
-          *fOut << item->name << endl;
-      if (! pairs)
+          *fOut << item << '\n';
+      }
+      if (sets)
+        *fOut << '\n';
+      if (! (pairs || sets))
         fOut. reset ();
     } 
 	}
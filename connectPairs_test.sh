@@ -0,0 +1,34 @@
+#!/bin/bash --noprofile
+THIS=`dirname $0`
+source $THIS/bash_common.sh
+if [ $# -ne 1 ]; then
+  echo "Test connectPairs: regular file vs. pipe input"
+  echo "#1: go"
+  exit 1
+fi
+
+
+TMP=`mktemp`
+comment $TMP
+
+
+section "Pairs"
+RANDOM=1
+for I in `seq 1 1000`; do
+  echo "i$(( RANDOM % 300 )) i$(( RANDOM % 300 ))"
+done > $TMP.pairs
+
+section "Regular file"
+$THIS/connectPairs $TMP.pairs $TMP.file -sets -qc -noprogress
+[ -s $TMP.file ]
+
+section "Process substitution"
+$THIS/connectPairs <(cat $TMP.pairs) $TMP.pipe -sets -qc -noprogress
+diff $TMP.file $TMP.pipe
+
+section "/dev/stdin"
+cat $TMP.pairs | $THIS/connectPairs /dev/stdin $TMP.stdin -sets -qc -noprogress
+diff $TMP.file $TMP.stdin
+
+
+rm -r $TMP*
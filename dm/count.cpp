@@ -63,25 +63,65 @@ void report (const string &attr,
 struct ThisApplication : Application
 {
   ThisApplication ()
-    : Application ("Statistics of a sequence of numbers from cin", false)
+    : Application ("Statistics of a sequence of numbers from cin in one pass with bounded memory", false)
     {
       version = VERSION;
+      addKey ("quantiles", "Comma-separated list of probabilities to print quantiles for, e.g. 0.5 for the median");
+      addKey ("sketch_size", "Size of the quantile sketch: the rank error of a quantile is ~ count / <sketch_size>; quantiles are exact if count <= <sketch_size>", "10000");
+      addKey ("bin", "Bin range of a histogram to print");
     }
 
 
 
 	void body () const final
 	{
+		const string quantilesS  =               getArg ("quantiles");
+		const size_t sketch_size = str2<size_t> (getArg ("sketch_size"));
+		const string binS        =               getArg ("bin");
+		QC_ASSERT (sketch_size >= 2);
+		
+		Vector<Prob> quantiles;
+		{
+		  string s (quantilesS);
+		  replace (s, ',', ' ');
+		  istringstream iss (s);
+		  string p;
+		  while (iss >> p)
+		  {
+		    quantiles << str2real (p);
+		    if (! isProb (quantiles. back ()))
+		      throw runtime_error ("Bad probability: " + strQuote (p));
+		  }
+		}
+		
+		unique_ptr<Histogram> hist;
+		if (! binS. empty ())
+		{
+		  const Real binRange = str2real (binS);
+		  if (! (binRange > 0.0))
+		    throw runtime_error ("-bin should be positive");
+		  hist. reset (new Histogram (binRange));
+		}
+
+
 		MeanVar mv;
+		QuantileSketch sketch (sketch_size);
 		string s;
 		while (cin >> s)
 		{
 			const Real x = str2real (s);
-			if (! isNan (x))
-				mv << x;
+			if (isNan (x))
+			  continue;
+			mv << x;
+			if (! quantiles. empty ())
+			  sketch << x;
+			if (hist)
+			  *hist << x;
 		}
+		sketch. qc ();
 		
-		report ("count",  mv. n);
+
+		report ("count",  (Real) mv. n);
 		report ("mean",   mv. getMean ());
 		report ("var",    mv. getVar ());
 		report ("SD",     mv. getSD ());
@@ -89,6 +129,15 @@ struct ThisApplication : Application
 		report ("meanSD", mv. getSD () / sqrt (mv. n));
 	  report ("min",    mv. v_min);
 	  report ("max",    mv. v_max);
+	  for (const Prob p : quantiles)
+	    report ("quantile_" + toString (p), sketch. getQuantile (p));
+	  
+	  if (hist)
+	  {
+	    hist->qc ();
+	    cout << endl;
+	    hist->saveText (cout);
+	  }
 	}
 };
 
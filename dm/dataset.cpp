@@ -499,6 +499,103 @@ Real NumAttr1::contDistr2outlier (const Sample &sample,
 
 
 
+namespace
+{
+  
+size_t prepareOutlierValues (Vector<Real> &values,
+                             bool rightTail)
+// Return: number of the values which are always not outliers
+// Output: values: !isNan(); [0, Return) <= [Return, end): sort()'ed
+{
+  values. filterValue ([] (Real x) { return isNan (x); });
+  if (values. size () <= 2)
+    return 0;
+  for (Real& x : values)
+    x *= getSign (rightTail);
+  // Objects while mult_sum < 0.5 * sample.mult_sum
+  const size_t half = (values. size () + 1) / 2;
+  std::nth_element (values. begin (), values. begin () + (long) half, values. end ());
+  std::sort (values. begin () + (long) half, values. end ());
+  return half;
+}
+  
+}
+
+
+
+Real locScaleDistr2outlier (Vector<Real> &values,
+                            LocScaleDistribution &distr,
+                            bool rightTail,
+                            Real outlier_EValue_max)
+{
+  const size_t half = prepareOutlierValues (values, rightTail);
+  if (values. size () <= 2)
+    return NaN;
+  
+  Real x_prev = -inf;
+  Real mult_sum = 0.0;
+  Real s = 0.0;
+  Real s2 = 0.0;
+  Real mean = NaN;
+  Real var = 0.0;
+  FFOR (size_t, i, values. size ())
+  {
+    const Real x = values [i];
+    if (i >= half && var > 0.0)
+    {
+      distr. setMeanVar (mean, var);
+      const Prob p = 1.0 - distr. cdf (x);
+      if (p * mult_sum <= outlier_EValue_max)
+        break;
+    }
+    mult_sum += 1.0;
+    s        += x;
+    s2       += sqr (x);
+    mean = s / mult_sum;
+    var = s2 / mult_sum - sqr (mean);
+    maximize (var, 0.0);
+    maximize (x_prev, x);
+  }
+  
+  return getSign (rightTail) * x_prev;  
+}
+
+
+
+Real contDistr2outlier (Vector<Real> &values,
+                        const ContinuousDistribution &distr,
+                        bool rightTail,
+                        Real outlier_EValue_max)
+{
+  ASSERT_EQ (distr. getMean (), 1.0, 1e-6);  // PAR
+
+  const size_t half = prepareOutlierValues (values, rightTail);
+  if (values. size () <= 2)
+    return NaN;
+    
+  Real x_prev = -inf;
+  Real mult_sum = 0.0;
+  Real s = 0.0;
+  FFOR (size_t, i, values. size ())
+  {
+    const Real x = values [i];
+    if (i >= half)
+    {
+      const Prob p = 1.0 - distr. cdf (x / (s / mult_sum));
+      if (p * mult_sum <= outlier_EValue_max)
+        break;
+    }
+    mult_sum += 1.0;
+    s        += x;
+    maximize (x_prev, x);
+  }
+  
+  return getSign (rightTail) * x_prev;  
+}
+
+
+
+
 // RealScale
 
 const RealScale::Value RealScale::missing = NaN;
@@ -2588,6 +2685,182 @@ void Sample::save (const Vector<size_t>* objNums,
 
 
 
+
+
+
+//////////////////////////// DenseSpace //////////////////////////////
+
+DenseSpace::DenseSpace (const Sample &sample,
+                        const Space1<NumAttr1> &space)
+: attrs (space. size ())
+{
+  ASSERT (& space. ds == sample. ds);
+  
+  objNums. reserve (sample. nEffective);
+  mults.   reserve (sample. nEffective);
+  for (Iterator it (sample); it ();)  
+  {
+    objNums << *it;
+    mults << it. mult;
+  }
+  
+  data. reserve (attrs * size ());
+  for (const NumAttr1* attr : space)
+    for (const size_t objNum : objNums)
+      data << attr->getReal (objNum);
+}
+
+
+
+void DenseSpace::qc () const
+{
+  if (! qc_on)
+    return;
+  QC_ASSERT (mults. size () == size ());
+  QC_ASSERT (data. size () == attrs * size ());
+  for (const Real m : mults)
+    QC_ASSERT (m > 0.0);
+}
+
+
+
+bool DenseSpace::existsMissing () const
+{
+  for (const Real x : data)
+    if (isNan (x))
+      return true;
+  return false;
+}
+
+
+
+namespace
+{
+  
+void getGram_ (size_t from,
+               size_t to,
+               Vector<Real> &gram,
+               const DenseSpace &ds,
+               const Vector<Real>* weights)
+// Output: gram: lower triangle of X^t diag(weights) X over objects [from, to), row-major attrs x attrs
+{
+  constexpr size_t panel_max = 256;  // PAR
+  
+  const size_t p = ds. attrs;
+  gram. resize (p * p, 0.0);
+  // Row-major copy of a panel of objects: rank-1 updates of gram are vectorized
+  Vector<Real> panel (panel_max * p);  
+  const Real* w = weights ? weights->data () : ds. mults. data ();
+  for (size_t start = from; start < to; start += panel_max)
+  {
+    const size_t rows = min (panel_max, to - start);
+    FFOR (size_t, a, p)
+    {
+      const Real* col = ds. column (a) + start;
+      FFOR (size_t, i, rows)
+        panel [i * p + a] = col [i];
+    }
+    FFOR (size_t, i, rows)
+    {
+      const Real wi = w [start + i];
+      if (! wi)
+        continue;
+      const Real* x = & panel [i * p];
+      FFOR (size_t, a, p)
+      {
+        const Real xa = x [a];
+        Real* g = & gram [a * p];
+        FFOR (size_t, b, a + 1)
+          g [b] += xa * x [b] * wi;
+      }
+    }
+  }
+}
+  
+
+
+void multiplyTransposed_ (size_t from,
+                          size_t to,
+                          Vector<Real> &res,
+                          const DenseSpace &ds,
+                          const Vector<Real> &vec)
+// Output: res: X^t vec over objects [from, to)
+{
+  res. resize (ds. attrs, 0.0);
+  FFOR (size_t, a, ds. attrs)
+  {
+    const Real* col = ds. column (a);
+    Real s = 0.0;
+    FFOR_START (size_t, i, from, to)
+      s += col [i] * vec [i];
+    res [a] = s;
+  }
+}
+  
+}
+
+
+
+void DenseSpace::getGram (const Vector<Real>* weights,
+                          Matrix &gram) const
+{
+  ASSERT (gram. rowsSize (false) == attrs);
+  ASSERT (gram. rowsSize (true)  == attrs);
+  IMPLY (weights, weights->size () == size ());
+  
+  vector<Vector<Real>> grams;
+  arrayThreads (true, getGram_, size (), grams, cref (*this), weights);
+  
+  FFOR (size_t, a, attrs)
+    FFOR (size_t, b, a + 1)
+    {
+      Real s = 0.0;
+      for (const Vector<Real>& g : grams)
+        if (! g. empty ())
+          s += g [a * attrs + b];
+      gram. putSymmetric (a, b, s);
+    }
+}
+
+
+
+void DenseSpace::multiply (const MVector &beta,
+                           Vector<Real> &res) const
+{
+  ASSERT (beta. size () == attrs);
+  
+  res. resize (size ());
+  res. setAll (0.0);
+  FFOR (size_t, a, attrs)
+  {
+    const Real* col = column (a);
+    const Real b = beta [a];
+    FFOR (size_t, i, size ())
+      res [i] += col [i] * b;
+  }
+}
+
+
+
+void DenseSpace::multiplyTransposed (const Vector<Real> &vec,
+                                     MVector &res) const
+{
+  ASSERT (vec. size () == size ());
+  ASSERT (res. size () == attrs);
+  
+  vector<Vector<Real>> results;
+  arrayThreads (true, multiplyTransposed_, size (), results, cref (*this), cref (vec));
+  
+  FFOR (size_t, a, attrs)
+  {
+    Real s = 0.0;
+    for (const Vector<Real>& r : results)
+      if (! r. empty ())
+        s += r [a];
+    res [a] = s;
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////
 
 PositiveAttr2* getDist2 (const Space1<RealAttr1> &space,
@@ -4643,6 +4916,47 @@ void MultiNormal::estimate ()
 
 
 
+void MultiNormal::estimate (Real mult_sum,
+                            const Vector<Real> &sum,
+                            const Vector<Real> &sum2)
+{
+  ASSERT (analysis);
+  ASSERT (mult_sum >= 0.0);
+    
+  setDim (analysis->space. size ());
+  ASSERT (sum. size () == getDim ());
+  ASSERT (sum2. size () == (getDim () * (getDim () + 1)) / 2);
+  
+  const Real n = mult_sum ? 1.0 / mult_sum : 0.0;
+  size_t k = 0;
+	FFOR (size_t, row, getDim ())
+	{
+	  mu [row] = mult_sum ? sum [row] / mult_sum : 0.0;
+  	FFOR (size_t, col, row + 1)
+  	{
+  	  sigmaExact. put (false, row, col, sum2 [k] * n);
+  	  k++;
+  	}
+  }
+  ASSERT (k == sum2. size ());
+  
+  sigmaExact. lower2upper (false);
+  
+  // Centering
+  Matrix mu2 (getDim ());
+  mu2. multiply (false, mu, false, mu, true);
+  sigmaExact. add (false, mu2, false, -1);
+  
+  sigmaExact. psd = true;
+  
+  setParam ();
+  if (verbose ())
+    if (isNan (coeff))
+      cout << "det = 0" << endl;
+}
+
+
+
 void MultiNormal::getSigmaRaw (Matrix &sigmaRaw) const
 {
   ASSERT (sigmaRaw. equalLen (false, sigmaExact, false));
@@ -5001,99 +5315,451 @@ namespace
 
 
 
-void Mixture::estimate ()
+namespace
 {
-  ASSERT (! components. empty ());
+	
+struct DenseSample
+// Row-major object x attribute buffer
+{
+  size_t dim {0};
+  Vector<size_t> objNums;
+  Vector<Real> mults;
+  Vector<Real> data;
+    // size() = objNums.size() * dim
+    
+    
+  explicit DenseSample (const MultiDistribution::An &an)
+    : dim (an. space. size ())
+    { objNums. reserve (an. sample. nEffective);
+      mults.   reserve (an. sample. nEffective);
+      data.    reserve (an. sample. nEffective * dim);
+      for (Iterator it (an. sample); it ();)  
+      { objNums << *it;
+        mults << it. mult;
+        for (const NumAttr1* attr : an. space)
+          data << (*attr) [*it];
+      }
+    }
+    
+    
+  size_t size () const
+    { return objNums. size (); }
+  bool finite () const
+    { for (const Real x : data)
+        if (! DM_sp::finite (x))
+          return false;
+      return true;
+    }
+};
+
+
+
+struct DenseNormal
+// Log-density of Mixture::Component with MultiNormal::distr via its Cholesky decomposition
+{
+  Real logProb {NaN};
+  Real coeff {NaN};
+  Vector<Real> mu;
+  Vector<Real> chol;
+    // Lower triangle, row-major, dim x dim
+  Vector<Real> diagInv;
+    // 1 / diagonal of chol
   
-  const Analysis1* analysis = getAnalysisCheck ();
   
-  bool objProbStart = getParamSet ();
-//cout << "objProbStart = " << objProbStart << endl;  
+  DenseNormal () = default;
+  explicit DenseNormal (const Mixture::Component &comp)
+    { const MultiNormal* mn = comp. distr->asMultiNormal ();
+      ASSERT (mn);
+      if (isNan (mn->coeff))
+        throw runtime_error ("MultiNormal::coeff is NaN"); 
+      logProb = log (comp. prob);
+      coeff = mn->coeff;
+      const size_t dim = mn->getDim ();
+      mu. resize (dim);
+      FFOR (size_t, i, dim)
+        mu [i] = mn->mu [i];
+      if (coeff == inf)
+        return;
+      const Matrix& cholesky = mn->getCholesky ();
+      chol. resize (dim * dim, 0.0);
+      diagInv. resize (dim);
+      FFOR (size_t, row, dim)
+      { FFOR (size_t, col, row + 1)
+          chol [row * dim + col] = cholesky. get (false, row, col);
+        const Real d = chol [row * dim + row];
+        diagInv [row] = d ? 1.0 / d : inf;
+      }
+    }
+    
+    
+  bool valid () const
+    { for (const Real d : diagInv)
+        if (d == inf)
+          return false;
+      return true;
+    }
+  void logPdfProb (const DenseSample &ds,
+                   size_t from,
+                   size_t block,
+                   Real* y,
+                   Real* res) const
+    // Output: res[0..block-1]
+    // Update: y: temporary, size() >= dim * block
+    { const size_t dim = ds. dim;
+      const Real* x = & ds. data [from * dim];
+      if (coeff == inf)
+      { FFOR (size_t, b, block)
+        { bool same = true;
+          FFOR (size_t, i, dim)
+            if (x [b * dim + i] != mu [i])
+            { same = false;
+              break;
+            }
+          res [b] = logProb + (same ? 0.0 : -inf);
+        }
+        return;
+      }
+      // Forward substitution chol * y = x - mu, objects in the inner loop
+      const Real* l = & chol [0];
+      FFOR (size_t, b, block)
+        res [b] = 0.0;
+      FFOR (size_t, i, dim)
+      { Real* yi = & y [i * block];
+        FFOR (size_t, b, block)
+          yi [b] = x [b * dim + i] - mu [i];
+        FOR (size_t, k, i)
+        { const Real lik = l [i * dim + k];
+          const Real* yk = & y [k * block];
+          FFOR (size_t, b, block)
+            yi [b] -= lik * yk [b];
+        }
+        const Real di = diagInv [i];
+        FFOR (size_t, b, block)
+        { yi [b] *= di;
+          res [b] += yi [b] * yi [b];
+        }
+      }
+      FFOR (size_t, b, block)
+        res [b] = logProb - 0.5 * res [b] - coeff;
+    }
+};
 
-#ifndef NDEBUG	
-	if (! objProbStart)
-    for (const Component* c : components)
+
+
+struct EmStat
+{
+  Real logLikelihood {0.0};
+  Vector<Real> moments;
+    // Per component: mult_sum, sum[dim], sum2[dim*(dim+1)/2]
+};
+
+
+
+void emStep (size_t from,
+             size_t to,
+             EmStat &stat,
+             const DenseSample &ds,
+             const Vector<DenseNormal> &normals,
+             bool expectation,
+             Vector<Prob> &resp)
+// Expectation: resp, stat.logLikelihood
+// Maximization: stat.moments
+// Input: resp if !expectation
+// Output: stat
+// Update: resp: objects x components
+{
+  constexpr size_t block_max = 16;  // PAR
+  
+  const size_t dim = ds. dim;
+  const size_t k = normals. size ();
+  const size_t tri = (dim * (dim + 1)) / 2;
+  const size_t momentSize = 1 + dim + tri;
+  stat. moments. resize (k * momentSize, 0.0);
+  
+  Vector<Real> y (dim * block_max);
+  Vector<Real> lp (k * block_max);
+  for (size_t start = from; start < to; start += block_max)
+  {
+    const size_t block = min (block_max, to - start);
+    
+    if (expectation)
     {
-    	ASSERT (c->objProb. size () == analysis->sample. mult. size ());
-      for (Iterator it (analysis->sample); it ();)      	
-    	  ASSERT (isProb (c->objProb [*it]));
+      FFOR (size_t, c, k)
+        normals [c]. logPdfProb (ds, start, block, & y [0], & lp [c * block]);
+      FFOR (size_t, b, block)
+      {
+        Prob* r = & resp [(start + b) * k];
+        if (k == 1)
+        {
+          stat. logLikelihood += ds. mults [start + b] * lp [b];
+          r [0] = 1.0;
+          continue;
+        }
+        // Bayes' theorem
+        Real lp_max = -inf;
+        FFOR (size_t, c, k)
+          maximize (lp_max, lp [c * block + b]);
+        if (lp_max == -inf)
+          throw runtime_error ("Mixture: an object has 0 probability in all components");
+        Real s = 0.0;
+        FFOR (size_t, c, k)
+          s += exp (lp [c * block + b] - lp_max);
+        const Real lnS = log (s);
+        stat. logLikelihood += ds. mults [start + b] * (lp_max + lnS);
+        FFOR (size_t, c, k)
+          r [c] = exp (lp [c * block + b] - lp_max - lnS);
+      }
     }
-#endif
-  	
+    
+    FFOR (size_t, b, block)
+    {
+      const size_t objIndex = start + b;
+      const Real* x = & ds. data [objIndex * dim];
+      const Prob* r = & resp [objIndex * k];
+      FFOR (size_t, c, k)
+      {
+        const Real w = ds. mults [objIndex] * r [c];
+        if (! w)
+          continue;
+        Real* m = & stat. moments [c * momentSize];
+        m [0] += w;
+        Real* sum = m + 1;
+        Real* sum2 = sum + dim;
+        FFOR (size_t, i, dim)
+        {
+          const Real wx = w * x [i];
+          sum [i] += wx;
+          Real* row = & sum2 [(i * (i + 1)) / 2];
+          FFOR (size_t, j, i + 1)
+            row [j] += wx * x [j];
+        }
+      }
+    }
+  }
+}
+
+}
+
+
+
+bool Mixture::estimateDense (bool objProbStart)
+{
+  const MultiDistribution::An* an = nullptr;
+  for (const Component* comp : components)
+  {
+    const MultiNormal* mn = comp->distr->asMultiNormal ();
+    if (! mn)
+      return false;
+    if (! mn->analysis)
+      return false;
+    if (! an)
+      an = mn->analysis;
+    if (an != mn->analysis)
+      return false;
+  }
+  ASSERT (an);
+  
+  const DenseSample ds (*an);
+  if (! ds. finite ())
+    return false;
+  
+  const size_t n = ds. size ();
+  const size_t k = components. size ();
+  const size_t dim = ds. dim;
+  const size_t momentSize = 1 + dim + (dim * (dim + 1)) / 2;
+  
+  Vector<Prob> resp (n * k, NaN);
+  Vector<EmStat> stats;
+  
+  const auto step = [&] (bool expectation) 
+    { Vector<DenseNormal> normals;  normals. reserve (k);
+      if (expectation)
+        for (const Component* comp : components)
+        { normals << DenseNormal (*comp);
+          if (! normals. back (). valid ())
+            return false;
+        }
+      else
+        normals. resize (k);  // Only size() is used
+      arrayThreads (true, emStep, n, stats, cref (ds), cref (normals), expectation, ref (resp));
+      return true;
+    };
+  
+  if (! objProbStart)
+    FFOR (size_t, i, n)
+      FFOR (size_t, c, k)
+        resp [i * k + c] = components [c] -> objProb [ds. objNums [i]];
+  if (! step (objProbStart))
+    return false;
 
   Real entropyEst_best = inf;
-  do
+  for (;;)
   {
     if (verbose ())
       cout << endl << "entropyEst_best = " << entropyEst_best << endl;
-      
+
 	  // Component::objProb
-	  if (objProbStart)
-	  {
-		  MVector vec (components. size ());
-		  for (Iterator it (analysis->sample); it ();)  
-		    if (components. size () == 1)
-		      var_cast (components [0]) -> objProb [*it] = 1.0;
-		    else
-  		  {
-  		  	data2variable (*it);
-  		  //ASSERT (! variable. contains (NaN));
-  		  	// Bayes' theorem
-  				FFOR (size_t, i, components. size ())
-  				  vec [i] = components [i] -> logPdfProb ();				
-  				vec. expBalanceLogRow (true, 0, 1.0);
-  				vec. expRow (true, 0);
-  				ASSERT (eqReal (vec. sumRow (true, 0), 1.0));
-  				FFOR (size_t, i, components. size ())
-  				{
-  					const Prob newObjProb = vec [i];
-  					ASSERT (isProb (newObjProb));
-  					var_cast (components [i]) -> objProb [*it] = newObjProb;
-  			  }
-  		  }  
-	  }
-	  else
-	  	objProbStart = true;
-	
+	  FFOR (size_t, i, n)
+	    FFOR (size_t, c, k)
+	    {
+	      const Prob p = resp [i * k + c];
+	      ASSERT (isProb (p));
+	      var_cast (components [c]) -> objProb [ds. objNums [i]] = p;
+	    }
+    
+    // Sufficient statistics
+    Vector<Real> moments (k * momentSize, 0.0);
+    for (const EmStat& stat : stats)
+      FFOR (size_t, i, moments. size ())
+        moments [i] += stat. moments [i];
+
 	  // Component::distr->Parameters
-	  FOR_REV (size_t, i, components. size ())  // --> for ??
+	  FOR_REV (size_t, c, k)
 	  {
 	    if (verbose ())
-	      cout << "Estimating component " << (i + 1) << endl;
-	  #if 1
-	    var_cast (components [i]) -> estimate ();
+	      cout << "Estimating component " << (c + 1) << endl;
+	    const Real* m = & moments [c * momentSize];
+	    Vector<Real> sum;   sum.  reserve (dim);
+	    Vector<Real> sum2;  sum2. reserve (momentSize - 1 - dim);
+	    FFOR_START (size_t, i, 1, 1 + dim)
+	      sum << m [i];
+	    FFOR_START (size_t, i, 1 + dim, momentSize)
+	      sum2 << m [i];
+	    MultiNormal* mn = var_cast (components [c] -> distr->asMultiNormal ());
+	    mn->estimate (m [0], sum, sum2);
+	    ASSERT (mn->getParamSet ());
 	    if (verbose ())
-	      components [i] -> saveText (cout);
-	  #else
-	    if (   ! var_cast (components [i]) -> estimate ()
-	        && components. size () >= 2
-	       )
-	    {
-	    	components. erasePtr (i);
-  	    if (verbose ())
-  	      cout << "Component is erased" << endl;
-	    }
-	  #endif
+	      components [c] -> saveText (cout);
 	  }
 	
 	  // Component::prob
 	  {
-		  MVector vec (components. size ());
-			FFOR (size_t, i, components. size ())
-		    vec [i] = components [i] -> getMult ();
+		  MVector vec (k);
+			FFOR (size_t, c, k)
+		    vec [c] = moments [c * momentSize];
 	  	vec. balanceRow (true, 0, 1.0);
-	  	FFOR (size_t, i, components. size ())
+	  	FFOR (size_t, c, k)
 	  	{
-	  	  var_cast (components [i]) -> prob = toProb (vec [i]);
+	  	  var_cast (components [c]) -> prob = toProb (vec [c]);
 	  	  if (verbose ())
 	  	  {
 	  	    ONumber on (cout, 6, true);
-	  	    cout << "P(component " << (i + 1) << ") = " << vec [i] << endl;
+	  	    cout << "P(component " << (c + 1) << ") = " << vec [c] << endl;
 	  	  }
 	  	}
 		}
+		
+		// Expectation with the new parameters
+		if (! step (true))
+		  break;
+		Real logLikelihood = 0.0;
+		for (const EmStat& stat : stats)
+		  logLikelihood += stat. logLikelihood;
+		if (! minimizeEntropy (entropyEst_best, - logLikelihood / an->sample. mult_sum, 1e-4))  // PAR
+		  break;
+  }
+  
+  return true;
+}
+
+
+
+void Mixture::estimate ()
+{
+  ASSERT (! components. empty ());
+  
+  const Analysis1* analysis = getAnalysisCheck ();
+  
+  bool objProbStart = getParamSet ();
+//cout << "objProbStart = " << objProbStart << endl;  
+
+#ifndef NDEBUG	
+	if (! objProbStart)
+    for (const Component* c : components)
+    {
+    	ASSERT (c->objProb. size () == analysis->sample. mult. size ());
+      for (Iterator it (analysis->sample); it ();)      	
+    	  ASSERT (isProb (c->objProb [*it]));
+    }
+#endif
+  	
+
+  if (! (dense && estimateDense (objProbStart)))
+  {
+    Real entropyEst_best = inf;
+    do
+    {
+      if (verbose ())
+        cout << endl << "entropyEst_best = " << entropyEst_best << endl;
+      
+  	  // Component::objProb
+  	  if (objProbStart)
+  	  {
+  		  MVector vec (components. size ());
+  		  for (Iterator it (analysis->sample); it ();)  
+  		    if (components. size () == 1)
+  		      var_cast (components [0]) -> objProb [*it] = 1.0;
+  		    else
+    		  {
+    		  	data2variable (*it);
+    		  //ASSERT (! variable. contains (NaN));
+    		  	// Bayes' theorem
+    				FFOR (size_t, i, components. size ())
+    				  vec [i] = components [i] -> logPdfProb ();				
+    				vec. expBalanceLogRow (true, 0, 1.0);
+    				vec. expRow (true, 0);
+    				ASSERT (eqReal (vec. sumRow (true, 0), 1.0));
+    				FFOR (size_t, i, components. size ())
+    				{
+    					const Prob newObjProb = vec [i];
+    					ASSERT (isProb (newObjProb));
+    					var_cast (components [i]) -> objProb [*it] = newObjProb;
+    			  }
+    		  }  
+  	  }
+  	  else
+  	  	objProbStart = true;
+	
+  	  // Component::distr->Parameters
+  	  FOR_REV (size_t, i, components. size ())  // --> for ??
+  	  {
+  	    if (verbose ())
+  	      cout << "Estimating component " << (i + 1) << endl;
+  	  #if 1
+  	    var_cast (components [i]) -> estimate ();
+  	    if (verbose ())
+  	      components [i] -> saveText (cout);
+  	  #else
+  	    if (   ! var_cast (components [i]) -> estimate ()
+  	        && components. size () >= 2
+  	       )
+  	    {
+  	    	components. erasePtr (i);
+    	    if (verbose ())
+    	      cout << "Component is erased" << endl;
+  	    }
+  	  #endif
+  	  }
+	
+  	  // Component::prob
+  	  {
+  		  MVector vec (components. size ());
+  			FFOR (size_t, i, components. size ())
+  		    vec [i] = components [i] -> getMult ();
+  	  	vec. balanceRow (true, 0, 1.0);
+  	  	FFOR (size_t, i, components. size ())
+  	  	{
+  	  	  var_cast (components [i]) -> prob = toProb (vec [i]);
+  	  	  if (verbose ())
+  	  	  {
+  	  	    ONumber on (cout, 6, true);
+  	  	    cout << "P(component " << (i + 1) << ") = " << vec [i] << endl;
+  	  	  }
+  	  	}
+  		}
+    }
+    while (minimizeEntropy (entropyEst_best, 1e-4));  // PAR  
   }
-  while (minimizeEntropy (entropyEst_best, 1e-4));  // PAR  
   
 
   components. sort (componentComp);
@@ -5347,7 +6013,8 @@ Clustering::Clustering (const Sample &sample_arg,
 	                      Real sd_min,
 	                      bool sd_min_is_relative,
 	                      Real entropyDimensionPrecision,
-	                      bool unverbose)
+	                      bool unverbose,
+	                      bool dense)
 : P (sample_arg, space_arg)
 , variance_min (space. size ())
 {
@@ -5377,6 +6044,7 @@ Clustering::Clustering (const Sample &sample_arg,
 
 
   ASSERT (mixt. components. empty ());
+  mixt. dense = dense;
   mixt. qc ();
   
   
@@ -360,6 +360,23 @@ public:
 
 
 
+// The same as NumAttr1::locScaleDistr2outlier(), NumAttr1::contDistr2outlier() for objects with mult = 1
+// Input: values: missing values are skipped
+// Update: values: reordered
+// Time: O(n + n/2 log(n)): the lower half of values is selected and is not sorted
+Real locScaleDistr2outlier (Vector<Real> &values,
+                            LocScaleDistribution &distr,
+                            bool rightTail,
+                            Real outlier_EValue_max);
+  // Update: distr
+Real contDistr2outlier (Vector<Real> &values,
+                        const ContinuousDistribution &distr,
+                        bool rightTail,
+                        Real outlier_EValue_max);
+  // Input: distr.getMean() = 1
+
+
+
 struct RealAttr1 : NumAttr1
 // Missing = NaN
 {
@@ -1776,6 +1793,49 @@ template <typename T/*:Attr1*/>
 
 
 
+struct DenseSpace : Root
+// Column-major copy of a Space1<NumAttr1> restricted to the objects with non-zero Sample::mult
+{
+  Vector<size_t> objNums;
+  Vector<Real> mults;
+    // size() = objNums.size()
+  size_t attrs {0};
+  Vector<Real> data;
+    // = X
+    // size() = attrs * objNums.size()
+    // data[attrNum * objNums.size() + i] = (*space[attrNum])[objNums[i]]
+
+
+  DenseSpace (const Sample &sample,
+              const Space1<NumAttr1> &space);
+  void qc () const override;
+  bool empty () const override
+    { return objNums. empty (); }
+    
+    
+  size_t size () const
+    { return objNums. size (); }
+  const Real* column (size_t attrNum) const
+    { return data. data () + attrNum * size (); }
+  bool existsMissing () const;
+  void getGram (const Vector<Real>* weights,
+                Matrix &gram) const;
+    // Output: gram = X^t diag(weights) X
+    // Input: weights: nullptr <=> mults; size() = size()
+    // Requires: gram.rowsSize() = attrs
+    // Time: O(attrs^2 size() / threads_max)
+  void multiply (const MVector &beta,
+                 Vector<Real> &res) const;
+    // Output: res = X beta
+  void multiplyTransposed (const Vector<Real> &vec,
+                           MVector &res) const;
+    // Output: res = X^t vec
+    // Time: O(attrs size() / threads_max)
+};
+
+
+
+
 //////////////////////// Distribution ////////////////////////
 
 //struct Distribution
@@ -2002,8 +2062,12 @@ public:
     { return - getLogLikelihood () / getAnalysisCheck () -> sample. mult_sum; }
   bool minimizeEntropy (Real &entropy_best,
                         Real delta) const
-    { const Real entropy = getEntropy_est ();
-      const Real deltaAdj = delta * (Real) getDim ();
+    { return minimizeEntropy (entropy_best, getEntropy_est (), delta); }
+  bool minimizeEntropy (Real &entropy_best,
+                        Real entropy,
+                        Real delta) const
+    // Input: entropy: getEntropy_est()
+    { const Real deltaAdj = delta * (Real) getDim ();
       if (verbose ())
         cout << "new entropy = " << entropy << "  deltaAdj = " << deltaAdj << endl;
       return minimizeReal (entropy_best, entropy, deltaAdj); 
@@ -3492,6 +3556,13 @@ private:
     // Invokes: inflateSigma()
 public:
   void estimate () final;
+  void estimate (Real mult_sum,
+                 const Vector<Real> &sum,
+                 const Vector<Real> &sum2);
+    // Same as estimate() given the sufficient statistics of a sample without missing values
+    // Input: mult_sum = sum_x mult(x)
+    //        sum: size() = getDim(); sum[i] = sum_x mult(x) * x_i
+    //        sum2: size() = getDim() * (getDim() + 1) / 2; sum2[i*(i+1)/2+j] = sum_x mult(x) * x_i * x_j, j <= i
   bool getParamSet () const final
     { return    getDim () 
              && mu. defined () 
@@ -3540,6 +3611,10 @@ public:
   
   void getSigmaRaw (Matrix &sigmaRaw) const;
     // Output: sigmaRaw: sigmaExact + mu * mu'
+  const Matrix& getCholesky () const
+    { return cholesky; }
+    // Lower-triangle: cholesky * cholesky' = sigmaInflated
+    // Requires: coeff < inf
 private:
   bool inflateSigma ();
     // Make the variance in the space of PC >= variance_min
@@ -3619,6 +3694,9 @@ struct Mixture : Distribution
 protected:
   Categorical cat;
 public:
+  
+  bool dense {true};
+    // Use estimateDense() if possible
 
 
   Mixture ()
@@ -3680,7 +3758,12 @@ private:
 public:   
   void estimate () final;
     // Input: Component::{parameters, prob} or Component::objProb
-    // Invokes: components.sort()
+    // Invokes: estimateDense(), components.sort()
+private:
+  bool estimateDense (bool objProbStart);
+    // EM on a dense object x attribute buffer, in threads
+    // Return: false <=> not all components are MultiNormal's of the same analysis, or the data are not finite
+public:
   bool getParamSet () const final;
     // Input: Component::{parameters, prob}
   size_t getDim () const final
@@ -3818,8 +3901,10 @@ struct Clustering : MultiVariate<NumAttr1>
               Real sd_min,
               bool sd_min_is_relative,
               Real entropyDimensionPrecision = 0.001,
-              bool unverbose = true);  // PAR
+              bool unverbose = true,
+              bool dense = true);  // PAR
     // Input: sd_min: (relative) min. SD for each attribute in each cluster
+    //        dense: Mixture::dense
   Clustering (const Clustering &clustering,
               const vector<bool> &toMerge);
     // Requires: clustering.getOutDim() = toMerge.size()
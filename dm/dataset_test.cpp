@@ -494,6 +494,21 @@ struct ThisApplication : Application
 		    ds. saveText (cout);
 		  }
 		  ASSERT (cl. mixt. components. size () == 2);
+
+		  // Mixture::estimateDense() vs. the Distribution-based EM
+		  const Clustering cl_ref (sm, sp, 100, 0.2, false, 0.07, true, false);  // PAR
+		  cl_ref. qc ();
+		  ASSERT (cl_ref. mixt. components. size () == cl. mixt. components. size ());
+		  ASSERT (cl. mixt. similar (cl_ref. mixt, 1e-6));
+		  FFOR (size_t, i, cl. mixt. components. size ())
+		  {
+		    const Mixture::Component* comp     = cl.     mixt. components [i];
+		    const Mixture::Component* comp_ref = cl_ref. mixt. components [i];
+		    ASSERT_EQ (comp->prob, comp_ref->prob, 1e-6);
+		    FFOR (size_t, objNum, ds. objs. size ())
+		      ASSERT_EQ (comp->objProb [objNum], comp_ref->objProb [objNum], 1e-6);
+		  }
+		  ASSERT_EQ (cl. mixt. getEntropy_est (), cl_ref. mixt. getEntropy_est (), 1e-6);
 	  }
 	}
 };
@@ -107,6 +107,173 @@ struct Violation
 
 
 
+struct ClusterDist
+// Distances among the objects of a cluster
+{
+  const Vector<size_t>& objs;
+    // Dataset::objs index
+  const size_t m;
+  Vector<Real> d;
+    // Row-major m x m, NaN <=> missing
+  Vector<Real> nearest;
+    // Min. distance to another object; inf if none
+  Vector<Vector<size_t>> neighbors;
+    // Indexes of objs with non-missing distances, ascending
+  bool sparse {false};
+    // Use neighbors
+  Vector<size_t> bounds;
+    // Blocks of rows with similar numbers of triangles in the descending order of rows: rows m-1-bounds[i+1] .. m-1-bounds[i]
+
+
+  ClusterDist (const PositiveAttr2 &dist,
+               const Vector<size_t> &objs_arg)
+    : objs (objs_arg)
+    , m (objs_arg. size ())
+    , d (m * m, NaN)
+    , nearest (m, inf)
+    , neighbors (m)
+    { size_t present = 0;
+      FFOR (size_t, i, m)
+        FFOR (size_t, j, m)
+          if (i != j)
+          { const Real r = dist. get (objs [i], objs [j]);
+            d [i * m + j] = r;
+            if (isNan (r))
+              continue;
+            present++;
+            minimize (nearest [i], r);
+            neighbors [i] << j;
+          }
+      sparse = present < m * m / 4;  // PAR
+      if (! sparse)
+        for (Vector<size_t>& v : neighbors)
+          v. wipe ();
+      // bounds
+      const size_t blocks = min (m, 4 * threads_max);  // PAR
+      size_t work = 0;
+      FFOR (size_t, k, m)
+        work += m - 1 - k;
+      bounds << 0;
+      size_t w = 0;
+      FFOR (size_t, k, m)
+      { w += m - 1 - k;
+        if (w * blocks >= work * bounds. size () && bounds. size () < blocks)
+          bounds << k + 1;
+      }
+      if (bounds. back () != m)
+        bounds << m;
+    }
+
+
+  const Real* row (size_t i) const
+    { return & d [i * m]; }
+  Real get (size_t i,
+            size_t j) const
+    { return d [i * m + j]; }
+  bool hopeless (size_t x,
+                 size_t y,
+                 Real dxy,
+                 Real hybridness_min) const
+    // Return: true => no triangle with the side (x,y) has hybridness >= hybridness_min
+    { return dxy < (nearest [x] + nearest [y]) * hybridness_min * (1.0 - 1e-9); }
+};
+
+
+
+void findViolations (size_t from,
+                     size_t to,
+                     Vector<Violation> &res,
+                     const ClusterDist &cd,
+                     Real hybridness_min)
+// Output: res: in the order of descending y, ascending x, ascending z
+{
+  constexpr size_t panelSize = 256 * 1024;  // PAR  L2 cache
+  const size_t m = cd. m;
+  const size_t panel = max<size_t> (1, panelSize / (sizeof (Real) * m));
+  Vector<Vector<Violation>> rowViolations;
+  FOR_START (size_t, block, from, to)
+  {
+    const size_t kStart = cd. bounds [block];
+    const size_t kEnd   = cd. bounds [block + 1];
+    for (size_t k0 = kStart; k0 < kEnd; k0 += panel)
+    {
+      // Panel of rows y = m - 1 - k, k in [k0, k1)
+      const size_t k1 = min (kEnd, k0 + panel);
+      rowViolations. resize (k1 - k0);
+      for (Vector<Violation>& v : rowViolations)
+        v. clear ();
+      const size_t yMax = m - 1 - k0;
+      if (cd. sparse)
+        FOR_START (size_t, k, k0, k1)
+        {
+          const size_t y = m - 1 - k;
+          Vector<Violation>& out = rowViolations [k - k0];
+          const Vector<size_t>& ny = cd. neighbors [y];
+          for (const size_t x : ny)
+          {
+            if (x >= y)
+              break;
+            const Real dxy = cd. get (x, y);
+            ASSERT (dxy >= 0.0);
+            if (cd. hopeless (x, y, dxy, hybridness_min))
+              continue;
+            // z in ny and cd.neighbors[x]
+            const Vector<size_t>& nx = cd. neighbors [x];
+            size_t i = 0;
+            size_t j = 0;
+            while (i < nx. size () && j < ny. size ())
+              if (nx [i] < ny [j])
+                i++;
+              else if (ny [j] < nx [i])
+                j++;
+              else
+              {
+                const size_t z = nx [i];
+                i++;
+                j++;
+                const Real dPair = cd. get (x, z) + cd. get (y, z);
+                const Real hybridness = dxy / dPair;
+                if (hybridness >= hybridness_min)
+                  out << Violation (cd. objs [x], cd. objs [y], cd. objs [z], hybridness);
+              }
+          }
+        }
+      else
+        // x-panels: a row x is reused for all rows y of the panel
+        for (size_t x0 = 0; x0 < yMax; x0 += panel)
+        {
+          const size_t x1 = min (yMax, x0 + panel);
+          FOR_START (size_t, k, k0, k1)
+          {
+            const size_t y = m - 1 - k;
+            Vector<Violation>& out = rowViolations [k - k0];
+            const Real* rowY = cd. row (y);
+            FOR_START (size_t, x, x0, min (x1, y))
+            {
+              const Real dxy = rowY [x];
+              if (isNan (dxy))
+                continue;
+              ASSERT (dxy >= 0.0);
+              if (cd. hopeless (x, y, dxy, hybridness_min))
+                continue;
+              const Real* rowX = cd. row (x);
+              FFOR (size_t, z, m)
+              {
+                const Real hybridness = dxy / (rowX [z] + rowY [z]);  // NaN if z == x or z == y
+                if (hybridness >= hybridness_min)
+                  out << Violation (cd. objs [x], cd. objs [y], cd. objs [z], hybridness);
+              }
+            }
+          }
+        }
+      for (const Vector<Violation>& v : rowViolations)
+        res << v;
+    }
+  }
+}
+
+
+
 struct Violator : Named
 {
   // # Violation's
@@ -326,47 +493,32 @@ Save clusters in " + dmSuff + "-files\
       // Triangle inequality
       List<Violation> violations;
       {
-        Progress prog (objs. size ());
-        FOR_REV (size_t, y_, objs. size ())
-        {
-          prog ();
-          FOR (size_t, x_, y_)
-            FOR (size_t, z_, objs. size ())
-              if (   z_ != x_
-                  && z_ != y_
-                 )
-              {
-                const size_t x = objs [x_];
-                const size_t y = objs [y_];
-                const size_t z = objs [z_];
-                const Real d = dist->get (x, y); 
-                if (isNan (d))
-                  continue;
-                ASSERT (d >= 0.0);
-                const Real dPair = dist->get (x, z) + dist->get (z, y);
-                if (isNan (dPair))
-                  continue;
-                ASSERT (dPair >= 0.0);
-                const Real hybridness = d / dPair;
-                if (! (hybridness >= hybridness_min))
-                  continue;
-                const Violation violation (x, y, z, hybridness);
-                violations << violation;
-                if (   violation. contains (objIndex)
-                    || verbose ()
-                   )
-                {
-                  const string xName (ds. objs [x] -> name);
-                  const string yName (ds. objs [y] -> name);
-                  const string zName (ds. objs [z] -> name);
-                  cout << "d(" << xName << "," << yName << ") = " << d 
-                           << " > d(" << xName << "," << zName << ") + d(" << zName << "," << yName << ") = " << dPair
-                         //<< " by " << deviation << " (" << fraction * 100.0 << " %)"
-                           << " hybridness = " << hybridness
-                           << endl;
-                }
-              }
-        }
+        const ClusterDist cd (*dist, objs);
+        vector<Vector<Violation>> results;
+        arrayThreads (true, findViolations, cd. bounds. size () - 1, results, cref (cd), hybridness_min);
+        for (const Vector<Violation>& res : results)
+          for (const Violation& violation : res)
+          {
+            violations << violation;
+            if (   violation. contains (objIndex)
+                || verbose ()
+               )
+            {
+              const size_t x = violation. x;
+              const size_t y = violation. y;
+              const size_t z = violation. z;
+              const Real d = dist->get (x, y); 
+              const Real dPair = dist->get (x, z) + dist->get (z, y);
+              const string xName (ds. objs [x] -> name);
+              const string yName (ds. objs [y] -> name);
+              const string zName (ds. objs [z] -> name);
+              cout << "d(" << xName << "," << yName << ") = " << d 
+                       << " > d(" << xName << "," << zName << ") + d(" << zName << "," << yName << ") = " << dPair
+                     //<< " by " << deviation << " (" << fraction * 100.0 << " %)"
+                       << " hybridness = " << violation. hybridness
+                       << endl;
+            }
+          }
       }
       cout << "# Violations = " << violations. size () << endl;
           
@@ -92,6 +92,18 @@ $THIS/clust_binomial -qc  $THIS/data/Fungi-univ-stat V1 273 -outlier_pValue 1e-5
 diff Fungi-univ-stat.clust_binomial $THIS/data/Fungi-univ-stat.clust_binomial
 rm Fungi-univ-stat.clust_binomial
 
+section "distTriangle"
+# Hybrids: H of A and D, X of B and C
+# triangle_sparse: the same violations with few distances present
+for DM in triangle triangle_sparse; do
+  for THREADS in 1 4; do
+    $THIS/distTriangle $THIS/data/$DM Dist  -hybridness_min 1.5  -hybrid triangle.hybrid  -qc  -noprogress  -threads $THREADS > triangle.distTriangle
+    diff triangle.distTriangle $THIS/data/$DM.distTriangle
+    diff triangle.hybrid $THIS/data/triangle.hybrid
+  done
+done
+rm triangle.distTriangle triangle.hybrid
+
 
 super_section "Prediction"
 section "linreg"
@@ -770,7 +770,6 @@ void MeanVar::qc () const
 {
   if (! qc_on)
     return;
-  QC_ASSERT (n >= 0);
   QC_ASSERT (s2 >= 0);
   QC_IMPLY (s2 > 0, n > 0);
 }
@@ -795,6 +794,33 @@ Histogram::Histogram (Real start_arg,
 
 
 
+Histogram::Histogram (Real binRange_arg)
+: binRange (binRange_arg)
+, growing (true)
+{ 
+  ASSERT (binRange > 0.0);
+}
+
+
+
+void Histogram::qc () const
+{
+  if (! qc_on)
+    return;
+  QC_ASSERT (binRange > 0.0);
+  if (growing)
+  {
+    QC_IMPLY (! bins. empty (), stop == start + binRange * (Real) bins. size ());
+  }
+  else
+  {
+    QC_ASSERT (start < stop);
+    QC_ASSERT (! bins. empty ());
+  }
+}
+
+
+
 void Histogram::saveText (ostream &os) const
 { 
   os << "bin\tcount" << endl;
@@ -806,8 +832,16 @@ void Histogram::saveText (ostream &os) const
 
 size_t Histogram::getBin (Real x) const
 { 
-  if (! betweenEqual (x, start, stop))
+  if (bins. empty ())
     return no_index;
+  if (growing)
+  { 
+    if (! (x >= start && x < stop))
+      return no_index;
+  }
+  else
+    if (! betweenEqual (x, start, stop))
+      return no_index;
   size_t bin = (size_t) round (floor ((x - start) / binRange));
   if (bin == bins. size ())
     bin--;
@@ -817,9 +851,45 @@ size_t Histogram::getBin (Real x) const
 
 
 
+void Histogram::extend (Real x)
+{
+  ASSERT (growing);
+  ASSERT (DM_sp::finite (x));
+  
+  const Real x_start = binRange * floor (x / binRange);
+  if (bins. empty ())
+  {
+    start = x_start;
+    stop = start + binRange;
+    bins. resize (1, 0);
+  }
+  else if (x < start)
+  {
+    const size_t add = (size_t) round ((start - x_start) / binRange);
+    ASSERT (add);
+    bins. insert (bins. begin (), add, 0);
+    start = x_start;
+  }
+  else if (x >= stop)
+    bins. resize ((size_t) round ((x_start - start) / binRange) + 1, 0);
+  stop = start + binRange * (Real) bins. size ();
+
+  ASSERT (getBin (x) != no_index);
+}
+
+
+
 Histogram& Histogram::operator<< (Real x)
 { 
-  const size_t bin = getBin (x);
+  size_t bin = getBin (x);
+  if (   bin == no_index 
+      && growing
+      && DM_sp::finite (x)
+     )
+  {
+    extend (x);
+    bin = getBin (x);
+  }
   if (bin != no_index)
     bins [bin] ++;
   return *this;
@@ -827,6 +897,166 @@ Histogram& Histogram::operator<< (Real x)
 
 
 
+Histogram& Histogram::operator<< (const Histogram &other)
+{
+  ASSERT (binRange == other. binRange);
+  ASSERT (growing == other. growing);
+  
+  if (other. bins. empty ())
+    return *this;
+  if (growing)
+  {
+    extend (other. start);
+    extend (other. stop - binRange / 2.0);
+  }
+  else
+  {
+    ASSERT (start == other. start);
+    ASSERT (stop  == other. stop);
+  }
+  
+  const size_t offset = (size_t) round ((other. start - start) / binRange);
+  ASSERT (offset + other. bins. size () <= bins. size ());
+  FFOR (size_t, i, other. bins. size ())
+    bins [offset + i] += other. bins [i];
+  
+  return *this;
+}
+
+
+
+
+// QuantileSketch
+
+QuantileSketch::QuantileSketch (size_t k_arg)
+: k (k_arg)
+{
+  ASSERT (k >= 2);
+  clear ();
+}
+
+
+
+void QuantileSketch::qc () const
+{
+  if (! qc_on)
+    return;
+  QC_ASSERT (k >= 2);
+  QC_ASSERT (! levels. empty ());
+  size_t items_ = 0;
+  size_t n_ = 0;
+  FFOR (size_t, h, levels. size ())
+  {
+    items_ += levels [h]. size ();
+    n_ += levels [h]. size () << h;
+  }
+  QC_ASSERT (items_ == items);
+  QC_ASSERT (n_ == n);
+}
+
+
+
+size_t QuantileSketch::capacity (size_t level) const
+{
+  ASSERT (level < levels. size ());
+  const size_t depth = levels. size () - 1 - level;
+  return max<size_t> (2, (size_t) ceil ((Real) k * pow (2.0 / 3.0, (Real) depth)));  // PAR
+}
+
+
+
+void QuantileSketch::compress ()
+{
+  for (;;)
+  {
+    size_t capacities = 0;
+    FFOR (size_t, h, levels. size ())
+      capacities += capacity (h);
+    if (items <= capacities)
+      break;
+    
+    size_t h = 0;
+    while (levels [h]. size () < capacity (h))
+      h++;
+    if (h + 1 == levels. size ())
+      levels. resize (levels. size () + 1);
+      
+    Vector<Real>& level = levels [h];
+    Vector<Real>& upper = levels [h + 1];
+    std::sort (level. begin (), level. end ());
+    // An odd value stays at level h
+    const size_t even = level. size () & ~ (size_t) 1;
+    const size_t first = level. size () - even;
+    for (size_t i = first + oddOffset; i < level. size (); i += 2)
+      upper << level [i];
+    oddOffset = ! oddOffset;
+    level. resize (first);
+    items -= even / 2;
+  }
+}
+
+
+
+QuantileSketch& QuantileSketch::operator<< (Real x)
+{
+  ASSERT (! isNan (x));
+  
+  levels [0] << x;
+  n++;
+  items++;
+  if (levels [0]. size () >= capacity (0))
+    compress ();
+  
+  return *this;
+}
+
+
+
+QuantileSketch& QuantileSketch::operator<< (const QuantileSketch &other)
+{
+  ASSERT (k == other. k);
+  ASSERT (this != & other);
+  
+  if (levels. size () < other. levels. size ())
+    levels. resize (other. levels. size ());
+  FFOR (size_t, h, other. levels. size ())
+    levels [h] << other. levels [h];
+  n += other. n;
+  items += other. items;
+  compress ();
+  
+  return *this;
+}
+
+
+
+Real QuantileSketch::getQuantile (Prob p) const
+{
+  ASSERT (isProb (p));
+  
+  if (empty ())
+    return NaN;
+  
+  Vector<pair<Real,size_t/*weight*/>> values;  values. reserve (items);
+  FFOR (size_t, h, levels. size ())
+    for (const Real x : levels [h])
+      values << pair<Real,size_t> (x, (size_t) 1 << h);
+  values. sort ();
+  
+  const Real target = p * (Real) n;
+  size_t weight = 0;
+  for (const auto& it : values)
+  {
+    weight += it. second;
+    if ((Real) weight >= target)
+      return it. first;
+  }
+  
+  return values. back (). first;
+}
+
+
+
 
 }
 
@@ -495,7 +495,7 @@ struct WeightedMeanVar
 struct MeanVar : Root
 {
   streamsize decimals {2};
-  int n {0};
+  size_t n {0};
   Real s {NaN};
   Real s2 {NaN};
   Real v_min {NaN};
@@ -527,6 +527,15 @@ struct MeanVar : Root
     	maximize (v_max, x);
     	return *this;
     }
+  MeanVar& operator<< (const MeanVar &other)
+    // Merge
+    { n  += other. n;
+      s  += other. s;
+      s2 += other. s2;
+      minimize (v_min, other. v_min);
+      maximize (v_max, other. v_max);
+      return *this;
+    }
   void add (const MeanVar& other,
             Real delta)
     { add_ (other, delta, false); }
@@ -537,18 +546,21 @@ private:
   void add_ (const MeanVar& other,
              Real delta,
              bool reverse)
-    { const int mode = reverse ? -1 : 1;
-      n  += mode * other. n;
-      s  += mode * (other. s + other. n * delta);
-      s2 += mode * (other. s2 + 2 * other. s * delta + other. n * sqr (delta)); 
+    { const Real mode = reverse ? -1.0 : 1.0;
+      if (reverse)
+        n -= other. n;
+      else
+        n += other. n;
+      s  += mode * (other. s + (Real) other. n * delta);
+      s2 += mode * (other. s2 + 2 * other. s * delta + (Real) other. n * sqr (delta)); 
     }
 public:
 
   // Estimates    
   Real getMean () const
-    { return n ? s / n : NaN; }
+    { return n ? s / (Real) n : NaN; }
   Real getVar (bool biased = true) const
-    { return max (0.0, s2 - n * sqr (getMean ())) / (biased ? n : (n - 1)); }
+    { return max (0.0, s2 - (Real) n * sqr (getMean ())) / ((Real) n - (biased ? 0.0 : 1.0)); }
     // biased = MLE
   Real getSD (bool biased = true) const
     { return sqrt (getVar (biased)); }
@@ -583,8 +595,14 @@ struct Correlation
       b_mv << b;
       ab += a * b;
     }
+  void add (const Correlation &other)
+    // Merge
+    { a_mv << other. a_mv;
+      b_mv << other. b_mv;
+      ab += other. ab;
+    }
   Real getCovariance () const
-    { return a_mv. n ? ab / a_mv. n - a_mv. getMean () * b_mv. getMean () : 0.0; }
+    { return a_mv. n ? ab / (Real) a_mv. n - a_mv. getMean () * b_mv. getMean () : 0.0; }
   Real getCorrelation () const
     { const Real a_sd = a_mv. getSD ();
       const Real b_sd = b_mv. getSD ();
@@ -598,16 +616,81 @@ struct Histogram : Root
 {
   Real start {NaN};
   Real stop {NaN};
+    // May be NaN if growing
   Real binRange {NaN};
+  bool growing {false};
+    // Bin i = [start + binRange * i, start + binRange * (i + 1)), start is a multiple of binRange
   Vector<size_t> bins;
   
   Histogram (Real start_arg,
              Real stop_arg,
              Real binRange_arg);
+    // Values outside [start, stop] are ignored
+  explicit Histogram (Real binRange_arg);
+    // growing
+    // Memory: O((max(x) - min(x)) / binRange)
+  void qc () const override;
   void saveText (ostream &os) const;
+  bool empty () const override
+    { return bins. empty (); }
   
   size_t getBin (Real x) const;
+    // Return: no_index <=> x is outside of bins
   Histogram& operator<< (Real x);
+  Histogram& operator<< (const Histogram &other);
+    // Merge
+    // Requires: same binRange and growing; if !growing then same start and stop
+private:
+  void extend (Real x);
+    // Output: getBin(x) != no_index
+    // Requires: growing
+};
+
+
+
+struct QuantileSketch : Root
+// Mergeable streaming quantiles: KLL sketch (Karnin, Lang, Liberty, 2016) with deterministic compaction
+// Memory: O(k)
+// Rank error: O(n/k); exact if n <= k
+{
+  size_t k {0};
+private:
+  Vector<Vector<Real>> levels;
+    // Weight of a value at level h = 2^h
+  size_t n {0};
+  size_t items {0};
+    // = sum_h levels[h].size()
+  bool oddOffset {false};
+public:
+
+
+  explicit QuantileSketch (size_t k_arg = 200);
+  void qc () const override;
+  bool empty () const override
+    { return ! n; }
+  void clear () override
+    { levels. clear ();
+      levels. resize (1);
+      n = 0;
+      items = 0;
+      oddOffset = false;
+    }
+
+
+  size_t size () const
+    { return n; }
+  QuantileSketch& operator<< (Real x);
+    // Requires: !isNan(x)
+  QuantileSketch& operator<< (const QuantileSketch &other);
+    // Merge
+    // Requires: same k
+  Real getQuantile (Prob p) const;
+    // Return: min. x such that P(X <= x) >= p; NaN if empty()
+  Real getMedian () const
+    { return getQuantile (0.5); }
+private:
+  size_t capacity (size_t level) const;
+  void compress ();
 };
 
  
@@ -87,6 +87,51 @@ struct ThisApplication : Application
 	    ASSERT_EQ (exp (sum. getLn ()), 1, 1e-6);
  	  }
 
+    {
+      QuantileSketch small (100);
+      FOR_REV (uint, i, 99)
+        small << (Real) i;
+      small. qc ();
+      ASSERT (small. getQuantile (0.0) == 0.0);
+      ASSERT (small. getMedian () == 49.0);
+      ASSERT (small. getQuantile (1.0) == 98.0);
+
+      // Permutation of 0 .. n-1 split into 2 merged streams
+      const uint n = 1000000;
+      QuantileSketch a (1000);
+      QuantileSketch b (1000);
+      FOR (uint, i, n)
+      {
+        const Real x = (Real) (((size_t) i * 7919) % n);
+        if (i % 3)
+          a << x;
+        else
+          b << x;
+      }
+      a << b;
+      a. qc ();
+      ASSERT (a. size () == n);
+      for (const Prob p : {0.01, 0.25, 0.5, 0.75, 0.99})
+        ASSERT_EQ (a. getQuantile (p) / n, p, 0.01);
+    }
+
+    {
+      Histogram a (0.5);
+      Histogram b (0.5);
+      a << 1.2 << 3.0 << -0.7;
+      b << 10.0 << 1.0;
+      a << b;
+      a. qc ();
+      ASSERT (a. start == -1.0);
+      ASSERT (a. bins. size () == 23);
+      ASSERT (a. bins [a. getBin (1.1)] == 2);
+      ASSERT (a. bins. back () == 1);
+      size_t total = 0;
+      for (const size_t c : a. bins)
+        total += c;
+      ASSERT (total == 5);
+    }
+
   #if 0
     #define REAL2STR(x)  cout << #x << ": " << real2str (x,6) << endl;
  	  REAL2STR (0);
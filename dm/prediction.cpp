@@ -112,31 +112,68 @@ namespace
 struct LogRegFuncMult : FuncMult
 {
   LogisticRegression& lr;
+  unique_ptr<const DenseSpace> dense;
+    // nullptr <=> lr.space has missing values
+    // Is reused by all iterations
+  Vector<Real> targets;
+    // size() = dense->size()
+private:
+  // Temporary
+  Vector<Real> scores;
+  Vector<Real> weights;
+public:
   
 
   LogRegFuncMult (LogisticRegression &lr_arg)
     : FuncMult (lr_arg. space. size ())
     , lr (lr_arg)
-    {}
+    { if (lr. space. existsMissing ())
+        return;
+      dense. reset (new DenseSpace (lr. sample, lr. space));
+      targets. reserve (dense->size ());
+      for (const size_t objNum : dense->objNums)
+        targets << (Real) lr. target. getBool (objNum);
+      weights. resize (dense->size ());
+    }
 
 
 
   Real f (const MVector &x)
     { 
       lr. beta = x; 
-      return lr. getNegLogLikelihood_ave ();
+      if (! dense)
+        return lr. getNegLogLikelihood_ave ();
+      dense->multiply (lr. beta, scores);
+      Real s = 0;
+      FFOR (size_t, i, scores. size ())
+      {
+        const Real z = scores [i];
+        s += dense->mults [i] * (log (exp (z) + 1) - z * targets [i]);
+      }
+      ASSERT (s >= 0);
+      return s / lr. sample. mult_sum;
     }
 
   void getGradient (const MVector &x,
          				    MVector &gradient)
     {
       lr. beta = x; 
-      gradient. putAll (0);
-      for (Iterator it (lr. sample); it ();)  
+      if (dense)
       {
-        const Real a = it. mult * (lr. predict (*it) - lr. target. getBool (*it));
-        FOR (size_t, argNum, maxArgNum)
-      		gradient. putInc (false, argNum, 0, a * lr. space [argNum] -> getReal (*it));
+        dense->multiply (lr. beta, scores);
+        FFOR (size_t, i, scores. size ())
+          weights [i] = dense->mults [i] * (probit (scores [i]) - targets [i]);
+        dense->multiplyTransposed (weights, gradient);
+      }
+      else
+      {
+        gradient. putAll (0);
+        for (Iterator it (lr. sample); it ();)  
+        {
+          const Real a = it. mult * (lr. predict (*it) - lr. target. getBool (*it));
+          FOR (size_t, argNum, maxArgNum)
+        		gradient. putInc (false, argNum, 0, a * lr. space [argNum] -> getReal (*it));
+        }
       }
       gradient. putProdAll (1 / lr. sample. mult_sum);
     }
@@ -146,16 +183,29 @@ struct LogRegFuncMult : FuncMult
         			     Matrix &hessian)
     { 
       lr. beta = x; 
-      hessian. putAll (0.0);
-      for (Iterator it (lr. sample); it ();)  
+      if (dense)
       {
-        const Prob p = lr. predict (*it) ;
-        const Real a = it. mult * p * (1 - p);
-        FOR (size_t, argNum1, maxArgNum)
+        dense->multiply (lr. beta, scores);
+        FFOR (size_t, i, scores. size ())
         {
-          const Real x1 = lr. space [argNum1] -> getReal (*it);
-          FOR (size_t, argNum2, maxArgNum)
-        		hessian. putInc (false, argNum1, argNum2, a * x1 * lr. space [argNum2] -> getReal (*it));
+          const Prob p = probit (scores [i]);
+          weights [i] = dense->mults [i] * p * (1 - p);
+        }
+        dense->getGram (& weights, hessian);
+      }
+      else
+      {
+        hessian. putAll (0.0);
+        for (Iterator it (lr. sample); it ();)  
+        {
+          const Prob p = lr. predict (*it) ;
+          const Real a = it. mult * p * (1 - p);
+          FOR (size_t, argNum1, maxArgNum)
+          {
+            const Real x1 = lr. space [argNum1] -> getReal (*it);
+            FOR (size_t, argNum2, maxArgNum)
+          		hessian. putInc (false, argNum1, argNum2, a * x1 * lr. space [argNum2] -> getReal (*it));
+          }
         }
       }
       hessian. putProdAll (1 / lr. sample. mult_sum);
@@ -898,9 +948,15 @@ void L2LinearNumPrediction::solveUnconstrained ()
 {
   absCriterion = NaN;
   const bool existsMissing = getExistsMissing ();
-
-
-  setAttrSim (attrSim, existsMissing);
+  
+  unique_ptr<const DenseSpace> dense;
+  if (existsMissing)
+    setAttrSim (attrSim, existsMissing);
+  else
+  {
+    dense. reset (new DenseSpace (sample, space));
+    dense->getGram (nullptr, attrSim);
+  }
   
 #if 0
   // Ridge ??
@@ -920,32 +976,42 @@ void L2LinearNumPrediction::solveUnconstrained ()
   // xy
   MVector xy (space. size ());
   FFOR (size_t, attrNum, space. size ())
-  {
-    const NumAttr1& a = * space [attrNum];
-    Real s = 0.0;
-    Real mult_sum = 0.0;
-    FFOR (size_t, i, sample. mult. size ())
-      if (const Real mult = sample. mult [i])
-      {
-      	const Real x = a. getReal (i);
-      	if (existsMissing)
+    if (dense)
+    {
+      const Real* x = dense->column (attrNum);
+      Real s = 0.0;
+      FFOR (size_t, i, dense->size ())
+        s += x [i] * target [dense->objNums [i]] * dense->mults [i];
+      ASSERT (! isNan (s));
+      xy [attrNum] = s;
+    }
+    else
+    {
+      const NumAttr1& a = * space [attrNum];
+      Real s = 0.0;
+      Real mult_sum = 0.0;
+      FFOR (size_t, i, sample. mult. size ())
+        if (const Real mult = sample. mult [i])
         {
-	      	if (isNan (x))
-	      		continue;
-	      	if (isNan (target [i]))
-	      		continue;
-	        mult_sum += mult;
-	      }
-        s += x * target [i] * mult;
-      }
-    if (existsMissing)
-	    xy [attrNum] = mult_sum > 0.0 ? s / mult_sum : 0.0;
-	  else
-	  {
-	    ASSERT (! isNan (s));
-	    xy [attrNum] = s;
-	  }
- 	}
+        	const Real x = a. getReal (i);
+        	if (existsMissing)
+          {
+  	      	if (isNan (x))
+  	      		continue;
+  	      	if (isNan (target [i]))
+  	      		continue;
+  	        mult_sum += mult;
+  	      }
+          s += x * target [i] * mult;
+        }
+      if (existsMissing)
+  	    xy [attrNum] = mult_sum > 0.0 ? s / mult_sum : 0.0;
+  	  else
+  	  {
+  	    ASSERT (! isNan (s));
+  	    xy [attrNum] = s;
+  	  }
+   	}
 
 
   // beta
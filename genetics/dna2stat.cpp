@@ -70,7 +70,7 @@ struct ThisApplication : Application
 	  size_t ambiguities = 0;
 	  size_t gc = 0;
     constexpr size_t repeatLen_max = 15;  // PAR
-    Vector<size_t> acgt (128, 0);
+    array<size_t,4> acgt {};
     Vector<size_t> repeat (repeatLen_max, 0);
 	  {
 		  Multifasta faIn (inFName, false);
@@ -82,33 +82,14 @@ struct ThisApplication : Application
 	
 			  len += dna. seq. size ();
 			  
-			  char prev = ' ';
-			  size_t repeatLen = 1;
-			  for (const char c : dna. seq)
-			    if (charInSet (c, "acgt"))
-			    {
-			      if (   c == 'g'
-			          || c == 'c'
-			         )
-			        gc++;
-			      if (c == prev)
-			        repeatLen++;
-			      else
-			      {
-			        if (repeatLen < repeatLen_max)
-			          repeat [repeatLen] ++;
-			        repeatLen = 1;
-			      }
-			      acgt [(size_t) c] ++;
-			      prev = c;
-			    }
-			    else
-			    {
-			      ambiguities++;
-			      prev = ' ';
-			    }
-	      if (repeatLen < repeatLen_max)
-	        repeat [repeatLen] ++;
+			  const PackedDna packed (dna);
+			  array<size_t,4> counts;
+			  packed. countNucleotides (0, packed. size (), counts);
+			  FOR (size_t, i, 4)
+			    acgt [i] += counts [i];
+			  gc += counts [1] + counts [2];
+			  ambiguities += packed. getAmbiguities ();
+			  packed. addRuns (repeat);
 	    }
       ASSERT (! repeat [0]);
 		}
@@ -127,10 +108,10 @@ struct ThisApplication : Application
 	    cout << '\t' << (double) (repeat [8] * 8) / (double) len_pure;
 	#endif
 	  if (acgtP)
-	    cout << '\t' << (double) acgt ['a'] / (double) len_pure
-	         << '\t' << (double) acgt ['c'] / (double) len_pure
-	         << '\t' << (double) acgt ['g'] / (double) len_pure
-	         << '\t' << (double) acgt ['t'] / (double) len_pure;
+	    cout << '\t' << (double) acgt [0] / (double) len_pure
+	         << '\t' << (double) acgt [1] / (double) len_pure
+	         << '\t' << (double) acgt [2] / (double) len_pure
+	         << '\t' << (double) acgt [3] / (double) len_pure;
 	  cout << endl;
   }  
 };
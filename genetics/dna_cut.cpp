@@ -53,13 +53,14 @@ struct ThisApplication : Application
     : Application ("Cut a segment out of a DNA sequence, make it to be in a positive strand")
     {
       version = VERSION;
-  	  addPositional ("in", "DNA FASTA file with one sequence");
+  	  addPositional ("in", "DNA FASTA file with one sequence, or a multi-FASTA file if -id is used");
   	  addPositional ("start", "Start position of a segment, 1-based");
   	  addPositional ("stop", "Stop position of a segment, can be equal start");
   	  addKey ("flank", "length of flanking sequence", "0");
   	  addFlag ("excise", "Excise the segment, otherwise leave the segment");
   	  addKey ("strand", "Strand (0 or - / 1 or +)", "1");
   	  addKey ("name", "Name of the resulting sequence", "");
+  	  addKey ("id", "Identifier of the sequence in the multi-FASTA file <in>. The index file <in>.fidx is used, which is created if needed");
     }
 
 
@@ -73,6 +74,7 @@ struct ThisApplication : Application
 	  const bool excise    = getFlag ("excise");	  
 	  const string strandS = getArg ("strand");
 	  const string name    = getArg ("name");
+	  const string id      = getArg ("id");
 	  
 	  
 	  size_t start = min (start_, stop_);
@@ -92,15 +94,34 @@ struct ThisApplication : Application
 
 	  
 	  Dna* dna = nullptr;  // Not delete'd
+	  const FastaIndex* index = nullptr;
+	  size_t recNum = 0;
+	  size_t len = 0;
+	  if (id. empty ())
 	  {
   	  constexpr size_t size = 1024 * 1024;  // PAR
   	  LineInput li (inFName);
   	  QC_ASSERT (li. nextLine ());
       dna = new Dna (li, size, false);  
     }
-    ASSERT (dna);
-    dna->qc ();    
-    const size_t len = dna->seq. size ();
+    else
+    {
+      index = & FastaIndex::get (inFName);
+      const Vector<size_t>* recNums = index->find (id);
+      if (! recNums)
+        throw runtime_error ("Sequence " + strQuote (id) + " is not found in " + shellQuote (inFName));
+      QC_ASSERT (recNums->size () == 1);
+      recNum = recNums->front ();
+      if (excise || ! index->records [recNum]. lineBases)
+        dna = new Dna (* index->fasta, recNum, false);
+      else
+        len = index->records [recNum]. len;
+    }
+    if (dna)
+    {
+      dna->qc ();    
+      len = dna->seq. size ();
+    }
     QC_ASSERT (stop <= len);
     
     if (start > flank)
@@ -113,10 +134,23 @@ struct ThisApplication : Application
     else
       stop = len;
       
-    dna->seq = (excise 
-                  ? dna->seq. substr (0, start) + dna->seq. substr (stop)
-                  : dna->seq. substr (start, stop - start)
-               );
+    if (dna)
+      dna->seq = (excise 
+                    ? dna->seq. substr (0, start) + dna->seq. substr (stop)
+                    : dna->seq. substr (start, stop - start)
+                 );
+    else
+    {
+      // Only the segment is read
+      ASSERT (index);
+      string seq;
+      EXEC_ASSERT (index->getSubseq (recNum, start, stop, seq));
+      string header (index->fasta->getHeader (recNum));
+      replace (header, '\t', ' ');
+      dna = new Dna (header, seq, false);
+      strLower (dna->seq);
+      dna->qc ();
+    }
     if (! strand)
       dna->reverse ();
     {
@@ -0,0 +1,95 @@
+#!/bin/bash --noprofile
+THIS=`dirname $0`
+source $THIS/../bash_common.sh
+if [ $# -ne 1 ]; then
+  echo "Test dna_cut -id with a FASTA index vs. dna_cut of a single-sequence file"
+  echo "#1: go"
+  exit 1
+fi
+
+
+TMP=`mktemp`
+comment $TMP
+
+
+function compare
+{
+  local FA=$1
+  local ID=$2
+  local START=$3
+  local STOP=$4
+  awk -v id=">$ID" '/^>/{h = $1; sub (/\r$/, "", h); p = (h == id)} p' $FA > $TMP.one
+  $THIS/dna_cut $TMP.one $START $STOP -qc > $TMP.single
+  $THIS/dna_cut $FA $START $STOP -id $ID -qc > $TMP.indexed
+  diff $TMP.single $TMP.indexed
+  $THIS/dna_cut $TMP.one $START $STOP -strand - -qc > $TMP.single
+  $THIS/dna_cut $FA $START $STOP -strand - -id $ID -qc > $TMP.indexed
+  diff $TMP.single $TMP.indexed
+}
+
+
+section "FASTA"
+cat > $TMP.fa << EOF
+>regular first
+acgtacgtac
+gtacgtacgt
+acgtac
+>irregular
+acgtacgtac
+gtacgt
+acgtacgtacgtac
+>trailing_blank some description
+ggccggccaa
+ttggccggcc
+aa
+
+>gap
+acgtac-gta
+cgtacgt
+>last
+ttttaaaacc
+ccgg
+EOF
+
+section "Regular and irregular lines"
+for ID in regular irregular trailing_blank gap last; do
+  compare $TMP.fa $ID 3 14
+done
+compare $TMP.fa regular 1 26
+compare $TMP.fa regular 10 11
+[ -s $TMP.fa.fidx ]
+
+section "Index is reused"
+compare $TMP.fa irregular 5 20
+
+section "Index is stale"
+sed 's/^ttttaaaacc$/ccccggggtt/' $TMP.fa > $TMP.fa1
+mv $TMP.fa1 $TMP.fa
+compare $TMP.fa last 1 14
+$THIS/dna_cut $TMP.fa 1 10 -id last -qc > $TMP.indexed
+[ "`tail -1 $TMP.indexed`" == "ccccggggtt" ]
+
+section "CRLF"
+sed 's/$/\r/' $TMP.fa > $TMP.crlf.fa
+for ID in regular irregular trailing_blank gap last; do
+  compare $TMP.crlf.fa $ID 3 14
+done
+
+section "Non-blank line after a blank line"
+cat > $TMP.bad.fa << EOF
+>good
+acgtacgtac
+>bad
+acgtacgtac
+
+gtacgtacgt
+EOF
+set +o errexit
+$THIS/dna_cut $TMP.bad.fa 1 5 -id good -qc &> $TMP.err
+S=$?
+set -o errexit
+[ $S -ne 0 ]
+grep -q "Non-blank line after a blank line" $TMP.err
+
+
+rm -r $TMP*
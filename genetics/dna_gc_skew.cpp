@@ -74,28 +74,14 @@ struct ThisApplication : Application
     
     // CpG ??
     
-    size_t cg = 0;
-    int g = 0; 
-    FFOR (size_t, i, dna. seq. size ())
+    const PackedDna packed (dna);
+    for (size_t i = window; i < packed. size (); i += window)
     {
-      if (i % window == 0)
-      {
-        if (cg)
-          cout << i - window << '\t' << (double) g / (double) cg << endl;
-        cg = 0;
-        g = 0;
-      }
-      const char nuc = dna. seq [i];
-      if (   nuc == 'c' 
-          || nuc == 'g'
-         )
-      {
-        cg++;
-        if (nuc == 'g')
-          g++;
-        else
-          g--;
-      }
+      array<size_t,4> acgt;
+      packed. countNucleotides (i - window, i, acgt);
+      const size_t cg = acgt [1] + acgt [2];
+      if (cg)
+        cout << i - window << '\t' << ((double) acgt [2] - (double) acgt [1]) / (double) cg << endl;
     }
 	}
 };
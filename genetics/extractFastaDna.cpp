@@ -57,6 +57,7 @@ struct ThisApplication : Application
 		  addPositional ("target", "List of sequence ids");
 		  addFlag ("remove", "Target list must be removed from the input file, otherwise only the target list is printed");
 		  addFlag ("whole", "Sequence identifiers are whole strings which should not be split by '|'");
+		  addFlag ("index", "Read only the target sequences using the index file <in>.fidx, which is created if needed");
 	  }
 
   
@@ -67,6 +68,9 @@ struct ThisApplication : Application
 	  const string targetFName = getArg ("target");
 	  const bool removeTarget  = getFlag ("remove");
 	  const bool whole         = getFlag ("whole");
+	  const bool useIndex      = getFlag ("index");
+	  
+	  QC_IMPLY (useIndex, ! removeTarget);
 
   
     Set<string> names;
@@ -81,6 +85,34 @@ struct ThisApplication : Application
     }
 
 
+    if (useIndex)
+    {
+      const FastaIndex& index = FastaIndex::get (inFName);
+      Vector<size_t> recNums;
+      if (whole)
+      {
+        for (const string& name : names)
+          if (const Vector<size_t>* nameRecNums = index. find (name))
+            recNums << *nameRecNums;
+        recNums. sort ();
+      }
+      else
+        FFOR (size_t, recNum, index. records. size ())
+        {
+          string id (index. records [recNum]. id);
+          if (names. contains (findSplit (id, '|')))
+            recNums << recNum;
+        }
+      for (const size_t recNum : recNums)
+      {
+		    const Dna dna (* index. fasta, recNum, true);
+		    ASSERT (! strBlank (dna. seq));		
+	      dna. saveText (cout);
+      }
+      return;
+    }
+
+
 		{
 		  Multifasta fa (inFName, false);
 		  while (fa. next ())
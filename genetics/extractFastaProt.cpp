@@ -74,6 +74,40 @@ struct Replacement : Named
 
 
 
+void savePeptide (const Peptide &pep,
+                  const Vector<Replacement>* repls,
+                  bool cut,
+                  size_t len_min)
+// Input: repls: nullptr <=> no replacement
+// Output: cout
+{
+	if (repls)
+	{
+		ASSERT (! repls->empty ());
+		for (const Replacement& repl : *repls)
+		{
+		  Peptide pep1 (pep);
+  		if (cut)
+  		{
+  			if (repl. to > pep. seq. size ())
+  				throw runtime_error (pep. name + ": to = " + toString (repl. to) + ", but len = " + toString (pep. seq. size ()));
+  			pep1. seq = pep. seq. substr (repl. from, repl. size ());
+  		}
+  		pep1. name = repl. name + " " + pep. name;
+  		if (cut)
+  		  pep1. name += ":" + toString (repl. from + 1) + "-" + toString (repl. to);
+  	  if (pep1. seq. size () >= len_min)
+        pep1. saveText (cout);
+    }
+	}
+	else
+	  if (pep. seq. size () >= len_min)
+      pep. saveText (cout);
+}
+
+
+
+
 struct ThisApplication : Application
 {
   ThisApplication ()
@@ -86,6 +120,7 @@ struct ThisApplication : Application
 		  addFlag ("replace", "Replace sequence ids. There can be more than 1 replacement");
 		  addFlag ("cut", "Cut out the segment indicated by <from> <to>");
 		  addKey ("min_len", "Min. sequence length", "20");
+		  addFlag ("index", "Read only the target sequences using the index file <in>.fidx, which is created if needed");
 	  }
 
   
@@ -98,8 +133,10 @@ struct ThisApplication : Application
 	  const bool replaceP      = getFlag ("replace");
 	  const bool cut           = getFlag ("cut"); 
 	  const size_t len_min     = str2<size_t> (getArg ("min_len"));
+	  const bool useIndex      = getFlag ("index");
 	  
 	  QC_IMPLY (removeTarget, ! replaceP);
+	  QC_IMPLY (useIndex, ! removeTarget);
 	  QC_IMPLY (cut, replaceP);
 
   
@@ -137,6 +174,24 @@ struct ThisApplication : Application
     }
 
 
+    if (useIndex)
+    {
+      const FastaIndex& index = FastaIndex::get (inFName);
+      Vector<size_t> recNums;
+      for (const auto& it : name2replacement)
+        if (const Vector<size_t>* nameRecNums = index. find (it. first))
+          recNums << *nameRecNums;
+      recNums. sort ();
+      for (const size_t recNum : recNums)
+      {
+		    const Peptide pep (* index. fasta, recNum, true);
+		    ASSERT (! strBlank (pep. seq));		
+	    	savePeptide (pep, replaceP ? & name2replacement [pep. getId ()] : nullptr, cut, len_min);
+      }
+      return;
+    }
+
+
 		{
 		  Multifasta fa (inFName, true);
 		  while (fa. next ())
@@ -144,31 +199,7 @@ struct ThisApplication : Application
 		    const Peptide pep (fa, 1000/*PAR*/, true);
 		    ASSERT (! strBlank (pep. seq));		
 		    if ((! removeTarget) == contains (name2replacement, pep. getId ()))   
-		    {
-		    	if (replaceP)
-		    	{
-		    		const Vector<Replacement>& repls = name2replacement [pep. getId ()];
-		    		ASSERT (! repls. empty ());
-		    		for (const Replacement& repl : repls)
-		    		{
-		    		  Peptide pep1 (pep);
-  		    		if (cut)
-  		    		{
-  		    			if (repl. to > pep. seq. size ())
-  		    				throw runtime_error (pep. name + ": to = " + toString (repl. to) + ", but len = " + toString (pep. seq. size ()));
-  		    			pep1. seq = pep. seq. substr (repl. from, repl. size ());
-  		    		}
-  		    		pep1. name = repl. name + " " + pep. name;
-  		    		if (cut)
-  		    		  pep1. name += ":" + toString (repl. from + 1) + "-" + toString (repl. to);
-  		    	  if (pep1. seq. size () >= len_min)
-  		          pep1. saveText (cout);
-  		      }
-		    	}
-		    	else
-		    	  if (pep. seq. size () >= len_min)
-		          pep. saveText (cout);
-		    }
+		    	savePeptide (pep, replaceP ? & name2replacement [pep. getId ()] : nullptr, cut, len_min);
 		  }
 		}
   }
@@ -77,12 +77,12 @@ struct ThisApplication : Application
 		    if (dna. seq. size () < len_min)  
 		      continue;
 		    
-		    const map<char,size_t> chars (dna. getCharCount ());
-		    const size_t a = chars. at ('a');
-		    const size_t c = chars. at ('c');
-		    const size_t g = chars. at ('g');
-		    const size_t t = chars. at ('t');
-		    const size_t all = a + c + g + t;
+		    const PackedDna packed (dna);
+		    array<size_t,4> acgt;
+		    packed. countNucleotides (0, packed. size (), acgt);
+		    const size_t c = acgt [1];
+		    const size_t g = acgt [2];
+		    const size_t all = acgt [0] + c + g + acgt [3];
 		    if (all < len_min)
 		  //if ((Real) all / (Real) dna. seq. size () < 0.99)  // PAR
 		      continue;
@@ -47,6 +47,28 @@ namespace
 {
 	
 	
+void getLens (size_t from,
+              size_t to,
+              Vector<size_t> &lens,
+              const MappedFasta &fa,
+              bool aa)
+// Output: lens
+{
+  lens. reserve (to - from);
+  FOR_START (size_t, i, from, to)
+  {
+  	unique_ptr<const Seq> seq;
+  	if (aa)
+  		seq. reset (new Peptide (fa, i, false));
+  	else
+  		seq. reset (new Dna     (fa, i, false));
+    seq->qc ();
+    lens << seq->seq. size ();
+  }
+}
+
+	
+	
 struct ThisApplication : Application
 {
   ThisApplication ()
@@ -72,6 +94,32 @@ struct ThisApplication : Application
 	  unique_ptr<OFStream> outF;
 	  if (! outFName. empty ())
 	  	outF. reset (new OFStream (outFName));
+	  if (getFiletype (inFName, true) == Filetype::file)
+	  {
+	    // Parallel
+	    const MappedFasta faIn (inFName);
+	    vector<Vector<size_t>> results;
+	    arrayThreads (true, getLens, faIn. size (), results, cref (faIn), aa);
+	    size_t recNum = 0;
+	    for (const Vector<size_t>& lens : results)
+	      for (const size_t len : lens)
+	      {
+	        cout << faIn. getId (recNum) << '\t' << len << '\n';
+	        if (outF. get () && len >= len_min)
+	        {
+	        	unique_ptr<const Seq> seq;
+	        	if (aa)
+	        		seq. reset (new Peptide (faIn, recNum, false));
+	        	else
+	        		seq. reset (new Dna     (faIn, recNum, false));
+	        	seq->saveText (*outF);
+	        }
+	        recNum++;
+	      }
+	    ASSERT (recNum == faIn. size ());
+	    return;
+	  }
+
 	  Multifasta faIn (inFName, aa);
 	  while (faIn. next ())
 	  {
@@ -48,16 +48,6 @@ namespace
 	
 	
 	
-struct UniqSeq
-{
-  const Seq* seq {nullptr};
-    // !nullptr
-    // Not delete'd
-  StringVector ids;
-};
-	
-	
-
 struct ThisApplication : Application
 {
   ThisApplication ()
@@ -78,44 +68,12 @@ struct ThisApplication : Application
 	  const bool   aa        = getFlag ("aa");
 
 
-    unordered_map<size_t/*hash*/,string> hash2id;  hash2id. rehash (1000000);  // PAR
-		{
-		  Multifasta fa (inFName1, aa);
-		  while (fa. next ())
-		  {
-		    unique_ptr<Seq> seq;
-		    if (aa)
-		      seq. reset (new Peptide (fa, 1000/*PAR*/, false));
-		    else
-		      seq. reset (new Dna (fa, 1000/*PAR*/, false));  
-		    ASSERT (seq. get ());
-		    seq->qc ();
-		    QC_ASSERT (! seq->getId (). empty ());
-		    
-		    const size_t h = str_hash (seq->seq);
-		    hash2id [h] = seq->name;
-		  }
-		}
-
-		{
-		  Multifasta fa (inFName2, aa);
-		  while (fa. next ())
-		  {
-		    unique_ptr<Seq> seq;
-		    if (aa)
-		      seq. reset (new Peptide (fa, 1000/*PAR*/, false));
-		    else
-		      seq. reset (new Dna (fa, 1000/*PAR*/, false));  
-		    ASSERT (seq. get ());
-		    seq->qc ();
-		    QC_ASSERT (! seq->getId (). empty ());
-		    
-		    const size_t h = str_hash (seq->seq);
-		    if (const string* s = findPtr (hash2id, h))
-		      cout << *s << '\t' << seq->name << endl;
-		  }
-		}
-
+    const SeqDedup dedup1 (inFName1, aa);
+    const SeqDedup dedup2 (inFName2, aa);
+    const Vector<size_t> matches (dedup1. find (dedup2));
+    FFOR (size_t, recNum, dedup2. size ())
+      if (matches [recNum] != no_index)
+        cout << dedup1. getName (matches [recNum]) << '\t' << dedup2. getName (recNum) << endl;
   }
 };
 
@@ -0,0 +1,69 @@
+#!/bin/bash --noprofile
+THIS=`dirname $0`
+source $THIS/../bash_common.sh
+if [ $# -ne 1 ]; then
+  echo "Test Multifasta: memory-mapped regular file vs. streamed pipe"
+  echo "#1: go"
+  exit 1
+fi
+
+
+TMP=`mktemp`
+comment $TMP
+
+
+function compare
+{
+  local FA=$1
+  local AA=$2
+  $THIS/seq_print $FA $AA -qc > $TMP.mapped
+  $THIS/seq_print <(cat $FA) $AA -qc > $TMP.streamed
+  diff $TMP.mapped $TMP.streamed
+  [ -s $TMP.mapped ]
+}
+
+
+section "DNA"
+cat > $TMP.dna << EOF
+>wrapped first sequence
+acgtacgtac
+gtacgtacgt
+acgtac
+>irregular
+ACGTACGTAC
+gtacgt
+acgtacgtacgtacgtacgtacgtacgt
+>one_line  trailing spaces
+acgtnnnnacgt
+>trailing_blank_lines
+ggccggccaa
+ttggccggcc
+
+
+>gap
+acgtac-gtacgt-
+EOF
+compare $TMP.dna ""
+
+section "No end-of-line at the end"
+printf ">first\nacgtacgt\nacgt\n>last description\nacgtacgt\nacg" > $TMP.noeol
+compare $TMP.noeol ""
+
+section "CRLF"
+sed 's/$/\r/' $TMP.dna > $TMP.crlf
+compare $TMP.crlf ""
+
+section "Protein"
+cat > $TMP.prot << EOF
+>prot1 wrapped
+MKLVAAGGLL
+ARNDCQEGHI
+LKMF
+>prot2
+MSTNPKPQRKTKRNTNRRPQDVKFPGG*
+EOF
+printf ">prot3\nMKKL" >> $TMP.prot
+compare $TMP.prot -aa
+
+
+rm -r $TMP*
@@ -0,0 +1,159 @@
+// packedDna_test.cpp
+
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE                          
+*               National Center for Biotechnology Information
+*                                                                          
+*  This software/database is a "United States Government Work" under the   
+*  terms of the United States Copyright Act.  It was written as part of    
+*  the author's official duties as a United States Government employee and 
+*  thus cannot be copyrighted.  This software/database is freely available 
+*  to the public for use. The National Library of Medicine and the U.S.    
+*  Government have not placed any restriction on its use or reproduction.  
+*                                                                          
+*  Although all reasonable efforts have been taken to ensure the accuracy  
+*  and reliability of the software and data, the NLM and the U.S.          
+*  Government do not and cannot warrant the performance or results that    
+*  may be obtained by using this software or data. The NLM and the U.S.    
+*  Government disclaim all warranties, express or implied, including       
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.                                                                
+*                                                                          
+*  Please cite the author in any work or product based on this material.   
+*
+* ===========================================================================
+*
+* Author: Vyacheslav Brover
+*
+* File Description:
+*   Test of PackedDna in seq.{hpp,cpp}
+*
+*/
+
+
+#undef NDEBUG
+#include "../common.inc"
+
+#include "../common.hpp"
+using namespace Common_sp;
+#include "seq.hpp"
+using namespace Seq_sp;
+#include "../version.inc"
+
+
+
+namespace
+{
+  
+  
+string randomDna (Rand &rand,
+                  size_t len)
+// Return: acgt are lower-case, with ambiguous characters of both cases
+{
+  static const string ambiguous ("nrykmswbdhvNRYKMSWBDHV");
+  string s (len, ' ');
+  for (char &c : s)
+    if (rand. get (8))
+      c = dnaAlphabet [rand. get (4)];
+    else
+      c = ambiguous [rand. get (ambiguous. size ())];
+  return s;
+}
+
+
+
+struct ThisApplication : Application
+{
+  ThisApplication ()
+    : Application ("Test PackedDna")
+  	{
+  	  version = VERSION;
+  	  addPositional ("go", "Go");
+  	}
+
+
+
+	void body () const final
+	{  
+	  Rand rand (seed_global);
+	  const size_t k_max = 32;
+	  for (const size_t len : Vector<size_t> {0, 1, 5, 31, 32, 33, 63, 64, 65, 100, 127, 128, 129, 1000})
+	    FOR (size_t, iter, 10)
+  	  {
+  	    const string s (randomDna (rand, len));
+  	    const PackedDna pd (s);
+  	    pd. qc ();
+  	    QC_ASSERT (pd. size () == len);
+  	    QC_ASSERT (pd. unpack () == s);
+  	    
+  	    // reverse()
+  	    {
+    	    PackedDna rev (pd);
+    	    rev. reverse ();
+    	    rev. qc ();
+    	    Dna dna ("test", s, false);
+    	    dna. reverse ();
+    	    QC_ASSERT (rev. unpack () == dna. seq);
+    	  }
+  	    
+  	    // countGC()
+  	    FOR (size_t, start, len + 1)
+  	    {
+  	      size_t gc = 0;
+  	      for (size_t stop = start; stop <= len; stop++)
+  	      {
+  	        QC_ASSERT (pd. countGC (start, stop) == gc);
+  	        if (stop < len && (s [stop] == 'c' || s [stop] == 'g'))
+  	          gc++;
+  	      }
+  	    }
+  	    
+  	    // getKmer()
+  	    FOR (size_t, start, len + 1)
+  	      FOR (size_t, k, k_max + 1)
+  	      {
+  	        bool ok = start + k <= len;
+  	        PackedDna::Word kmer_ = 0;
+  	        if (ok)
+  	        {
+    	        FOR (size_t, i, k)
+    	          if (const char* p = strchr (dnaAlphabet, s [start + i]))
+    	            kmer_ |= (PackedDna::Word) (p - dnaAlphabet) << (2 * i);
+    	          else
+    	            ok = false;
+    	      }
+  	        PackedDna::Word kmer = 0;
+  	        QC_ASSERT (pd. getKmer (start, k, kmer) == ok);
+  	        if (ok)
+  	        {
+  	          QC_ASSERT (kmer == kmer_);
+  	        }
+  	      }
+  	  }
+  	  
+  	  // Characters without a complement
+  	  {
+  	    PackedDna pd ("acx-gN");
+  	    pd. reverse ();
+  	    pd. qc ();
+  	    QC_ASSERT (pd. unpack () == "Nc-xgt");
+  	  }
+	}
+};
+
+
+
+}  // namespace
+
+
+
+int main (int argc, 
+          const char* argv[])
+{
+  ThisApplication app;
+  return app. run (argc, argv);
+}
+
+
+
@@ -38,6 +38,10 @@
 #include "seq.hpp"
 
 #include <cmath>
+#ifndef _MSC_VER
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
 
 
 
@@ -149,6 +153,52 @@ Seq::Seq (LineInput &fasta,
           bool sparse_arg,
      	    bool makeUpper)
 : sparse (sparse_arg)
+{
+  readFasta (fasta, reserveLen);
+  finishFasta (makeUpper);
+}
+
+
+
+Seq::Seq (Multifasta &fasta,
+          size_t reserveLen,
+          bool sparse_arg,
+     	    bool makeUpper)
+: sparse (sparse_arg)
+{
+#ifndef _MSC_VER
+  if (const MappedFasta* mapped = fasta. mapped. get ())
+  {
+    readFasta (*mapped, fasta. recNum);
+    fasta. recNum++;
+  }
+  else
+#endif
+  {
+    ASSERT (fasta. in. get ());
+    readFasta (* fasta. in, reserveLen);
+  }
+  finishFasta (makeUpper);
+}
+
+
+
+#ifndef _MSC_VER
+Seq::Seq (const MappedFasta &fasta,
+          size_t recNum,
+          bool sparse_arg,
+     	    bool makeUpper)
+: sparse (sparse_arg)
+{
+  readFasta (fasta, recNum);
+  finishFasta (makeUpper);
+}
+#endif
+
+
+
+void Seq::readFasta (LineInput &fasta,
+                     size_t reserveLen)
 {
 	ASSERT (! fasta. eof);
 	ASSERT (! fasta. line. empty ());
@@ -173,14 +223,35 @@ Seq::Seq (LineInput &fasta,
          && strBlank (fasta. line)
         )
     fasta. nextLine ();
+}
 
-  if (makeUpper)
-    strUpper (seq);
-  else
-    strLower (seq);
 
-	if (! sparse)
-	  unSparse ();
+
+#ifndef _MSC_VER
+void Seq::readFasta (const MappedFasta &fasta,
+                     size_t recNum)
+{
+  ASSERT (recNum < fasta. size ());
+  name = fasta. getHeader (recNum);
+  replace (name, '\t', ' ');
+  qcName ();
+  fasta. getSeq (recNum, seq);
+}
+#endif
+
+
+
+void Seq::finishFasta (bool makeUpper)
+{
+  // Same as strUpper()/strLower() followed by unSparse() if !sparse, in one pass
+  size_t j = 0;
+  for (const char c : seq)
+  {
+    const char c1 = makeUpper ? toUpper (c) : toLower (c);
+    if (sparse || c1 != '-')
+      seq [j++] = c1;
+  }
+  seq. resize (j);
 }
 
 
@@ -474,9 +545,373 @@ byte* String2Qual (char* S,
 
 ///////////////////////////// MultiFasta /////////////////////////////////
 
+#ifndef _MSC_VER
+namespace
+{
+
+void findRecordStarts (size_t from,
+                       size_t to,
+                       Vector<size_t> &starts,
+                       string_view text)
+// Output: starts
+{
+  const char* data = text. data ();
+  size_t i = from;
+  while (i < to)
+  {
+    const char* p = static_cast<const char*> (memchr (data + i, '>', to - i));
+    if (! p)
+      break;
+    i = (size_t) (p - data);
+    if (! i || data [i - 1] == '\n')
+      starts << i;
+    i++;
+  }
+}
+
+}
+
+
+
+MappedFasta::MappedFasta (const string &fName)
+: file (fName)
+, text (file. getView ())
+{
+  if (text. empty ())
+    return;
+  if (text [0] != '>')
+    throw runtime_error ("FASTA file " + shellQuote (fName) + " does not start with '>'");
+  vector<Vector<size_t>> results;
+  arrayThreads (true, findRecordStarts, text. size (), results, text);
+  size_t n = 0;
+  for (const Vector<size_t>& res : results)
+    n += res. size ();
+  starts. reserve (n);
+  for (const Vector<size_t>& res : results)
+    starts << res;
+  ASSERT (starts. front () == 0);
+}
+
+
+
+void MappedFasta::getSeq (size_t recNum,
+                          string &seq) const
+{
+  const string_view raw (getRawSeq (recNum));
+  seq. clear ();
+  seq. reserve (raw. size ());
+  const char* data = raw. data ();
+  const char* end = data + raw. size ();
+  bool blank = false;
+  while (data < end)
+  {
+    const char* eol = static_cast<const char*> (memchr (data, '\n', (size_t) (end - data)));
+    if (! eol)
+      eol = end;
+    const char* lineEnd = eol;
+    while (lineEnd > data && isSpace (lineEnd [-1]))
+      lineEnd--;
+    if (lineEnd == data)
+      blank = true;
+    else if (blank)
+      throw runtime_error ("Non-blank line after a blank line in the FASTA record " + strQuote (string (getId (recNum))));
+    else
+      seq. append (data, (size_t) (lineEnd - data));
+    data = eol + 1;
+  }
+}
+
+
+
+
+MappedFasta::MappedFasta (const string &fName,
+                          Vector<size_t> &&starts_arg)
+: file (fName)
+, text (file. getView ())
+, starts (move (starts_arg))
+{
+  QC_IMPLY (! starts. empty (), starts. back () < text. size ());
+  if (qc_on)
+  {
+    for (const size_t start : starts)
+      QC_ASSERT (text [start] == '>');
+  }
+}
+
+
+
+
+// FastaIndex
+
+namespace
+{
+
+void indexRecords (size_t from,
+                   size_t to,
+                   string &error,
+                   const MappedFasta &fasta,
+                   Vector<FastaIndex::Record> &records)
+// Update: records[from..to)
+// Output: error: the first error, same as of MappedFasta::getSeq()
+{
+  const char* text = fasta. file. getView (). data ();
+  FOR_START (size_t, recNum, from, to)
+  {
+    FastaIndex::Record& rec = records [recNum];
+    rec. id = fasta. getId (recNum);
+    rec. offset = (size_t) (fasta. getRecord (recNum). data () - text);
+    // Cf. MappedFasta::getSeq()
+    const string_view raw (fasta. getRawSeq (recNum));
+    bool regular = raw. find ('-') == string_view::npos;
+    bool first = true;
+    bool lastLine = false;
+    bool blank = false;
+    size_t i = 0;
+    while (i < raw. size ())
+    {
+      const size_t eol = raw. find ('\n', i);
+      const size_t next = eol == string_view::npos ? raw. size () : eol + 1;
+      size_t lineEnd = eol == string_view::npos ? raw. size () : eol;
+      while (lineEnd > i && isSpace (raw [lineEnd - 1]))
+        lineEnd--;
+      const size_t bases = lineEnd - i;
+      if (! bases)
+      {
+        blank = true;
+        i = next;
+        continue;
+      }
+      if (blank)
+      {
+        error = "Non-blank line after a blank line in the FASTA record " + strQuote (rec. id);
+        return;
+      }
+      rec. len += bases;
+      if (first)
+      {
+        rec. lineBases = bases;
+        rec. lineWidth = next - i;
+        first = false;
+      }
+      else if (lastLine || bases > rec. lineBases)
+        regular = false;
+      if (   eol != string_view::npos 
+          && bases == rec. lineBases 
+          && next - i != rec. lineWidth
+         )
+        regular = false;
+      if (bases < rec. lineBases)
+        lastLine = true;
+      i = next;
+    }
+    if (! regular)
+    {
+      rec. lineBases = 0;
+      rec. lineWidth = 0;
+    }
+  }
+}
+
+string_view nextIndexField (string_view &text,
+                            char delimiter)
+// Update: text
+{
+  const size_t pos = text. find (delimiter);
+  if (pos == string_view::npos)
+    throw runtime_error ("Bad FASTA index file");
+  const string_view field (text. substr (0, pos));
+  text. remove_prefix (pos + 1);
+  return field;
+}
+
+
+
+size_t view2size (string_view s)
+{
+  if (s. empty ())
+    throw runtime_error ("Bad FASTA index file");
+  size_t n = 0;
+  for (const char c : s)
+  {
+    if (! isDigit (c))
+      throw runtime_error ("Bad FASTA index file");
+    n = n * 10 + (size_t) (c - '0');
+  }
+  return n;
+}
+
+}
+
+
+
+FastaIndex::FastaIndex (const string &fName)
+{
+  string fastaStamp;
+  {
+    struct stat st;
+    if (stat (fName. c_str (), & st))
+      throw runtime_error ("Cannot open file " + shellQuote (fName));
+    fastaStamp = to_string (st. st_size) + "\t" + to_string (st. st_mtim. tv_sec) + "." + to_string (st. st_mtim. tv_nsec);
+  }
+  const string indexFName (fName + ".fidx");
+  if (! load (fName, indexFName, fastaStamp))
+  {
+    fasta. reset (new MappedFasta (fName));
+    records. resize (fasta->size ());
+    vector<string> errors;
+    arrayThreads (true, indexRecords, records. size (), errors, cref (*fasta), ref (records));
+    for (const string& error : errors)
+      if (! error. empty ())
+        throw runtime_error (error);
+    save (indexFName, fastaStamp);
+  }
+  ASSERT (fasta. get ());
+  ASSERT (fasta->size () == records. size ());
+  
+  FFOR (size_t, recNum, records. size ())
+    id2recNums [records [recNum]. id] << recNum;
+}
+
+
+
+const FastaIndex& FastaIndex::get (const string &fName)
+{
+  static mutex mtx;
+  static map<string, unique_ptr<const FastaIndex>> cache;
+  
+  const lock_guard<mutex> lg (mtx);
+  unique_ptr<const FastaIndex>& index = cache [fName];
+  if (! index. get ())
+    index. reset (new FastaIndex (fName));
+  return *index;
+}
+
+
+
+bool FastaIndex::load (const string &fName,
+                       const string &indexFName,
+                       const string &fastaStamp)
+{
+  if (! fileExists (indexFName))
+    return false;
+    
+  {
+    const MappedFile f (indexFName);
+    string_view text (f. getView ());
+    const string header ("#fidx\t" + fastaStamp + "\n");
+    if (text. substr (0, header. size ()) != header)
+      return false;
+    text. remove_prefix (header. size ());
+    records. reserve (text. size () / 32);  // PAR
+    while (! text. empty ())
+    {
+      Record rec;
+      rec. id        = nextIndexField (text, '\t');
+      rec. len       = view2size (nextIndexField (text, '\t'));
+      rec. offset    = view2size (nextIndexField (text, '\t'));
+      rec. lineBases = view2size (nextIndexField (text, '\t'));
+      rec. lineWidth = view2size (nextIndexField (text, '\n'));
+      QC_IMPLY (! records. empty (), records. back (). offset < rec. offset);
+      records << move (rec);
+    }
+  }
+  
+  Vector<size_t> starts;  starts. reserve (records. size ());
+  for (const Record& rec : records)
+    starts << rec. offset;
+  fasta. reset (new MappedFasta (fName, move (starts)));
+  
+  return true;
+}
+
+
+
+void FastaIndex::save (const string &indexFName,
+                       const string &fastaStamp) const
+{
+  // Concurrent processes may create the same index
+  const string tmpFName (indexFName + "." + to_string (getpid ()));
+  try
+  {
+    {
+      OFStream f (tmpFName);
+      f << "#fidx\t" << fastaStamp << '\n';
+      for (const Record& rec : records)
+        f         << rec. id 
+          << '\t' << rec. len 
+          << '\t' << rec. offset 
+          << '\t' << rec. lineBases 
+          << '\t' << rec. lineWidth 
+          << '\n';
+      if (! f. good ())
+        throw runtime_error ("Cannot write " + shellQuote (tmpFName));
+    }
+    if (rename (tmpFName. c_str (), indexFName. c_str ()))
+      throw runtime_error ("Cannot rename " + shellQuote (tmpFName));
+  }
+  catch (const exception &)
+  {
+    // E.g., the directory is read-only: the index is only in memory
+    remove (tmpFName. c_str ());
+  }
+}
+
+
+
+bool FastaIndex::getSubseq (size_t recNum,
+                            size_t start,
+                            size_t stop,
+                            string &seq) const
+{
+  const Record& rec = records [recNum];
+  if (! rec. lineBases)
+    return false;
+  ASSERT (start <= stop);
+  ASSERT (stop <= rec. len);
+  
+  const char* data = fasta->getRawSeq (recNum). data ();
+  seq. clear ();
+  seq. reserve (stop - start);
+  size_t pos = start;
+  while (pos < stop)
+  {
+    const size_t col = pos % rec. lineBases;
+    const size_t n = min (rec. lineBases - col, stop - pos);
+    seq. append (data + (pos / rec. lineBases) * rec. lineWidth + col, n);
+    pos += n;
+  }
+  
+  return true;
+}
+#endif
+
+
+
+
+Multifasta::Multifasta (const string &fName,
+                        bool aa_arg,
+                        size_t displayPeriod)
+: aa (aa_arg)
+, prog (0, displayPeriod)  
+{ 
+#ifndef _MSC_VER
+  if (getFiletype (fName, true) == Filetype::file)
+    mapped. reset (new MappedFasta (fName));
+  else
+#endif
+  {
+    in. reset (new LineInput (fName));
+    in->nextLine (); 
+	  qcNewSeq ();
+	}
+}
+
+
+
 void Multifasta::qcNewSeq () const
 {
-	QC_IMPLY (! in. eof, ! in. line. empty () && in. line [0] == '>'); 
+  ASSERT (in. get ());
+	QC_IMPLY (! in->eof, ! in->line. empty () && in->line [0] == '>'); 
 }
 
 	  
@@ -1499,7 +1934,7 @@ PROBABILITY Nucleotide_MonoErrorProb2WildNucleotide (uint        ACGTBNum,
 Dna::Dna (Multifasta &fasta,
           size_t reserveLen,
           bool sparse_arg)
-: Seq (fasta. in, reserveLen, sparse_arg, false) 
+: Seq (fasta, reserveLen, sparse_arg, false) 
 { 
 	ASSERT (! fasta. aa);
 	fasta. prog (getId ());
@@ -1915,11 +2350,45 @@ void Dna::DeleteStart (size_t NewStart)
 
 
 
+namespace
+{
+  
+struct ComplementTable
+{
+  char table [256];
+    // '\0' <=> not in extDnaAlphabet
+  ComplementTable ()
+    { FOR (size_t, i, 256)
+        table [i] = '\0';
+      for (const char* s = extDnaAlphabet; *s; s++)
+        table [(uchar) *s] = complementaryNucleotide (*s);
+    }
+    
+  char operator() (char wildNucleotide) const
+    { if (const char c = table [(uchar) wildNucleotide])
+        return c;
+      return complementaryNucleotide (wildNucleotide);  // throw
+    }
+    // Same as complementaryNucleotide()
+};
+
+
+const ComplementTable& getComplementTable ()
+{
+  static const ComplementTable complementTable;
+  return complementTable;
+}
+
+}
+
+
+
 Dna* Dna::makeComplementary () const
 {
+  const ComplementTable& complement = getComplementTable ();
   Dna* dna = new Dna (getId () + ".rev", seq. size (), sparse);
   FFOR (size_t, i, seq. size ())
-    dna->seq [i] = complementaryNucleotide (seq [seq. size () - 1 - i]);
+    dna->seq [i] = complement (seq [seq. size () - 1 - i]);
 
 #if 0
   if (Qual)
@@ -1937,9 +2406,11 @@ Dna* Dna::makeComplementary () const
 
 void Dna::reverse ()
 {
-  unique_ptr<Dna> dnaRev (makeComplementary ());
-  ASSERT (seq. size () == dnaRev->seq. size ());
-  seq = dnaRev->seq;
+  // Same as seq = makeComplementary()->seq, in place
+  const ComplementTable& complement = getComplementTable ();
+  std::reverse (seq. begin (), seq. end ());
+  for (char& c : seq)
+    c = complement (c);
 
 #if 0
   if (Qual)
@@ -3173,6 +3644,712 @@ void DNA_COLLECTION::SaveQual (const char* FName,
 
 
 
+///////////////////////////// PackedDna /////////////////////////////////
+
+namespace
+{
+  
+typedef  PackedDna::Word  Word;
+
+constexpr Word lowBits = 0x5555555555555555ULL;
+  // The low bit of each nucleotide
+
+
+
+struct NucleotideCodes
+{
+  uchar codes [256];
+    // 4 <=> ambiguous
+  NucleotideCodes ()
+    { FOR (size_t, i, 256)
+        codes [i] = 4;
+      FOR (uchar, code, 4)
+      { codes [(uchar) dnaAlphabet [code]] = code;
+        codes [(uchar) toUpper (dnaAlphabet [code])] = code;
+      }
+    }
+};
+
+
+
+inline size_t popCount (Word w)
+{
+#ifdef __GNUC__
+  return (size_t) __builtin_popcountll (w);
+#else
+  w = w - ((w >> 1) & lowBits);
+  w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+  w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return (size_t) ((w * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+
+
+inline Word reverse2Bits (Word w)
+// Return: 2-bit groups of w in the reverse order
+{
+  w = ((w >>  2) & 0x3333333333333333ULL) | ((w & 0x3333333333333333ULL) <<  2);
+  w = ((w >>  4) & 0x0F0F0F0F0F0F0F0FULL) | ((w & 0x0F0F0F0F0F0F0F0FULL) <<  4);
+  w = ((w >>  8) & 0x00FF00FF00FF00FFULL) | ((w & 0x00FF00FF00FF00FFULL) <<  8);
+  w = ((w >> 16) & 0x0000FFFF0000FFFFULL) | ((w & 0x0000FFFF0000FFFFULL) << 16);
+  return (w >> 32) | (w << 32);
+}
+
+
+
+inline Word reverseBits (Word w)
+{
+  w = ((w >> 1) & lowBits) | ((w & lowBits) << 1);
+  return reverse2Bits (w);
+}
+
+
+
+inline Word spreadBits (Word w)
+// Input: w < 2^32
+// Return: bit i of w is copied to the bits 2*i, 2*i+1
+{
+  w = (w | (w << 16)) & 0x0000FFFF0000FFFFULL;
+  w = (w | (w <<  8)) & 0x00FF00FF00FF00FFULL;
+  w = (w | (w <<  4)) & 0x0F0F0F0F0F0F0F0FULL;
+  w = (w | (w <<  2)) & 0x3333333333333333ULL;
+  w = (w | (w <<  1)) & lowBits;
+  return w | (w << 1);
+}
+
+
+
+inline Word rangeMask (size_t from,
+                       size_t to)
+// Return: bits from .. to-1 are set
+// Requires: from <= to <= 64
+{
+  if (from == to)
+    return 0;
+  const Word upper = to == 64 ? ~ (Word) 0 : ((Word) 1 << to) - 1;
+  return upper & ~ (((Word) 1 << from) - 1);
+}
+
+
+
+void shiftDown (Vector<Word> &words,
+                size_t bits)
+// Bit string: bit i%64 of words[i/64]
+// Remove the first bits
+{
+  ASSERT (bits < 64);
+  if (! bits)
+    return;
+  Word* w = words. data ();
+  const size_t n = words. size ();
+  FFOR (size_t, i, n)
+  {
+    w [i] >>= bits;
+    if (i + 1 < n)
+      w [i] |= w [i + 1] << (64 - bits);
+  }
+}
+
+
+
+inline void addRun (Vector<size_t> &runs,
+                    size_t run)
+{
+  if (run && run < runs. size ())
+    runs [run] ++;
+}
+  
+}
+
+
+
+PackedDna::PackedDna (const string &seq)
+: len (seq. size ())
+, words ((len + 31) / 32, 0)
+, ambig ((len + 63) / 64, 0)
+{
+  static const NucleotideCodes nucleotideCodes;
+  
+  const char* s = seq. data ();
+  Word* w = words. data ();
+  Word* a = ambig. data ();
+  FFOR (size_t, j, words. size ())
+  {
+    const size_t start = j * 32;
+    const size_t end = min (len, start + 32);
+    Word word = 0;
+    FOR_START (size_t, i, start, end)
+    {
+      const uchar code = nucleotideCodes. codes [(uchar) s [i]];
+      if (code < 4)
+        word |= (Word) code << (2 * (i - start));
+      else
+      {
+        a [i / 64] |= (Word) 1 << (i % 64);
+        wildcards += s [i];
+      }
+    }
+    w [j] = word;
+  }
+}
+
+
+
+void PackedDna::qc () const
+{
+  if (! qc_on)
+    return;
+    
+  QC_ASSERT (words. size () == (len + 31) / 32);
+  QC_ASSERT (ambig. size () == (len + 63) / 64);
+  if (len % 32)
+  {
+    QC_ASSERT (! (words. back () >> (2 * (len % 32))));
+  }
+  if (len % 64)
+  {
+    QC_ASSERT (! (ambig. back () >> (len % 64)));
+  }
+  QC_ASSERT (countAmbiguous (0, len) == wildcards. size ());
+  FFOR (size_t, j, words. size ())
+    QC_ASSERT (! (words [j] & spreadBits ((ambig [j / 2] >> (32 * (j % 2))) & 0xFFFFFFFFULL)));
+  for (const char c : wildcards)
+    QC_ASSERT (! strchr ("acgtACGT", c));
+}
+
+
+
+string PackedDna::unpack () const
+{
+  string seq (len, ' ');
+  char* s = & seq [0];
+  const Word* w = words. data ();
+  FFOR (size_t, i, len)
+    s [i] = dnaAlphabet [(w [i / 32] >> (2 * (i % 32))) & 3];
+
+  size_t k = 0;
+  FFOR (size_t, j, ambig. size ())
+    if (const Word a = ambig [j])
+      FOR (size_t, bit, 64)
+        if ((a >> bit) & 1)
+        {
+          s [j * 64 + bit] = wildcards [k];
+          k++;
+        }
+  ASSERT (k == wildcards. size ());
+
+  return seq;
+}
+
+
+
+void PackedDna::reverse ()
+{
+  if (! len)
+    return;
+    
+  // Complement: code -> 3 - code
+  for (Word& w : words)
+    w = ~ w;
+  std::reverse (words. begin (), words. end ());
+  for (Word& w : words)
+    w = reverse2Bits (w);
+  shiftDown (words, 2 * (words. size () * 32 - len));
+  
+  std::reverse (ambig. begin (), ambig. end ());
+  for (Word& a : ambig)
+    a = reverseBits (a);
+  shiftDown (ambig, ambig. size () * 64 - len);
+  
+  // Ambiguous nucleotides have code 0
+  FFOR (size_t, j, words. size ())
+    words [j] &= ~ spreadBits ((ambig [j / 2] >> (32 * (j % 2))) & 0xFFFFFFFFULL);
+  
+  // Upper-case wildcards are complemented in upper case, a character without a complement is kept
+  const ComplementTable& complementTable = getComplementTable ();
+  std::reverse (wildcards. begin (), wildcards. end ());
+  for (char& c : wildcards)
+    if (const char c1 = complementTable. table [(uchar) c])
+      c = c1;
+}
+
+
+
+size_t PackedDna::countAmbiguous (size_t start,
+                                  size_t stop) const
+{
+  ASSERT (start <= stop);
+  ASSERT (stop <= len);
+  
+  size_t n = 0;
+  for (size_t j = start / 64; j * 64 < stop; j++)
+  {
+    const size_t offset = j * 64;
+    n += popCount (ambig [j] & rangeMask (max (start, offset) - offset, min (stop, offset + 64) - offset));
+  }
+  return n;
+}
+
+
+
+void PackedDna::countNucleotides (size_t start,
+                                  size_t stop,
+                                  array<size_t,4> &acgt) const
+{
+  ASSERT (start <= stop);
+  ASSERT (stop <= len);
+  
+  size_t c = 0;
+  size_t g = 0;
+  size_t t = 0;
+  for (size_t j = start / 32; j * 32 < stop; j++)
+  {
+    const size_t offset = j * 32;
+    const Word mask = rangeMask (2 * (max (start, offset) - offset), 2 * (min (stop, offset + 32) - offset)) & lowBits;
+    const Word w = words [j];
+    const Word lo = w & mask;
+    const Word hi = (w >> 1) & mask;
+    c += popCount (lo & ~ hi);
+    g += popCount (hi & ~ lo);
+    t += popCount (hi & lo);
+  }
+  
+  acgt [0] = stop - start - countAmbiguous (start, stop) - c - g - t;
+  acgt [1] = c;
+  acgt [2] = g;
+  acgt [3] = t;
+}
+
+
+
+size_t PackedDna::countGC (size_t start,
+                           size_t stop) const
+{
+  ASSERT (start <= stop);
+  ASSERT (stop <= len);
+
+  size_t n = 0;
+  for (size_t j = start / 32; j * 32 < stop; j++)
+  {
+    const size_t offset = j * 32;
+    const Word mask = rangeMask (2 * (max (start, offset) - offset), 2 * (min (stop, offset + 32) - offset)) & lowBits;
+    const Word w = words [j];
+    // c = 01, g = 10
+    n += popCount ((w ^ (w >> 1)) & mask);
+  }
+  return n;
+}
+
+
+
+bool PackedDna::getKmer (size_t start,
+                         size_t k,
+                         Word &kmer) const
+{
+  ASSERT (k <= 32);
+  
+  if (start + k > len)
+    return false;
+  if (countAmbiguous (start, start + k))
+    return false;
+    
+  kmer = 0;
+  if (! k)
+    return true;
+  const size_t j = start / 32;
+  const size_t shift = 2 * (start % 32);
+  kmer = words [j] >> shift;
+  if (shift && j + 1 < words. size ())
+    kmer |= words [j + 1] << (64 - shift);
+  if (k < 32)
+    kmer &= ((Word) 1 << (2 * k)) - 1;
+    
+  return true;
+}
+
+
+
+void PackedDna::addRuns (Vector<size_t> &runs) const
+{
+  const Word* w = words. data ();
+  const Word* a = ambig. data ();
+  size_t prev = 4;
+  size_t run = 0;
+  FFOR (size_t, i, len)
+    if ((a [i / 64] >> (i % 64)) & 1)
+    {
+      addRun (runs, run);
+      prev = 4;
+      run = 0;
+    }
+    else
+    {
+      const size_t code = (w [i / 32] >> (2 * (i % 32))) & 3;
+      if (code == prev)
+        run++;
+      else
+      {
+        addRun (runs, run);
+        prev = code;
+        run = 1;
+      }
+    }
+  addRun (runs, run);
+}
+
+
+
+
+///////////////////////////// SeqDedup /////////////////////////////////
+
+namespace
+{
+
+inline uint64_t rotl64 (uint64_t x,
+                        int r)
+  { return (x << r) | (x >> (64 - r)); }
+
+
+
+inline uint64_t fmix64 (uint64_t k)
+{
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+  return k;
+}
+
+
+
+#ifndef _MSC_VER
+int sameRawSeq (string_view raw1,
+                string_view raw2)
+// Return: 1 <=> MappedFasta::getRawSeq()'s produce equal sequences after makeSeq(,,,false)
+//         0 <=> different sequences
+//        -1 <=> undecided because of spaces or control characters
+{
+  if (raw1 == raw2)
+    return 1;
+  size_t i = 0;
+  size_t j = 0;
+  for (;;)
+  {
+    while (i < raw1. size () && (raw1 [i] == '\n' || raw1 [i] == '-'))
+      i++;
+    while (j < raw2. size () && (raw2 [j] == '\n' || raw2 [j] == '-'))
+      j++;
+    if (   (i < raw1. size () && (uchar) raw1 [i] <= ' ')
+        || (j < raw2. size () && (uchar) raw2 [j] <= ' ')
+       )
+      return -1;
+    if (i == raw1. size () || j == raw2. size ())
+      return i == raw1. size () && j == raw2. size ();
+    const char c1 = raw1 [i];
+    const char c2 = raw2 [j];
+    if (c1 != c2 && toLower (c1) != toLower (c2))
+      return 0;
+    i++;
+    j++;
+  }
+}
+#endif
+
+}
+
+
+
+SeqHash::SeqHash (const char* s,
+                  size_t len)
+{
+  constexpr uint64_t c1 = 0x87c37b91114253d5ULL;
+  constexpr uint64_t c2 = 0x4cf5ad432745937fULL;
+
+  const size_t blocks = len / 16;
+  FOR (size_t, i, blocks)
+  {
+    uint64_t k1;
+    uint64_t k2;
+    memcpy (& k1, s + 16 * i,     8);
+    memcpy (& k2, s + 16 * i + 8, 8);
+
+    k1 *= c1;
+    k1 = rotl64 (k1, 31);
+    k1 *= c2;
+    h1 ^= k1;
+    h1 = rotl64 (h1, 27);
+    h1 += h2;
+    h1 = h1 * 5 + 0x52dce729;
+
+    k2 *= c2;
+    k2 = rotl64 (k2, 33);
+    k2 *= c1;
+    h2 ^= k2;
+    h2 = rotl64 (h2, 31);
+    h2 += h1;
+    h2 = h2 * 5 + 0x38495ab5;
+  }
+
+  // Tail
+  const uchar* tail = reinterpret_cast<const uchar*> (s + 16 * blocks);
+  const size_t rest = len % 16;
+  if (rest > 8)
+  {
+    uint64_t k2 = 0;
+    FOR_START (size_t, i, 8, rest)
+      k2 ^= (uint64_t) tail [i] << (8 * (i - 8));
+    k2 *= c2;
+    k2 = rotl64 (k2, 33);
+    k2 *= c1;
+    h2 ^= k2;
+  }
+  if (rest)
+  {
+    uint64_t k1 = 0;
+    FOR (size_t, i, min<size_t> (rest, 8))
+      k1 ^= (uint64_t) tail [i] << (8 * i);
+    k1 *= c1;
+    k1 = rotl64 (k1, 31);
+    k1 *= c2;
+    h1 ^= k1;
+  }
+
+  h1 ^= len;
+  h2 ^= len;
+  h1 += h2;
+  h2 += h1;
+  h1 = fmix64 (h1);
+  h2 = fmix64 (h2);
+  h1 += h2;
+  h2 += h1;
+}
+
+
+
+
+#ifndef _MSC_VER
+SeqDedup::SeqDedup (const string &fName,
+                    bool aa_arg,
+                    size_t hashBits_arg)
+: aa (aa_arg)
+, hashBits (hashBits_arg)
+{
+  QC_ASSERT (hashBits <= 128);
+
+  if (getFiletype (fName, true) == Filetype::file)
+  {
+    fasta. reset (new MappedFasta (fName));
+    hashes. resize (fasta->size ());
+  }
+  else
+  {
+    Multifasta fa (fName, aa);
+    while (fa. next ())
+      seqs << makeSeq (fa, false);
+    hashes. resize (seqs. size ());
+  }
+
+  {
+    vector<string> errors;
+    arrayThreads (true, hashRecords, hashes. size (), errors, ref (*this));
+    for (const string& error : errors)
+      if (! error. empty ())
+        throw runtime_error (error);
+  }
+
+  reps. resize (hashes. size (), no_index);
+  shards. resize (max<size_t> (1, threads_max));
+  FFOR (size_t, recNum, hashes. size ())
+    shards [getShard (hashes [recNum])]. recNums << recNum;
+  {
+    vector<Notype> notypes;
+    arrayThreads (true, fillShards, shards. size (), notypes, ref (*this));
+  }
+  for (const size_t rep : reps)
+    ASSERT (rep != no_index);
+}
+
+
+
+void SeqDedup::hashRecords (size_t from,
+                            size_t to,
+                            string &error,
+                            SeqDedup &dedup)
+// Update: dedup.hashes[from..to)
+// Output: error: the first exception, a thread cannot throw
+{
+  try
+  {
+    FOR_START (size_t, recNum, from, to)
+    {
+      if (dedup. fasta. get ())
+      {
+        const unique_ptr<const Seq> seq (makeSeq (* dedup. fasta, recNum, dedup. aa, false));
+        QC_ASSERT (! seq->getId (). empty ());
+        dedup. hashes [recNum] = SeqHash (seq->seq);
+      }
+      else
+      {
+        QC_ASSERT (! dedup. seqs [recNum] -> getId (). empty ());
+        dedup. hashes [recNum] = SeqHash (dedup. seqs [recNum] -> seq);
+      }
+      dedup. hashes [recNum]. truncate (dedup. hashBits);
+    }
+  }
+  catch (const exception &e)
+  {
+    error = e. what ();
+  }
+}
+
+
+
+void SeqDedup::fillShards (size_t from,
+                           size_t to,
+                           Notype& /*res*/,
+                           SeqDedup &dedup)
+// Update: dedup.shards[from..to), dedup.reps[] of these shards
+{
+  FOR_START (size_t, shardNum, from, to)
+  {
+    Shard& shard = dedup. shards [shardNum];
+    shard. hash2recNum. rehash (shard. recNums. size ());
+    for (const size_t recNum : shard. recNums)
+    {
+      const SeqHash& h = dedup. hashes [recNum];
+      const auto res = shard. hash2recNum. insert (make_pair (h, recNum));
+      size_t& rep = dedup. reps [recNum];
+      if (res. second)
+        rep = recNum;
+      else if (dedup. same (res. first->second, dedup, recNum))
+        rep = res. first->second;
+      else
+      {
+        // Hash collision
+        for (const size_t other : shard. collisions)
+          if (   dedup. hashes [other] == h
+              && dedup. same (other, dedup, recNum)
+             )
+          {
+            rep = other;
+            break;
+          }
+        if (rep == no_index)
+        {
+          rep = recNum;
+          shard. collisions << recNum;
+        }
+      }
+    }
+    shard. recNums. wipe ();
+  }
+}
+
+
+
+void SeqDedup::findRecords (size_t from,
+                            size_t to,
+                            Notype& /*res*/,
+                            const SeqDedup &dedup,
+                            const SeqDedup &other,
+                            Vector<size_t> &matches)
+// Update: matches[from..to) for other.reps[i] == i
+{
+  FOR_START (size_t, recNum, from, to)
+    if (other. reps [recNum] == recNum)
+      matches [recNum] = dedup. find (other. hashes [recNum], other, recNum);
+}
+
+
+
+size_t SeqDedup::find (const SeqHash &h,
+                       const SeqDedup &other,
+                       size_t otherRecNum) const
+{
+  const Shard& shard = shards [getShard (h)];
+  const auto it = shard. hash2recNum. find (h);
+  if (it == shard. hash2recNum. end ())
+    return no_index;
+  if (same (it->second, other, otherRecNum))
+    return it->second;
+  for (const size_t recNum : shard. collisions)
+    if (   hashes [recNum] == h
+        && same (recNum, other, otherRecNum)
+       )
+      return recNum;
+  return no_index;
+}
+
+
+
+unique_ptr<Seq> SeqDedup::getSeq (size_t recNum) const
+{
+  if (fasta. get ())
+    return unique_ptr<Seq> (makeSeq (*fasta, recNum, aa, false));
+  return unique_ptr<Seq> (seqs [recNum] -> copy ());
+}
+
+
+
+string SeqDedup::getName (size_t recNum) const
+{
+  if (fasta. get ())
+  {
+    string name (fasta->getHeader (recNum));
+    replace (name, '\t', ' ');
+    return name;
+  }
+  return seqs [recNum] -> name;
+}
+
+
+
+string SeqDedup::getId (size_t recNum) const
+{
+  if (fasta. get ())
+    return string (fasta->getId (recNum));
+  return seqs [recNum] -> getId ();
+}
+
+
+
+bool SeqDedup::same (size_t recNum,
+                     const SeqDedup &other,
+                     size_t otherRecNum) const
+{
+  ASSERT (aa == other. aa);
+  if (fasta. get () && other. fasta. get ())
+  {
+    const int res = sameRawSeq (fasta->getRawSeq (recNum), other. fasta->getRawSeq (otherRecNum));
+    if (res != -1)
+      return res;
+  }
+  if (! fasta. get () && ! other. fasta. get ())
+    return seqs [recNum] -> seq == other. seqs [otherRecNum] -> seq;
+  return getSeq (recNum) -> seq == other. getSeq (otherRecNum) -> seq;
+}
+
+
+
+Vector<size_t> SeqDedup::find (const SeqDedup &other) const
+{
+  QC_ASSERT (hashBits == other. hashBits);
+  Vector<size_t> matches (other. size (), no_index);
+  {
+    vector<Notype> notypes;
+    arrayThreads (true, findRecords, other. size (), notypes, cref (*this), cref (other), ref (matches));
+  }
+  FFOR (size_t, recNum, other. size ())
+    matches [recNum] = matches [other. reps [recNum]];
+  return matches;
+}
+#endif
+
+
+
+
 /////////////////////////////// SubstMat ///////////////////////////////
 
 SubstMat::SubstMat (const string &fName)
@@ -3390,7 +4567,7 @@ bool moreGeneralAminoacid (char wildAminoacid1,
 Peptide::Peptide (Multifasta &fasta,
                   size_t reserveLen,
                   bool sparse_arg)
-: Seq (fasta. in, reserveLen, sparse_arg, true) 
+: Seq (fasta, reserveLen, sparse_arg, true) 
 { 
 	ASSERT (fasta. aa);
 	fasta. prog (getId ());
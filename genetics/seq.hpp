@@ -188,6 +188,10 @@ typedef char (*GetIintersectChar) (const char* CharSet);
 
 struct Dna;
 struct Peptide;
+#ifndef _MSC_VER
+  struct MappedFasta;
+#endif
+struct Multifasta;
 
 
 
@@ -232,6 +236,27 @@ protected:
     // Reads 1 sequence and skips blank lines
     // Requires: fasta.line is the first line of the sequence
     // If !makeUpper then make lowercase
+  Seq (Multifasta &fasta,
+       size_t reserveLen,
+       bool sparse_arg,
+     	 bool makeUpper);
+    // Reads the next sequence of fasta
+#ifndef _MSC_VER
+  Seq (const MappedFasta &fasta,
+       size_t recNum,
+       bool sparse_arg,
+     	 bool makeUpper);
+    // Thread-safe
+#endif
+private:
+  void readFasta (LineInput &fasta,
+                  size_t reserveLen);
+#ifndef _MSC_VER
+  void readFasta (const MappedFasta &fasta,
+                  size_t recNum);
+#endif
+  void finishFasta (bool makeUpper);
+protected:
 	void qcName () const;
 	void qcAlphabet () const;
 	  // Invokes: getSeqAlphabet()
@@ -301,34 +326,161 @@ public:
 
 
 
+#ifndef _MSC_VER
+struct MappedFasta : Nocopy
+/* Multi-FASTA file mapped into memory with the offsets of its records
+   Records are independent, so they can be processed in parallel, e.g., by arrayThreads() over 0 .. size()-1
+   A record is the header line and the following lines up to the next line starting with '>'
+*/
+{
+  const MappedFile file;
+private:
+  string_view text;
+  Vector<size_t> starts;
+    // Offsets of '>' at the line starts
+    // Ascending
+public:
+  
+  
+  explicit MappedFasta (const string &fName);
+    // Invokes: arrayThreads()
+  MappedFasta (const string &fName,
+               Vector<size_t> &&starts_arg);
+    // Input: starts_arg: offsets of the records, e.g., from FastaIndex
+    
+    
+  size_t size () const
+    { return starts. size (); }
+  string_view getRecord (size_t recNum) const
+    { const size_t start = starts [recNum];
+      return text. substr (start, (recNum + 1 == starts. size () ? text. size () : starts [recNum + 1]) - start);
+    }
+    // Return: '>' + header + sequence lines, including line ends
+  string_view getHeader (size_t recNum) const
+    { const string_view rec (getRecord (recNum));
+      const size_t eol = rec. find ('\n');
+      return rec. substr (1, eol == string_view::npos ? string_view::npos : eol - 1);
+    }
+    // Without '>' and the line end
+  string_view getId (size_t recNum) const
+    { const string_view header (getHeader (recNum));
+      return header. substr (0, header. find_first_of (" \t\r"));
+    }
+    // Same as Seq::getId(), without '\r' of a CRLF line end
+  string_view getRawSeq (size_t recNum) const
+    { const string_view rec (getRecord (recNum));
+      const size_t eol = rec. find ('\n');
+      return eol == string_view::npos ? string_view () : rec. substr (eol + 1);
+    }
+    // Sequence lines including line ends and trailing blank lines
+  void getSeq (size_t recNum,
+               string &seq) const;
+    // Output: seq: concatenation of the sequence lines with trailing spaces removed
+    // Error if a blank line is followed by a non-blank line
+};
+
+
+
+struct FastaIndex : Nocopy
+/* Persistent index of a multi-FASTA file, saved in the file <FASTA file>.fidx
+   Created on the first use, re-created if the FASTA file has changed
+   If the index file cannot be saved then the index is only in memory
+   File format:
+     #fidx <FASTA file size> <FASTA file modification time>
+     <id> <sequence length> <record offset> <line bases> <line width>
+     ...
+   Tab-delimited
+   Extraction of a record reads only its bytes
+*/
+{
+  struct Record
+  {
+    string id;
+      // Seq::getId()
+    size_t len {0};
+      // MappedFasta::getSeq().size()
+    size_t offset {0};
+      // Of '>'
+    size_t lineBases {0};
+    size_t lineWidth {0};
+      // Including the line end
+      // 0 <=> lines of different lengths or '-' in the sequence
+  };
+  Vector<Record> records;
+    // Ordered by offset
+  unique_ptr<const MappedFasta> fasta;
+private:
+  unordered_map<string, Vector<size_t>> id2recNums;
+public:
+  
+  
+  explicit FastaIndex (const string &fName);
+    // Invokes: arrayThreads()
+    // Error if a blank line is followed by a non-blank line in a record, as in MappedFasta::getSeq()
+  static const FastaIndex& get (const string &fName);
+    // Return: cached in the process
+    // Thread-safe
+private:
+  bool load (const string &fName,
+             const string &indexFName,
+             const string &fastaStamp);
+    // Return: false <=> no index file or it is obsolete
+  void save (const string &indexFName,
+             const string &fastaStamp) const;
+public:
+    
+    
+  const Vector<size_t>* find (const string &id) const
+    { const auto it = id2recNums. find (id);
+      return it == id2recNums. end () ? nullptr : & it->second;
+    }
+    // Return: record numbers in fasta, ascending
+  bool getSubseq (size_t recNum,
+                  size_t start,
+                  size_t stop,
+                  string &seq) const;
+    // Output: seq = MappedFasta::getSeq().substr(start,stop-start), if Return
+    // Return: false <=> !records[recNum].lineBases
+    // Requires: stop <= records[recNum].len
+};
+#endif
+
+
+
 struct Multifasta : Root
 /* Usage:
      { Multifasta fa (...);
        while (fa. next ())
          {Peptide|Dna} ... (fa); 
      }  // To close LineInput and Progress
+   A regular file is memory-mapped, other files are read line by line
 */
 {
-  LineInput in;
+  unique_ptr<LineInput> in;
+#ifndef _MSC_VER
+  unique_ptr<const MappedFasta> mapped;
+    // One of in, mapped is nullptr
+  size_t recNum {0};
+    // Next record of mapped
+#endif
   const bool aa;
   Progress prog;
 
 	Multifasta (const string &fName,
 	            bool aa_arg,
-	            size_t displayPeriod = 1000)  
-		: in (fName) 
-		, aa (aa_arg)
-		, prog (0, displayPeriod)  
-		{ in. nextLine (); 
-			qcNewSeq ();
-		}
+	            size_t displayPeriod = 1000);
 private:
 	void qcNewSeq () const;
 public:
 	  
 	bool next () const
-		{ qcNewSeq ();
-			return ! in. eof;
+		{
+		#ifndef _MSC_VER
+		  if (mapped. get ())
+		    return recNum < mapped->size ();
+		#endif
+		  qcNewSeq ();
+			return ! in->eof;
 		}
 };
 
@@ -489,6 +641,13 @@ struct Dna : Seq
   Dna (Multifasta &fasta,
        size_t reserveLen,
        bool sparse_arg);
+#ifndef _MSC_VER
+  Dna (const MappedFasta &fasta,
+       size_t recNum,
+       bool sparse_arg)
+    : Seq (fasta, recNum, sparse_arg, false)  
+    {}
+#endif
   Dna* copy () const final
     { return new Dna (*this); }
 	void saveText (ostream& os) const override
@@ -550,7 +709,6 @@ struct Dna : Seq
   Dna* makeComplementary () const;
     // Return: Reverse and complementary Dna; !nullptr
   void reverse ();
-    // Invokes: makeComplementary ()
 
   Peptide makePeptide (Frame frame,
                        Gencode gencode,
@@ -752,6 +910,70 @@ struct FastaDna : Dna
 
 
 
+
+struct PackedDna : Root
+/* DNA sequence with 2 bits per nucleotide: a = 0, c = 1, g = 2, t = 3, so complement = 3 - code
+   Nucleotide i is in the bits 2*(i%32), 2*(i%32)+1 of words[i/32]
+   An ambiguous character has code 0, its position is marked in ambig[] and the character is saved in wildcards
+   4 times less memory than Dna::seq for unambiguous sequences
+   Operations process 32 nucleotides at a time
+*/
+{
+  typedef  uint64_t  Word;
+private:
+  size_t len {0};
+  Vector<Word> words;
+  Vector<Word> ambig;
+    // Bit i%64 of ambig[i/64] <=> nucleotide i is ambiguous
+  string wildcards;
+    // Ambiguous characters in the order of their positions
+public:
+
+
+  PackedDna () = default;
+  explicit PackedDna (const string &seq);
+    // Input: seq: case-insensitive
+  explicit PackedDna (const Dna &dna)
+    : PackedDna (dna. seq)
+    {}
+  void qc () const override;
+  void saveText (ostream &os) const override
+    { os << unpack (); }
+
+
+  size_t size () const
+    { return len; }
+  bool empty () const override
+    { return ! len; }
+  size_t getAmbiguities () const
+    { return wildcards. size (); }
+  string unpack () const;
+    // Return: lower-case, ambiguous characters are preserved
+  void reverse ();
+    // Reverse complement
+    // Same as reverseDna(), but a character not in extDnaAlphabet is kept and does not throw
+  size_t countAmbiguous (size_t start,
+                         size_t stop) const;
+    // Return: number of ambiguous nucleotides in start .. stop-1
+  void countNucleotides (size_t start,
+                         size_t stop,
+                         array<size_t,4> &acgt) const;
+    // Output: acgt: numbers of unambiguous nucleotides in start .. stop-1
+  size_t countGC (size_t start,
+                  size_t stop) const;
+    // Return: number of 'c' and 'g' in start .. stop-1
+  bool getKmer (size_t start,
+                size_t k,
+                Word &kmer) const;
+    // Output: kmer: nucleotide start+i is in the bits 2*i, 2*i+1, if Return
+    // Return: false <=> start + k > size() or countAmbiguous(start,start+k)
+    // Requires: k <= 32
+  void addRuns (Vector<size_t> &runs) const;
+    // Update: runs[n]: number of maximal runs of n identical unambiguous nucleotides, n < runs.size()
+};
+
+
+
 #if 0
 class DNA_COLLECTION: public _SEQ_COLLECTION
 // of Dna*
@@ -948,6 +1170,13 @@ struct Peptide : Seq
   Peptide (Multifasta &fasta,
            size_t reserveLen,
            bool sparse_arg);
+#ifndef _MSC_VER
+  Peptide (const MappedFasta &fasta,
+           size_t recNum,
+           bool sparse_arg)
+    : Seq (fasta, recNum, sparse_arg, true) 
+    {}
+#endif
   Peptide* copy () const final
     { return new Peptide (*this); }
   void qc () const override;
@@ -1038,6 +1267,144 @@ inline Seq* makeSeq (Multifasta &fa,
   	return s;
   }
 
+#ifndef _MSC_VER
+inline Seq* makeSeq (const MappedFasta &fasta,
+                     size_t recNum,
+                     bool aa,
+                     bool sparse)
+  { Seq* s = nullptr;
+  	if (aa)
+  		s = new Peptide (fasta, recNum, sparse);
+  	else
+  		s = new Dna (fasta, recNum, sparse);
+  	s->qc ();
+  	return s;
+  }
+#endif
+
+
+
+struct SeqHash
+// 128-bit MurmurHash3 (x64) of Seq::seq
+// Depends on the byte order
+{
+  uint64_t h1 {0};
+  uint64_t h2 {0};
+
+
+  SeqHash () = default;
+  SeqHash (const char* s,
+           size_t len);
+  explicit SeqHash (const string &s)
+    : SeqHash (s. data (), s. size ())
+    {}
+
+
+  bool operator== (const SeqHash &other) const
+    { return    h1 == other. h1
+             && h2 == other. h2;
+    }
+  void truncate (size_t bits)
+    // To test hash collisions
+    { if (bits >= 128)
+        return;
+      if (bits >= 64)
+        h2 &= (uint64_t (1) << (bits - 64)) - 1;
+      else
+      { h1 &= (uint64_t (1) << bits) - 1;
+        h2 = 0;
+      }
+    }
+
+  struct Hasher
+  {
+    size_t operator() (const SeqHash &h) const
+      { return (size_t) h. h1; }
+  };
+};
+
+
+
+#ifndef _MSC_VER
+struct SeqDedup : Nocopy
+/* Identical sequences of a multi-FASTA file
+   Sequences are compared after makeSeq(,,,false), i.e., case-insensitive and ignoring '-'
+   Equal SeqHash'es are verified by comparing the sequences
+   A regular file is memory-mapped and the sequences are re-read from it, otherwise the sequences are stored
+   The hash table is split into shards, each shard is filled by one thread
+*/
+{
+  const bool aa;
+  const size_t hashBits;
+    // <= 128
+private:
+  unique_ptr<const MappedFasta> fasta;
+  VectorOwn<Seq> seqs;
+    // !fasta <=> the input file is not regular
+  struct Shard
+  {
+    Vector<size_t> recNums;
+      // Increasing
+      // Cleared after filling hash2recNum
+    unordered_map<SeqHash,size_t/*recNum*/,SeqHash::Hasher> hash2recNum;
+    Vector<size_t> collisions;
+      // Record numbers of the sequences whose SeqHash is in hash2recNum with a different sequence
+  };
+  Vector<Shard> shards;
+public:
+  Vector<SeqHash> hashes;
+    // Index: record number
+  Vector<size_t> reps;
+    // Index: record number
+    // Value: the first record number with the same sequence, <= index
+
+
+  SeqDedup (const string &fName,
+            bool aa_arg,
+            size_t hashBits_arg = 128);
+    // Input: hashBits_arg: < 128 to test hash collisions
+    // Invokes: arrayThreads()
+private:
+  static void hashRecords (size_t from,
+                           size_t to,
+                           string &error,
+                           SeqDedup &dedup);
+  static void fillShards (size_t from,
+                          size_t to,
+                          Notype &res,
+                          SeqDedup &dedup);
+  static void findRecords (size_t from,
+                           size_t to,
+                           Notype &res,
+                           const SeqDedup &dedup,
+                           const SeqDedup &other,
+                           Vector<size_t> &matches);
+  size_t getShard (const SeqHash &h) const
+    { return h. h2 % shards. size (); }
+  size_t find (const SeqHash &h,
+               const SeqDedup &other,
+               size_t otherRecNum) const;
+    // Return: record number of the first sequence equal to other's sequence otherRecNum, or no_index
+public:
+
+
+  size_t size () const
+    { return reps. size (); }
+  unique_ptr<Seq> getSeq (size_t recNum) const;
+  string getName (size_t recNum) const;
+    // = getSeq(recNum)->name
+  string getId (size_t recNum) const;
+    // = getSeq(recNum)->getId()
+  bool same (size_t recNum,
+             const SeqDedup &other,
+             size_t otherRecNum) const;
+    // Return: the sequences are equal
+  Vector<size_t> find (const SeqDedup &other) const;
+    // Return: index: record number of other; value: reps[] of the equal sequence or no_index
+    // Invokes: arrayThreads()
+};
+#endif
+
 
 
 
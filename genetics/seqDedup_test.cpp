@@ -0,0 +1,116 @@
+// seqDedup_test.cpp
+
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE                          
+*               National Center for Biotechnology Information
+*                                                                          
+*  This software/database is a "United States Government Work" under the   
+*  terms of the United States Copyright Act.  It was written as part of    
+*  the author's official duties as a United States Government employee and 
+*  thus cannot be copyrighted.  This software/database is freely available 
+*  to the public for use. The National Library of Medicine and the U.S.    
+*  Government have not placed any restriction on its use or reproduction.  
+*                                                                          
+*  Although all reasonable efforts have been taken to ensure the accuracy  
+*  and reliability of the software and data, the NLM and the U.S.          
+*  Government do not and cannot warrant the performance or results that    
+*  may be obtained by using this software or data. The NLM and the U.S.    
+*  Government disclaim all warranties, express or implied, including       
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.                                                                
+*                                                                          
+*  Please cite the author in any work or product based on this material.   
+*
+* ===========================================================================
+*
+* Author: Vyacheslav Brover
+*
+* File Description:
+*   Test of SeqDedup in seq.{hpp,cpp}
+*
+*/
+
+
+#undef NDEBUG
+#include "../common.inc"
+
+#include "../common.hpp"
+using namespace Common_sp;
+#include "seq.hpp"
+using namespace Seq_sp;
+#include "../version.inc"
+
+
+
+namespace
+{
+  
+  
+size_t firstEqual (const SeqDedup &dedup,
+                   const string &seq)
+// Return: the first record number of dedup with seq, or no_index
+{
+  FFOR (size_t, recNum, dedup. size ())
+    if (dedup. getSeq (recNum) -> seq == seq)
+      return recNum;
+  return no_index;
+}
+
+
+
+struct ThisApplication : Application
+{
+  ThisApplication ()
+    : Application ("Test SeqDedup: compare with the pairwise comparison of the sequences for truncated hashes causing collisions")
+  	{
+  	  version = VERSION;
+  	  addPositional ("in1", "Input DNA FASTA file 1");
+  	  addPositional ("in2", "Input DNA FASTA file 2");
+  	}
+
+
+
+	void body () const final
+	{  
+	  const string inFName1 = getArg ("in1");
+	  const string inFName2 = getArg ("in2");
+	  
+	  for (const size_t hashBits : Vector<size_t> {128, 65, 64, 8, 1, 0})
+	  {
+	    const SeqDedup dedup1 (inFName1, false, hashBits);
+	    const SeqDedup dedup2 (inFName2, false, hashBits);
+	    
+	    // reps
+	    for (const SeqDedup* dedup : {& dedup1, & dedup2})
+  	    FFOR (size_t, recNum, dedup->size ())
+  	    {
+  	      const size_t rep = firstEqual (*dedup, dedup->getSeq (recNum) -> seq);
+  	      QC_ASSERT (rep <= recNum);
+  	      QC_ASSERT (dedup->reps [recNum] == rep);
+  	    }
+	    
+	    // find()
+	    const Vector<size_t> matches (dedup1. find (dedup2));
+	    QC_ASSERT (matches. size () == dedup2. size ());
+	    FFOR (size_t, recNum, dedup2. size ())
+	      QC_ASSERT (matches [recNum] == firstEqual (dedup1, dedup2. getSeq (recNum) -> seq));
+	  }
+	}
+};
+
+
+
+}  // namespace
+
+
+
+int main (int argc, 
+          const char* argv[])
+{
+  ThisApplication app;
+  return app. run (argc, argv);
+}
+
+
+
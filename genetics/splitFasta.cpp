@@ -88,6 +88,40 @@ struct Group
   
   
   
+void saveSeq (unique_ptr<const Seq> &seq,
+              size_t len_min,
+              bool whole,
+              bool large,
+              size_t group_size,
+              const string &ext,
+              const string &out_dir,
+              Group &group)
+{
+  ASSERT (seq. get ());
+  seq->qc ();
+  ASSERT (! seq->name. empty ());
+  if (seq->seq. size () < len_min)
+  	return;
+  string s (seq->name);
+  s = findSplit (s);
+  if (! whole)
+    s = findSplit (s, '|');
+  string dir (out_dir);
+#ifndef _MSC_VER
+  if (large)
+  {
+    dir += "/" + to_string (str2hash_class (s));
+    Dir (dir). create ();
+  }
+#endif
+  if (group_size == 1)
+    seq->saveFile (dir + "/" + s + (ext. empty () ? "" : ("." + ext)));
+  else
+    group. add (seq. release ());
+}
+  
+  
+  
 struct ThisApplication : Application
 {
   ThisApplication ()
@@ -105,6 +139,7 @@ struct ThisApplication : Application
   	#endif
   	  addKey ("group", "Group by <group> number of sequences. Group names are sequential numbers. 1 - no grouping.", "1");
   	  addKey ("extension", "Add file extension (not compatible with -group)", "");
+  	  addKey ("target", "File with the identifiers of the sequences to split out. The index file <in>.fidx is used, which is created if needed");
   	}
 
 
@@ -119,9 +154,12 @@ struct ThisApplication : Application
 	  const bool   whole       = getFlag ("whole");
   #ifndef _MSC_VER
 		const bool   large       = getFlag ("large");
+  #else
+		const bool   large       = false;
   #endif
     const size_t group_size = (size_t) arg2uint ("group");
     const string ext        = getArg ("extension");
+    const string targetFName = getArg ("target");
 
     QC_ASSERT (! out_dir. empty ());    
     QC_ASSERT (group_size >= 1);
@@ -131,6 +169,36 @@ struct ThisApplication : Application
     QC_IMPLY (group_size > 1, ext. empty ());
 
 
+    if (! targetFName. empty ())
+    {
+      const FastaIndex& index = FastaIndex::get (in);
+      Vector<size_t> recNums;
+      {
+        LineInput f (targetFName);
+        while (f. nextLine ())
+        {
+          trim (f. line);
+          if (f. line. empty ())
+            continue;
+          if (const Vector<size_t>* idRecNums = index. find (f. line))
+            recNums << *idRecNums;
+        }
+      }
+      recNums. sort ();
+      recNums. uniq ();
+      Group group (group_size, out_dir);
+      for (const size_t recNum : recNums)
+      {
+  	    unique_ptr<const Seq> seq;
+  	    if (aa)
+  	      seq. reset (new Peptide (* index. fasta, recNum, sparse));  
+  	    else
+  	      seq. reset (new Dna (* index. fasta, recNum, sparse));  
+  	    saveSeq (seq, len_min, whole, large, group_size, ext, out_dir, group);
+      }
+      return;
+    }
+
     { // For ~Progress()      
   	  Multifasta fa (in, aa); 
       Group group (group_size, out_dir);
@@ -141,26 +209,7 @@ struct ThisApplication : Application
   	      seq. reset (new Peptide (fa, Peptide::stdAveLen, sparse));  
   	    else
   	      seq. reset (new Dna (fa, 128 * 1024, sparse));  
-  	    seq->qc ();
-  	    ASSERT (! seq->name. empty ());
-		    if (seq->seq. size () < len_min)
-		    	continue;
-        string s (seq->name);
-        s = findSplit (s);
-        if (! whole)
-          s = findSplit (s, '|');
-        string dir (out_dir);
-      #ifndef _MSC_VER
-        if (large)
-        {
-          dir += "/" + to_string (str2hash_class (s));
-          Dir (dir). create ();
-        }
-      #endif
-        if (group_size == 1)
-          seq->saveFile (dir + "/" + s + (ext. empty () ? "" : ("." + ext)));
-        else
-          group. add (seq. release ());
+  	    saveSeq (seq, len_min, whole, large, group_size, ext, out_dir, group);
   	  }
   	}
 	}
@@ -48,16 +48,6 @@ namespace
 	
 	
 	
-struct UniqSeq
-{
-  const Seq* seq {nullptr};
-    // !nullptr
-    // Not delete'd
-  StringVector ids;
-};
-	
-	
-
 struct ThisApplication : Application
 {
   ThisApplication ()
@@ -78,55 +68,46 @@ struct ThisApplication : Application
 	  const string pairFName = getArg ("pair");
 
 
-    OFStream* pairF = nullptr;
+    unique_ptr<OFStream> pairF;
     if (! pairFName. empty ())  
-      pairF = new OFStream (pairFName);
-    unordered_map<size_t/*hash*/,UniqSeq> hash2useq;  hash2useq. rehash (1000000);  // PAR
-		{
-		  Multifasta fa (inFName, aa);
-		  while (fa. next ())
-		  {
-		    unique_ptr<Seq> seq;
-		    if (aa)
-		      seq. reset (new Peptide (fa, 1000/*PAR*/, false));
-		    else
-		      seq. reset (new Dna (fa, 1000/*PAR*/, false));  
-		    ASSERT (seq. get ());
-		    seq->qc ();
-		    QC_ASSERT (! seq->getId (). empty ());
-		    
-		    const size_t h = str_hash (seq->seq);
-		    if (const UniqSeq* useq = findPtr (hash2useq, h))
-		      var_cast (useq) -> ids << seq->getId ();
-		    else
-		    {
-		      hash2useq [h] = move (UniqSeq {seq. get (), StringVector {seq->getId ()}});
-		      seq. release ();
-		    }
-		  }
-		}
-
-
-    for (auto& it : hash2useq)
+      pairF. reset (new OFStream (pairFName));
+
+    const SeqDedup dedup (inFName, aa);
+    const size_t n = dedup. size ();
+
+    // Records grouped by dedup.reps[]
+    // Group of record i: members[groupStarts[i] .. groupStarts[i+1])
+    Vector<size_t> groupStarts (n + 1, 0);
+    for (const size_t rep : dedup. reps)
+      groupStarts [rep + 1] ++;
+    FFOR (size_t, i, n)
+      groupStarts [i + 1] += groupStarts [i];
+    Vector<size_t> members (n, no_index);
+    FFOR (size_t, recNum, n)
+      members [groupStarts [dedup. reps [recNum]] ++] = recNum;
+    FOR_REV (size_t, i, n)
+      groupStarts [i + 1] = groupStarts [i];
+    groupStarts [0] = 0;
+
+    FFOR (size_t, recNum, n)
     {
-      UniqSeq& useq = it. second;
-      ASSERT (useq. seq);
-      useq. ids. sort ();
-      useq. ids. uniq ();
-		  ASSERT (! useq. ids. empty ());
-		  var_cast (useq. seq) -> name = useq. ids. front ();
-		  useq. seq->saveText (cout);
-      if (pairF)
-      {
-        string first;
-        for (const string& s : useq. ids)
+      if (dedup. reps [recNum] != recNum)
+        continue;
+      StringVector ids;
+      FOR_START (size_t, i, groupStarts [recNum], groupStarts [recNum + 1])
+        ids << dedup. getId (members [i]);
+      ids. sort ();
+      ids. uniq ();
+		  ASSERT (! ids. empty ());
+		  const unique_ptr<Seq> seq (dedup. getSeq (recNum));
+		  seq->name = ids. front ();
+		  seq->saveText (cout);
+      if (pairF. get ())
+        for (const string& s : ids)
         {
           ASSERT (! s. empty ());
-          if (first. empty ())
-            first = s;
-          *pairF << s << '\t' << first << endl;
+          *pairF << s << '\t' << ids. front () << endl;
         }
-      }
 		}
   }
 };
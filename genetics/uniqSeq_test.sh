@@ -0,0 +1,52 @@
+#!/bin/bash --noprofile
+THIS=`dirname $0`
+source $THIS/../bash_common.sh
+if [ $# -ne 1 ]; then
+  echo "Test uniqSeq, interSeq and SeqDedup"
+  echo "Expected output: data/dedup*, made by the versions of uniqSeq and interSeq before SeqDedup"
+  echo "#1: go"
+  exit 1
+fi
+
+
+TMP=`mktemp`
+comment $TMP
+
+
+function fa2tsv
+# Output: <name> <tab> <sequence>, sorted
+{
+  awk '/^>/{if (name) print name "\t" seq; name = substr ($0, 2); seq = ""; next} {seq = seq $0} END{if (name) print name "\t" seq}' $1 | sort
+}
+
+
+section "SeqDedup with hash collisions"
+$THIS/seqDedup_test $THIS/data/dedup1.fa $THIS/data/dedup2.fa -qc
+$THIS/seqDedup_test $THIS/data/dedup1.fa $THIS/data/dedup2.fa -qc -threads 4
+
+for THREADS in 1 4; do
+  section "uniqSeq -threads $THREADS"
+  # The order of sequences was the hash table order
+  fa2tsv $THIS/data/dedup1.uniqSeq > $TMP.expected
+  $THIS/uniqSeq $THIS/data/dedup1.fa -pair $TMP.pair -threads $THREADS -qc -noprogress > $TMP.uniq
+  fa2tsv $TMP.uniq > $TMP.out
+  diff $TMP.expected $TMP.out
+  sort $THIS/data/dedup1.uniqSeq.pair > $TMP.expected
+  sort $TMP.pair > $TMP.out
+  diff $TMP.expected $TMP.out
+  # Not a regular file
+  $THIS/uniqSeq <(cat $THIS/data/dedup1.fa) -threads $THREADS -qc -noprogress > $TMP.pipe
+  diff $TMP.uniq $TMP.pipe
+
+  section "interSeq -threads $THREADS"
+  # The reported sequence of <in1> was the last equal one
+  cut -f 2 $THIS/data/dedup.interSeq > $TMP.expected
+  $THIS/interSeq $THIS/data/dedup1.fa $THIS/data/dedup2.fa -threads $THREADS -qc -noprogress > $TMP.inter
+  cut -f 2 $TMP.inter > $TMP.out
+  diff $TMP.expected $TMP.out
+  $THIS/interSeq <(cat $THIS/data/dedup1.fa) $THIS/data/dedup2.fa -threads $THREADS -qc -noprogress > $TMP.pipe
+  diff $TMP.inter $TMP.pipe
+done
+
+
+rm -r $TMP*
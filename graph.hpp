@@ -213,6 +213,10 @@ struct DiGraph : Root
    ~Arc ();
       // Remove this from node->graph
       // Time: O(1)
+    static void* operator new (size_t size)
+      { return Arena::newObject (size); }
+    static void operator delete (void* p)
+      { Arena::deleteObject (p); }
 
     virtual void saveContent (ostream &/*os*/) const 
       {}
@@ -0,0 +1,92 @@
+// index_dir2bin.cpp
+
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE                          
+*               National Center for Biotechnology Information
+*                                                                          
+*  This software/database is a "United States Government Work" under the   
+*  terms of the United States Copyright Act.  It was written as part of    
+*  the author's official duties as a United States Government employee and 
+*  thus cannot be copyrighted.  This software/database is freely available 
+*  to the public for use. The National Library of Medicine and the U.S.    
+*  Government have not placed any restriction on its use or reproduction.  
+*                                                                          
+*  Although all reasonable efforts have been taken to ensure the accuracy  
+*  and reliability of the software and data, the NLM and the U.S.          
+*  Government do not and cannot warrant the performance or results that    
+*  may be obtained by using this software or data. The NLM and the U.S.    
+*  Government disclaim all warranties, express or implied, including       
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.                                                                
+*                                                                          
+*  Please cite the author in any work or product based on this material.   
+*
+* ===========================================================================
+*
+* Author: Vyacheslav Brover
+*
+* File Description:
+*   Convert an attribute index directory into an index file
+*
+*/
+
+#undef NDEBUG
+#include "common.inc"
+
+#include "common.hpp"
+using namespace Common_sp;
+#include "attr_index.hpp"
+#include "version.inc"
+
+
+
+namespace
+{
+  
+  
+struct ThisApplication : Application
+{
+  ThisApplication ()
+    : Application ("Convert an attribute index directory into a single index file for index_find")
+  	{
+      version = VERSION;
+      addPositional ("index", "Directory with an attribute index: an attribute is a file with a list of objects");
+      addPositional ("out", "Output index file");
+  	}
+  	
+  	
+ 
+	void body () const final
+	{
+		const string index = getArg ("index");
+		const string out   = getArg ("out");
+		
+		
+		AttrIndex::dir2file (index, out);
+		
+		if (verbose ())
+		{
+		  const AttrIndex ai (out);
+		  ai. qc ();
+		  PRINT (ai. objsSize ());
+		  PRINT (ai. attrsSize ());
+		}
+	}
+};
+
+
+
+}  // namespace
+
+
+
+int main (int argc, 
+          const char* argv[])
+{
+  ThisApplication app;
+  return app. run (argc, argv);
+}
+
+
+
@@ -36,6 +36,7 @@
 
 #include "common.hpp"
 using namespace Common_sp;
+#include "attr_index.hpp"
 #include "version.inc"
 
 
@@ -67,8 +68,8 @@ Average time: O(A S (A (log A + log S) + log N)), where N is the number of objec
 ")
   	{
       version = VERSION;
-      addPositional ("dir", "Directory with objects");
-      addPositional ("index", "Directory with an attribute index for <dir>");
+      addPositional ("dir", "Directory with objects. Not used if <index> is a file");
+      addPositional ("index", "Directory with an attribute index for <dir>, or the index file created by index_dir2bin");
       addPositional ("attr_size_max", "Attribute file size limit; objects having only attrbutes whose index files exceed <attr_size_max> are indiscernible");
       addPositional ("target", "Target object");
       addFlag ("large", "Directory <dir> is large: it is subdivided into subdirectories \"0\" .. \"" + to_string (hash_class_max - 1) + "\" which are the hashes of file names");
@@ -85,6 +86,13 @@ Average time: O(A S (A (log A + log S) + log N)), where N is the number of objec
 		const bool   large             = getFlag ("large");
 
 
+    if (! directoryExists (index))
+    {
+      findInFile (index, attr_size_max, target);
+      return;
+    }
+
+
     // size(index) = O(N A)
 
     StringVector attrObjs;  // Repeated objects
@@ -160,6 +168,82 @@ Average time: O(A S (A (log A + log S) + log N)), where N is the number of objec
     for (const ObjNum& objNum : objNums)
       cout << objNum. obj << endl;
 	}
+	
+	
+	
+	void findInFile (const string &index,
+	                 streamsize attr_size_max,
+	                 const string &target) const
+	// The same result as for the directory index, but big attributes are intersected with the index instead of object files
+	// Time: O(A (log N + S) + Σ|posting(big)| + N + N_A log N_A), where Σ|posting(big)| is the total posting size of the big attributes of the target, N_A is the number of found objects
+	{
+	  const AttrIndex ai (index);
+	  ai. qc ();
+
+	  vector<size_t> objNum2count (ai. objsSize (), 0);
+	  Vector<AttrIndex::ObjNum> objNums;
+	    // objNum2count[] > 0
+	  vector<AttrIndex::ObjNum> posting;
+	  {
+      Vector<size_t> bigAttrs;
+      {
+        LineInput f (target);
+        while (f. nextLine ())
+        {
+          string& attr = f. line;
+          trim (attr);
+          const size_t attrNum = ai. findAttr (attr);
+          if (attrNum == no_index)
+            continue;
+          if ((streamsize) ai. getTextSize (attrNum) >= attr_size_max)
+            bigAttrs << attrNum;
+          else
+          {
+            ai. getPosting (attrNum, posting);
+            for (const AttrIndex::ObjNum objNum : posting)
+            {
+              if (! objNum2count [objNum])
+                objNums << objNum;
+              objNum2count [objNum] ++;
+            }
+          }
+        }
+      }
+      if (verbose ())
+      {
+        PRINT (objNums. size ());
+        PRINT (bigAttrs. size ());
+      }
+      
+      bigAttrs. sort ();
+      QC_ASSERT (bigAttrs. isUniq ());
+      
+      // An object found by small attributes gets 1 for each big attribute
+      for (const size_t attrNum : bigAttrs)
+      {
+        ai. getPosting (attrNum, posting);
+        FFOR (size_t, i, posting. size ())
+        {
+          const AttrIndex::ObjNum objNum = posting [i];
+          if (i && posting [i - 1] == objNum)
+            continue;
+          if (objNum2count [objNum])
+            objNum2count [objNum] ++;
+        }
+      }
+    }
+    
+    // AttrIndex::ObjNum's are in the order of object names
+    Common_sp::sort (objNums, [&objNum2count] (AttrIndex::ObjNum a, AttrIndex::ObjNum b) 
+                                { if (objNum2count [a] != objNum2count [b])
+                                    return objNum2count [a] > objNum2count [b];
+                                  return a < b;
+                                }
+                    );
+    
+    for (const AttrIndex::ObjNum objNum : objNums)
+      cout << ai. getObj (objNum) << endl;
+	}
 };
 
 
@@ -0,0 +1,48 @@
+#!/bin/bash --noprofile
+THIS=`dirname $0`
+source $THIS/bash_common.sh
+if [ $# -ne 1 ]; then
+  echo "Test index_find: directory index vs. index file created by index_dir2bin"
+  echo "#1: go"
+  exit 1
+fi
+
+
+TMP=`mktemp`
+comment $TMP
+
+
+section "Objects"
+mkdir $TMP.obj
+RANDOM=1
+for OBJ in `seq 1 200`; do
+  for ATTR in `seq 1 20`; do
+    echo "a$(( RANDOM % 100 ))$(( RANDOM % 3 ))"
+  done | sort -u > $TMP.obj/o$OBJ
+done
+
+section "Directory index"
+mkdir $TMP.index
+for OBJ in `ls $TMP.obj`; do
+  for ATTR in `cat $TMP.obj/$OBJ`; do
+    echo $OBJ >> $TMP.index/$ATTR
+  done
+done
+
+section "File index"
+$THIS/index_dir2bin $TMP.index $TMP.bin -qc -verbose 1
+
+section "index_find"
+for SIZE in 40 60 100000; do
+  for OBJ in o1 o7 o50 o200; do
+    $THIS/index_find $TMP.obj $TMP.index $SIZE $TMP.obj/$OBJ -qc > $TMP.dir
+    $THIS/index_find $TMP.obj $TMP.bin   $SIZE $TMP.obj/$OBJ -qc > $TMP.file
+    diff $TMP.dir $TMP.file
+    if [ $SIZE == 100000 ]; then
+      grep -qx $OBJ $TMP.file
+    fi
+  done
+done
+
+
+rm -r $TMP*
@@ -98,112 +98,190 @@ Leaves tree2leaves (const Tree &tree)
 
   
   
-map <const Tree::TreeNode*, Leaves> node2leaves;
-  // For all Tree's
+typedef  unordered_map<string, size_t/*index in Leaves*/>  Leaf2num;
 
 
 
-void setNode2leaves (const Tree::TreeNode* node)
-// Output: node2leaves
+Leaf2num leaves2nums (const Leaves &leaves)
 {
-  ASSERT (node);
-  ASSERT (node2leaves [node]. empty ());
-  if (node->isLeafType ())
-    node2leaves [node] << node->getName ();
-  else 
-  	for (const DiGraph::Arc* arc : node->arcs [false])
-  	{
-  	  const Tree::TreeNode* child = static_cast <const Tree::TreeNode*> (arc->node [false]);
-  	  setNode2leaves (child);
-  	  node2leaves [node] << node2leaves [child];
-  	}
-  node2leaves [node]. sort ();
-  ASSERT (node2leaves [node]. isUniq ());
+  Leaf2num leaf2num;  leaf2num. rehash (leaves. size ());
+  FFOR (size_t, i, leaves. size ())
+    leaf2num [leaves [i]] = i;
+  return leaf2num;
 }
 
 
 
-#if 0
-inline bool even (size_t x)
+// Bipartitions
+
+uint64_t mix64 (uint64_t x)
+// splitmix64
 {
-  return x % 2 == 0;
+  x += 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
 }
-#endif
-  
-  
-  
-void adjustNode2leaves (const Tree &tree,
-                        const Leaves &allLeaves)
-// Update: node2leaves
+
+
+
+struct Split
+// Bipartition of leaves induced by an arc: the smaller side, or the side with the first leaf if the sides are equal
+// A leaf set is identified by the XOR of random 128-bit leaf hashes; probability of a collision among n sets ~ n^2 / 2^129
 {
-  ASSERT (allLeaves. searchSorted);
+  size_t size {0};
+    // # leaves
+  uint64_t hash [2] {0, 0};
   
- 	const size_t all = allLeaves. size ();
-  for (auto& it : node2leaves)
+
+  static Split leaf (size_t num)
+    { Split s;
+      s. size = 1;
+      s. hash [0] = mix64 (2 * num);
+      s. hash [1] = mix64 (2 * num + 1);
+      return s;
+    }
+  void add (const Split &other)
+    { size += other. size;
+      hash [0] ^= other. hash [0];
+      hash [1] ^= other. hash [1];
+    }
+  bool operator== (const Split &other) const
+    { return    size     == other. size
+             && hash [0] == other. hash [0]
+             && hash [1] == other. hash [1];
+    }
+  bool trivial () const
+    { return size <= 1; }
+
+  struct Hasher
   {
-    const Tree::TreeNode* node = it. first;
-    ASSERT (node->graph);
-    if (& node->getTree () != & tree)
-      continue;
-    Leaves& leaves = it. second;
-  	const size_t size = leaves. size ();
-  	ASSERT (size <= all);
-  	if (   size > all / 2
-  	    || (even (all) && size == all / 2 && ! leaves. containsFast (allLeaves. front ()))
-  	   )
-  	{
-  	  Leaves s (allLeaves);
-      ASSERT (s. searchSorted);  
-      ASSERT (leaves. searchSorted);  
-  	  s. setMinus (leaves);
-  	  leaves = s;
-      ASSERT (leaves. searchSorted);  
-  	}
-  	ASSERT (leaves. size () <= all / 2);
-  	IMPLY (even (all) && leaves. size () == all / 2, leaves. containsFast (allLeaves. front ()));
-  }
-}
+    size_t operator() (const Split &s) const
+      { return (size_t) s. hash [0]; }
+  };
+};
+
+
 
+typedef  unordered_set<Split, Split::Hasher>  Splits;
 
 
-struct Signature
+
+struct PostOrder
+// Tree nodes, children before parents
 {
-  size_t leaves {0};
-  string front;
-  string back;
-  
-  Signature () = default;
-  Signature (size_t leaves_arg,
-             const string &front_arg,
-             const string &back_arg)
-    : leaves (leaves_arg)
-    , front (front_arg)
-    , back (back_arg)
-    { ASSERT (leaves);
-      ASSERT (! front. empty ());
-      ASSERT (! back.  empty ()); 
+  VectorPtr<Tree::TreeNode> nodes;
+  Vector<size_t> parents;
+    // Index in nodes, no_index for the root
+  Vector<size_t> leafNums;
+    // In Leaf2num, no_index for an interior node or an unknown leaf
+
+
+  PostOrder (const Tree &tree,
+             const Leaf2num &leaf2num)
+    { ASSERT (tree. root);
+      // Pre-order without recursion
+      VectorPtr<Tree::TreeNode> stack;
+      Vector<size_t> stackParents;
+      stack << static_cast <const Tree::TreeNode*> (tree. root);
+      stackParents << no_index;
+      nodes.    reserve (tree. nodes. size ());
+      parents.  reserve (tree. nodes. size ());
+      leafNums. reserve (tree. nodes. size ());
+      while (! stack. empty ())
+      { const Tree::TreeNode* node = stack. pop ();
+        const size_t index = nodes. size ();
+        nodes << node;
+        parents << stackParents. pop ();
+        size_t num = no_index;
+        if (node->isLeafType ())
+        { const auto it = leaf2num. find (node->getName ());
+          if (it != leaf2num. end ())
+            num = it->second;
+        }
+        leafNums << num;
+      	for (const DiGraph::Arc* arc : node->arcs [false])
+      	{ stack << static_cast <const Tree::TreeNode*> (arc->node [false]);
+      	  stackParents << index;
+      	}
+      }
+      // Reverse
+      const size_t n = nodes. size ();
+      nodes. reverse ();
+      leafNums. reverse ();
+      parents. reverse ();
+      for (size_t& parent : parents)
+        if (parent != no_index)
+          parent = n - 1 - parent;
+    }
+
+
+  Vector<Split> getSplits (const Vector<bool> &common) const
+    // Return: parallel to nodes
+    // Input: common: by leafNums, leaves of the bipartitions
+    { Split all;
+      size_t front = no_index;
+      FFOR (size_t, i, common. size ())
+        if (common [i])
+        { if (front == no_index)
+            front = i;
+          all. add (Split::leaf (i));
+        }
+      Vector<Split> splits (nodes. size ());
+      Vector<bool> hasFront (nodes. size (), false);
+      FFOR (size_t, i, nodes. size ())
+      { const size_t num = leafNums [i];
+        if (num != no_index && common [num])
+        { splits [i]. add (Split::leaf (num));
+          hasFront [i] = (num == front);
+        }
+        const size_t parent = parents [i];
+        if (parent != no_index)
+        { ASSERT (parent > i);
+          splits [parent]. add (splits [i]);
+          if (hasFront [i])
+            hasFront [parent] = true;
+        }
+        Split& s = splits [i];
+        ASSERT (s. size <= all. size);
+      	if (   s. size > all. size / 2
+      	    || (even (all. size) && s. size == all. size / 2 && ! hasFront [i])
+      	   )
+      	{ s. size = all. size - s. size;
+          s. hash [0] ^= all. hash [0];
+          s. hash [1] ^= all. hash [1];
+        }
+      	ASSERT (s. size <= all. size / 2);
+      }
+      return splits;
     }    
 };
 
 
 
-bool operator< (const Signature &a,
-                const Signature &b)
+Splits getNontrivial (const Vector<Split> &splits)
 { 
-  LESS_PART (a, b, leaves);
-  LESS_PART (a, b, front);
-  LESS_PART (a, b, back);
-  return false;
+  Splits s;  s. rehash (splits. size ());
+  for (const Split& split : splits)
+    if (! split. trivial ())
+      s. insert (split);
+  return s;
 }
 
 
 
-Signature leaves2signature (const Leaves &leaves)
+size_t robinsonFoulds (const Splits &s1,
+                       const Splits &s2,
+                       size_t &intersection)
+// Output: intersection
 {
-  ASSERT (leaves. searchSorted);
-  return leaves. empty () 
-           ? Signature ()
-           : Signature (leaves. size (), leaves. front (), leaves. back ());
+  intersection = 0;
+  for (const Split& split : s1)
+    if (s2. find (split) != s2. end ())
+      intersection++;
+  ASSERT (intersection <= s1. size ());
+  ASSERT (intersection <= s2. size ());
+  return s1. size () + s2. size () - 2 * intersection;
 }
 
 
@@ -222,39 +300,90 @@ struct ThisApplication : Application
 	  addPositional ("input_tree2", "Tree 2");
 	  addKey ("type", "Tree type: dist|feature", "dist");
 	  addFlag ("arc_info", "Print arc information: length, depth, # leaves");
+	  addFlag ("batch", "<input_tree2> is a list of trees (e.g., versions of Tree 1) to be compared with Tree 1 on their common leaves. Print a line per tree: <tree>, # common leaves, # non-trivial bipartitions in Tree 1, in <tree>, in both, Robinson-Foulds distance, normalized Robinson-Foulds distance");
 	}
 
 
 
+	Tree* loadTree (const string &fName,
+	                const string &treeType) const
+	{
+	  Tree* tree = nullptr;
+    if (treeType == "dist")
+      tree = new DistTree (fName, string (), string (), string ());
+    else
+      tree = new FeatureTree (fName, string (), false, string (), false, true, false);
+    if (verbose ())
+      tree->qc ();
+    return tree;
+  }
+
+
+
 	void body () const final
   {
 		const string input_tree1 = getArg ("input_tree1");
 		const string input_tree2 = getArg ("input_tree2");
 		const string treeType    = getArg ("type");
 	  const bool   arc_info    = getFlag ("arc_info");
+	  const bool   batch       = getFlag ("batch");
 		             
 		if (! (   treeType == "dist" 
 		       || treeType == "feature" 
 		      )
 		   )
 		  throw runtime_error ("Wrong tree type");
+		if (batch && arc_info)
+		  throw runtime_error ("-arc_info is not compatible with -batch");
 		       
 		       
-    unique_ptr<Tree> tree1;
-    if (treeType == "dist")
-      tree1. reset (new DistTree (input_tree1, string (), string (), string ()));
-    else
-      tree1. reset (new FeatureTree (input_tree1, string (), false, string (), false, true, false));
-    if (verbose ())
-      tree1->qc ();     
+    unique_ptr<Tree> tree1 (loadTree (input_tree1, treeType));
       
-    unique_ptr<Tree> tree2;
-    if (treeType == "dist")
-      tree2. reset (new DistTree (input_tree2, string (), string (), string()));
-    else
-      tree2. reset (new FeatureTree (input_tree2, string (), false, string (), false, true, false));
-    if (verbose ())
-      tree2->qc (); 
+
+    if (batch)
+    {
+      // Index of Tree 1, reused for all trees
+      const Leaves leaves1 (tree2leaves (*tree1));
+      const Leaf2num leaf2num (leaves2nums (leaves1));
+      const PostOrder po1 (*tree1, leaf2num);
+
+      cout << "#Tree\tLeaves\tSplits1\tSplits2\tCommon splits\tRF\tRF normalized" << endl;
+      LineInput f (input_tree2);
+      while (f. nextLine ())
+      {
+        trim (f. line);
+        if (f. line. empty ())
+          continue;
+        const unique_ptr<const Tree> tree2 (loadTree (f. line, treeType));
+        const PostOrder po2 (*tree2, leaf2num);
+        Vector<bool> common (leaves1. size (), false);
+        size_t leaves = 0;
+        for (const size_t num : po2. leafNums)
+          if (num != no_index)
+          {
+            ASSERT (! common [num]);
+            common [num] = true;
+            leaves++;
+          }
+        const Splits splits1 (getNontrivial (po1. getSplits (common)));
+        const Splits splits2 (getNontrivial (po2. getSplits (common)));
+        size_t intersection = 0;
+        const size_t rf = robinsonFoulds (splits1, splits2, intersection);
+        const size_t rf_max = splits1. size () + splits2. size ();
+        cout         << f. line
+             << '\t' << leaves
+             << '\t' << splits1. size ()
+             << '\t' << splits2. size ()
+             << '\t' << intersection
+             << '\t' << rf
+             << '\t' << (rf_max ? (Real) rf / (Real) rf_max : 0.0)
+             << endl;
+      }
+      return;
+    }
+
+
+    unique_ptr<Tree> tree2 (loadTree (input_tree2, treeType));
       
     tree2names (*tree1);
     tree2names (*tree2);
@@ -325,51 +454,42 @@ struct ThisApplication : Application
    	}
 
     
-    setNode2leaves (tree1->root);
-    setNode2leaves (tree2->root); 
+    unordered_map <const Tree::TreeNode*, Split> node2split1;
+    Splits splits1;
+    Splits splits2;
     {
       const Leaves allLeaves (tree2leaves (*tree1));  // Same for *tree2
-      adjustNode2leaves (*tree1, allLeaves);   
-      adjustNode2leaves (*tree2, allLeaves);   
-    }
-
-    map <Signature, VectorPtr<Tree::TreeNode>> signature2nodes2;  // tree2
-   	for (const DiGraph::Node* node2_ : tree2->nodes)  
-   	{
-   	  const Tree::TreeNode* node2 = static_cast <const Tree::TreeNode*> (node2_);
-   	  signature2nodes2 [leaves2signature (node2leaves [node2])] << node2;
-   	}
-
-
-    map <const Tree::TreeNode* /*tree1*/, const Tree::TreeNode* /*tree2*/> node2node;  
-      // key: !nullptr
-      // value: not deterministic <= Leaf's in tree2 are removed 
-   	for (const Tree::TreeNode* node1 : interiorArcNodes1)  
-   	{
-   		const Signature sig (leaves2signature (node2leaves [node1]));
-      if (sig. leaves)
+      const Leaf2num leaf2num (leaves2nums (allLeaves));
+      const Vector<bool> common (allLeaves. size (), true);
       {
-	   	  const VectorPtr<Tree::TreeNode> nodes2 (signature2nodes2 [sig]);
-	   	  for (const Tree::TreeNode* node2 : nodes2)
-	     	  if (node2leaves [node1] == node2leaves [node2])
-	   	    {
-	 	        node2node [node1] = node2;
-	   	      break;  
-	   	    }
-	   	}
-	   	else /*if (! skip_empty)*/
-	   		node2node [node1] = nullptr;
-   	}
+        const PostOrder po1 (*tree1, leaf2num);
+        const Vector<Split> splits (po1. getSplits (common));
+        node2split1. rehash (splits. size ());
+        FFOR (size_t, i, splits. size ())
+          node2split1 [po1. nodes [i]] = splits [i];
+        splits1 = getNontrivial (splits);
+      }
+      {
+        const PostOrder po2 (*tree2, leaf2num);
+        const Vector<Split> splits (po2. getSplits (common));
+        splits2. rehash (splits. size ());
+        for (const Split& split : splits)
+          splits2. insert (split);
+      }
+    }
 
    	
    	MeanVar mv;
    	for (const Tree::TreeNode* node1 : interiorArcNodes1)  
    	{
-      cout << "match" << (contains (node2node, node1) ? '+' : '-') 
+   	  const Split& split = node2split1 [node1];
+   	  const bool matched =    ! split. size
+   	                       || splits2. find (split) != splits2. end ();
+      cout << "match" << (matched ? '+' : '-')
       	   << '\t' << getNodeName (node1);
       if (arc_info)
       	cout 
-      	   << '\t' << node2leaves [node1]. size ()
+      	   << '\t' << split. size
       	   << '\t' << node1->getParentDistance ()
       	   << '\t' << node1->getRootDistance ();
       cout << endl;
@@ -378,6 +498,16 @@ struct ThisApplication : Application
     cout << endl << "Depth" << '\t';
     mv. saveText (cout);
     cout << endl;
+
+    {
+      for (auto it = splits2. begin (); it != splits2. end ();)
+        if (it->trivial ())
+          it = splits2. erase (it);
+        else
+          it++;
+      size_t intersection = 0;
+      cout << "Robinson-Foulds distance\t" << robinsonFoulds (splits1, splits2, intersection) << endl;
+    }
         
       
     // ??
@@ -37,6 +37,8 @@
 
 #include "distTree.hpp"
 
+#include <charconv>
+
 #include "../dm/prediction.hpp"
 #include "../dm/optim.hpp"
 
@@ -90,6 +92,215 @@ void dissimTransform (Real &target)
 
 
 
+// BinaryRegression
+
+namespace
+{
+
+struct BinaryRegression
+// L2 linear regression with 0/1 predictors and without missing values
+// Cf. L2LinearNumPrediction: the same results without Dataset, Space1, Sample
+// The buffers keep their capacity, so a thread_local object does not allocate memory for small problems after the first use
+{
+  size_t predictors {0};
+  // Index: row
+  Vector<Real> targets;
+  Vector<Real> mults;
+    // >= 0
+  Vector<size_t> rowStarts;
+    // size() = rows + 1
+  Vector<size_t> rowPredictors;
+    // Index: rowStarts[row] .. rowStarts[row+1]-1
+    // Predictors equal to 1 in row
+  // Output
+  Vector<Real> beta;
+    // size() = predictors
+private:
+  Vector<Real> matr;
+    // size() = predictors^2
+  Vector<Real> xy;
+  Vector<Real> residuals;
+  Vector<Real> beta_init;
+public:
+
+
+  void reset (size_t predictors_arg)
+    { predictors = predictors_arg;
+      targets. clear ();
+      mults. clear ();
+      rowStarts. clear ();
+      rowStarts << 0;
+      rowPredictors. clear ();
+      beta. clear ();
+      beta. resize (predictors, 0.0);
+    }
+  void addRow (Real target,
+               Real mult)
+    // Then: addPredictor() for the new row
+    { ASSERT (! isNan (target));
+      ASSERT (mult >= 0.0);
+      ASSERT (mult < inf);
+      targets << target;
+      mults << mult;
+      rowStarts << rowPredictors. size ();
+    }
+  void addPredictor (size_t predictor)
+    // Of the last row
+    { ASSERT (predictor < predictors);
+      ASSERT (! targets. empty ());
+      rowPredictors << predictor;
+      rowStarts. back () = rowPredictors. size ();
+    }
+  size_t rows () const
+    { return targets. size (); }
+  Real predict (size_t row) const
+    { Real s = 0.0;
+      FOR_START (size_t, i, rowStarts [row], rowStarts [row + 1])
+        s += beta [rowPredictors [i]];
+      return s;
+    }
+  Real getResidual (size_t row) const
+    { return targets [row] - predict (row); }
+  Real getAbsCriterion () const
+    { Real s = 0.0;
+      FFOR (size_t, row, rows ())
+        s += sqr (getResidual (row)) * mults [row];
+      return s;
+    }
+  bool solveUnconstrained ()
+    // Return: false if the normal equations are singular
+    // Output: beta
+    // Time: O(p^3 + n)
+    { const size_t p = predictors;
+      matr. clear ();
+      matr. resize (p * p, 0.0);
+      xy. clear ();
+      xy. resize (p, 0.0);
+      FFOR (size_t, row, rows ())
+      { const Real mult = mults [row];
+        if (! mult)
+          continue;
+        const size_t start = rowStarts [row];
+        const size_t end   = rowStarts [row + 1];
+        FOR_START (size_t, i, start, end)
+        { const size_t a = rowPredictors [i];
+          xy [a] += targets [row] * mult;
+          FOR_START (size_t, j, start, end)
+            matr [a * p + rowPredictors [j]] += mult;
+        }
+      }
+      // Cholesky decomposition: matr = L L', L is in the lower triangle of matr
+      FFOR (size_t, j, p)
+      { Real d = matr [j * p + j];
+        FOR (size_t, k, j)
+          d -= sqr (matr [j * p + k]);
+        if (d <= 0.0 || isNan (d))
+          return false;
+        d = sqrt (d);
+        matr [j * p + j] = d;
+        FOR_START (size_t, i, j + 1, p)
+        { Real s = matr [i * p + j];
+          FOR (size_t, k, j)
+            s -= matr [i * p + k] * matr [j * p + k];
+          matr [i * p + j] = s / d;
+        }
+      }
+      // L L' beta = xy
+      FFOR (size_t, i, p)
+      { Real s = xy [i];
+        FOR (size_t, k, i)
+          s -= matr [i * p + k] * beta [k];
+        beta [i] = s / matr [i * p + i];
+      }
+      FOR_REV (size_t, i, p)
+      { Real s = beta [i];
+        FOR_START (size_t, k, i + 1, p)
+          s -= matr [k * p + i] * beta [k];
+        beta [i] = s / matr [i * p + i];
+      }
+      return true;
+    }
+  bool solveUnconstrainedFast (uint maxIter,
+                               Real errorRelDiff)
+    // Return: converged
+    // Update: beta: non-negative
+    // Cf. LinearNumPrediction::solveUnconstrainedFast() with betaNonNegative
+    { ASSERT (maxIter);
+      ASSERT (errorRelDiff > 0.0);
+      ASSERT (beta. size () == predictors);
+      beta_init = beta;
+      const Real absCriterion_old = getAbsCriterion ();
+      bool solved = false;
+      if (predictors <= 2 * maxIter)  // PAR
+        if (solveUnconstrained ())
+        { solved = true;
+          for (Real& b : beta)
+            if (maximize (b, 0.0))
+              solved = false;
+        }
+      if (! solved || getAbsCriterion () > absCriterion_old)
+      { beta = beta_init;
+        solved = solveUnconstrainedAlternate (maxIter, errorRelDiff);
+      }
+      if (! solved || getAbsCriterion () > absCriterion_old)
+      { beta = beta_init;
+        solved = false;
+      }
+      return solved;
+    }
+private:
+  bool solveUnconstrainedAlternate (uint maxIter,
+                                    Real errorRelDiff)
+    // Coordinate descent
+    // Cf. LinearNumPrediction::solveUnconstrainedAlternate()
+    { residuals. clear ();
+      FFOR (size_t, row, rows ())
+        residuals << getResidual (row);
+      const auto residualCriterion = [this] ()
+        { Real s = 0.0;
+          FFOR (size_t, row, rows ())
+            s += sqr (residuals [row]) * mults [row];
+          return s;
+        };
+      const Real absCriterion_init = residualCriterion ();
+      Real absCriterion_prev = absCriterion_init;
+      bool ok = false;
+      FOR (uint, iter, maxIter)
+      { FFOR (size_t, a, predictors)
+        { Real mult_sum = 0.0;
+          Real s = 0.0;
+          FFOR (size_t, row, rows ())
+            FOR_START (size_t, i, rowStarts [row], rowStarts [row + 1])
+              if (rowPredictors [i] == a)
+              { mult_sum += mults [row];
+                s += (residuals [row] + beta [a]) * mults [row];
+              }
+          if (! mult_sum)
+            continue;
+          const Real b = max (0.0, s / mult_sum);
+          const Real delta = beta [a] - b;
+          FFOR (size_t, row, rows ())
+            FOR_START (size_t, i, rowStarts [row], rowStarts [row + 1])
+              if (rowPredictors [i] == a)
+                residuals [row] += delta;
+          beta [a] = b;
+        }
+        const Real absCriterion = residualCriterion ();
+        if (absCriterion_prev / absCriterion - 1.0 <= errorRelDiff) 
+        { ok = absCriterion < absCriterion_init;
+          break;
+        }
+        absCriterion_prev = absCriterion;
+      }
+      return ok && getAbsCriterion () < absCriterion_init;
+    }
+};
+
+}
+
+
+
+
 // Neighbor
 
 struct Neighbor 
@@ -939,32 +1150,6 @@ Vector<uint> DTNode::getLcaDissimNums ()
 
 
 
-void DTNode::setErrorDensity (Real absCriterion_ave)
-{
-  ASSERT (absCriterion_ave >= 0.0);
-  
-  Real a = 0.0;
-  Real b = 0.0;
-  for (const uint dissimNum : pathDissimNums)
-  {
-    const Dissim& dissim = getDistTree (). dissims [dissimNum];
-    if (! dissim. validMult ())
-      continue;
-    const Real criterion = dissim. getAbsCriterion ();
-    ASSERT (criterion >= 0.0);
-    ASSERT (criterion < inf);
-    ASSERT (dissim. prediction >= 0.0);
-    if (! dissim. prediction)
-      continue;
-    a += (criterion / absCriterion_ave - 1.0) / dissim. prediction;
-    b += 1.0 / sqr (dissim. prediction);
-  }
-  
-  errorDensity = a / sqrt (2.0 * b);
-}
-
-
-
 VectorPtr<Leaf> DTNode::getSparseLeafMatches (const string &targetName,
                                               size_t depth_max,
                                               bool subtractDissims,
@@ -1599,62 +1784,6 @@ void Leaf::collapse (Leaf* other)
 
 
 
-void Leaf::addHybridTriangles (Vector<Triangle> &triangles) const
-{
-  ASSERT (DistTree_sp::hybridness_min > 1.0);
-  ASSERT (graph);
-  
-  const Vector<Dissim>& dissims = getDistTree (). dissims;
-
-  Vector<Neighbor> neighbors;  neighbors. reserve (pathDissimNums. size ());
-  for (const uint dissimNum1 : pathDissimNums)
-  {
-    const Dissim& dissim1 = dissims [dissimNum1];
-    if (! dissim1. validMult ())
-      continue;
-    const Leaf* parent1 = dissim1. getOtherLeaf (this);
-    ASSERT (parent1->graph);
-    ASSERT (parent1 != this);
-    neighbors << Neighbor (parent1, dissim1. type, dissim1. target);
-  }
-  neighbors. sort ();  // --> unordered_set ??
-  ASSERT (neighbors. isUniq ());
-
-  // Time: ~ O(log^4(n))  
-  for (const Neighbor& neighbor1 : neighbors)
-  {
-    const Leaf* parent1 = neighbor1. leaf;
-    for (const uint dissimNum2 : parent1->pathDissimNums)
-    {
-      const Dissim& dissim2 = dissims [dissimNum2];
-      if (! dissim2. validMult ())
-        continue;
-      if (dissim2. type != neighbor1. dissimType)
-        continue;
-      const Leaf* parent2 = dissim2. getOtherLeaf (parent1);
-      ASSERT (parent2->graph);
-      ASSERT (parent2 != parent1);
-      if (parent2 == this)
-        continue;
-      const size_t i = neighbors. binSearch (Neighbor (parent2, dissim2. type));
-      if (i == no_index)
-        continue;
-      addTriangle ( triangles
-                  , this
-                  , parent1
-                  , parent2
-                  , dissim2. target
-                  , neighbors [i]. target
-                  , neighbor1. target
-                  , neighbor1. dissimType
-                  );
-    }
-  }
-}
-
-
-
-
 // SubPath
 
 void SubPath::qc () const
@@ -2344,67 +2473,48 @@ bool Change::apply ()
   ASSERT (! inter->len);
   
 
-  Dataset ds;
-  ds. objs. reserve (subgraph. subPaths. size ());
-  auto target = new RealAttr1 ("target", ds);
-  FFOR (size_t, objNum, subgraph. subPaths. size ())
-    ds. appendObj ();
-  auto fromAttr  = new ExtBoolAttr1 ("from",  ds);
-  auto toAttr    = new ExtBoolAttr1 ("to",    ds);
-  auto interAttr = new ExtBoolAttr1 ("inter", ds);
-  fromAttr ->setAll (efalse);
-  toAttr   ->setAll (efalse);
-  interAttr->setAll (efalse);
+  // Predictors: from (0), to (1), inter (2)
+  static thread_local BinaryRegression lr;
+  lr. reset (arcEnd ? 3 : 1);
   Tree::LcaBuffer buf;
-  FFOR (size_t, objNum, subgraph. subPaths. size ())
+  for (const SubPath& subPath : subgraph. subPaths)
   {
-    const SubPath& subPath = subgraph. subPaths [objNum];
     const VectorPtr<Tree::TreeNode>& path = subgraph. getPath (subPath, buf);
+    const Dissim& dissim = tree. dissims [subPath. dissimNum];
+    ASSERT (dissim. valid ());
+    ASSERT (dissim. mult < inf);
+    lr. addRow (dissim. target - subPath. dist_hat_tails - DistTree::path2prediction (path), dissim. mult);
     if (path. contains (from))
     {
-      (*fromAttr) [objNum] = etrue;
+      lr. addPredictor (0);
       const bool toVia    = path. contains (to);
       const bool interVia = path. contains (inter);
       ASSERT (toVia != interVia);
-      if (toVia)
-        (*toAttr) [objNum] = etrue;
-      if (interVia)
-        (*interAttr) [objNum] = etrue;
+      if (arcEnd)
+      {
+        if (toVia)
+          lr. addPredictor (1);
+        if (interVia)
+          lr. addPredictor (2);
+      }
     }
     else
     {
       const bool toUsed = path. contains (to);
       ASSERT (toUsed);
       ASSERT (toUsed == path. contains (inter));
-      if (toUsed)
+      if (toUsed && arcEnd)
       {
-        (*toAttr)    [objNum] = etrue;
-        (*interAttr) [objNum] = etrue;
+        lr. addPredictor (1);
+        lr. addPredictor (2);
       }
     }
-    const Dissim& dissim = tree. dissims [subPath. dissimNum];
-    ASSERT (dissim. valid ());
-    ASSERT (dissim. mult < inf);
-    var_cast (ds. objs [objNum]) -> mult = dissim. mult; 
-    (*target) [objNum] = dissim. target - subPath. dist_hat_tails - DistTree::path2prediction (path);
   }
-  ds. qc ();
-  
-  Space1<NumAttr1> sp (ds, false);  sp. reserve (3);
-  sp << fromAttr;  // 0
-  if (arcEnd)
-    sp << toAttr      // 1
-       << interAttr;  // 2
-  const Sample sample (ds);
-  L2LinearNumPrediction lr (sample, sp, *target);
-  lr. solveUnconstrained ();
-  if (verbose ())
-    lr. qc ();  
-  if (isNan (lr. absCriterion))
+  if (! lr. solveUnconstrained ())
     return false;
 
-  FFOR (size_t, i, lr. beta. size ())
-    maximize (lr. beta [i], 0.0);
+  for (Real& b : lr. beta)
+    maximize (b, 0.0);
 
   if (arcEnd)
   {
@@ -2706,6 +2816,8 @@ void Image::processSmall (const DTNode* center_arg,
   const DistTree& wholeTree = center->getDistTree ();
   ASSERT (& wholeTree == & subgraph. tree);
 
+  const Arena::Scope arenaScope (arena);
+
 
   chron_tree2subgraph. start ();
 
@@ -2802,7 +2914,7 @@ void Image::processSmall (const DTNode* center_arg,
 
 void Image::processLarge (const Steiner* subTreeRoot,
                           const VectorPtr<Tree::TreeNode> &possibleBoundary,
-                          const VectorOwn<Change>* changes)
+                          const VectorPtr<Change>* changes)
 {
   ASSERT (subgraph. empty ());
   ASSERT (! tree);              
@@ -2881,6 +2993,7 @@ void Image::processLarge (const Steiner* subTreeRoot,
           }
         }
     //PRINT (newChanges. size ());  
+      newChanges. sort (Change::longer); 
       tree->applyChanges (newChanges, true); 
     }
     else
@@ -3187,18 +3300,128 @@ DistTree::DistTree (const string &dissimFName,
 namespace
 {
 
-void processDissimLine (size_t from,
-                        size_t to,
-                        Notype /*&res*/,
-                        Vector<DissimLine> &dls,
-                        const DistTree::Name2leaf &name2leaf)
+struct LeafNameIndex
+// Leaf's sorted by name with an open-addressing hash table
 {
-  Progress prog (to - from, 1000);  // PAR
-  FOR_START (size_t, i, from, to)
+  Vector<Leaf*> leaves;
+    // Sorted by Leaf::name
+private:
+  Vector<uint> table;
+    // Index in leaves + 1, 0 <=> empty slot
+  size_t mask {0};
+public:
+  
+
+  explicit LeafNameIndex (const DistTree::Name2leaf &name2leaf)
+    { leaves. reserve (name2leaf. size ());
+      for (const auto& it : name2leaf)
+        leaves << var_cast (it. second);
+      Common_sp::sort (leaves, [] (const Leaf* a, const Leaf* b) { return a->name < b->name; });
+      size_t size = 2;
+      while (size < 2 * leaves. size ())
+        size *= 2;
+      table. resize (size, 0);
+      mask = size - 1;
+      FFOR (size_t, rank, leaves. size ())
+      { size_t i = hash (leaves [rank] -> name) & mask;
+        while (table [i])
+          i = (i + 1) & mask;
+        table [i] = (uint) (rank + 1);
+      }
+    }
+    
+    
+  uint find (string_view name) const
+    // Return: index in leaves, or DissimLine::no_rank
+    { size_t i = hash (name) & mask;
+      while (const uint r = table [i])
+      { if (leaves [r - 1] -> name == name)
+          return r - 1;
+        i = (i + 1) & mask;
+      }
+      return DissimLine::no_rank;
+    }
+private:
+  static size_t hash (string_view name)
+    { return std::hash<string_view> () (name); }
+};
+
+
+
+struct DissimChunk
+{
+  Vector<DissimLine> dissimLines;
+    // stable_sort()'ed
+  size_t errorPos {no_index};
+    // Start of the line with an error
+  string error;
+};
+
+
+
+void parseDissimLines (size_t from,
+                       size_t to,
+                       DissimChunk &res,
+                       string_view text,
+                       const Vector<size_t> &bounds,
+                       const LeafNameIndex &index)
+// Input: [bounds[from], bounds[to]): text of whole lines
+{
+  Progress prog (0, dissim_progress);  
+  FOR_START (size_t, chunk, from, to)
   {
-    prog ();
-    dls [i]. process (name2leaf);
+    const size_t end = bounds [chunk + 1];
+    size_t pos = bounds [chunk];
+    while (pos < end)
+    {
+      prog ();
+      size_t eol = text. find ('\n', pos);
+      if (eol == string_view::npos)
+        eol = text. size ();
+      ASSERT (eol < end || eol == text. size ());
+      try 
+      {
+        DissimLine dl (text. substr (pos, eol - pos));
+        if (DM_sp::finite (dl. dissim))
+        {
+          dl. rank1 = index. find (dl. name1);
+          dl. rank2 = index. find (dl. name2);
+          if (dl. rank1 != DissimLine::no_rank)
+          {
+            dl. leaf1 = index. leaves [dl. rank1];
+            if (dl. rank2 != DissimLine::no_rank)
+              dl. leaf2 = index. leaves [dl. rank2];
+          }
+          res. dissimLines << dl;
+        }
+      }
+      catch (const exception &e)
+      {
+        res. errorPos = pos;
+        res. error = e. what ();
+        return;
+      }
+      pos = eol + 1;
+    }
   }
+  std::stable_sort (res. dissimLines. begin (), res. dissimLines. end ());
+}
+
+
+
+void mergeDissimLines (size_t from,
+                       size_t to,
+                       Notype /*&res*/,
+                       Vector<DissimLine> &dissimLines,
+                       const Vector<size_t> &runs)
+// Input: dissimLines[runs[i],runs[i+1]): sort()'ed
+// Output: dissimLines[runs[2*i],runs[2*i+2]): sort()'ed, stable
+{
+  FOR_START (size_t, i, from, to)
+    std::inplace_merge ( dissimLines. begin () + (long) runs [2 * i]
+                       , dissimLines. begin () + (long) runs [2 * i + 1]
+                       , dissimLines. begin () + (long) runs [2 * i + 2]
+                       );
 }
 
 
@@ -3333,7 +3556,7 @@ DistTree::DistTree (const string &dataDirName,
     loadDissimPrepare (name2leaf. size () * getSparseDissims_size ()); 
     const string fName (dataDirName + "dissim");
     {
-      const Vector<DissimLine> dissimLines (getDissimLines (fName, dissims. capacity ()));
+      const DissimLines dissimLines (getDissimLines (fName));
       {
         Progress prog (dissimLines. size (), dissim_progress);
         for (const DissimLine &dl : dissimLines)
@@ -3479,13 +3702,16 @@ struct Newick
      string ::=  // No ' ', ',', ';', '(', ')'
      comment ::= \[ string_space \]
 */
+// Non-recursive: the depth of a tree may be O(n)
 {
 private:
-  istream& f;
+  const string_view text;
   DistTree& tree;
   char c {' '};
-    // Current character of f
-  streamsize pos {0};
+    // Current character of text
+  size_t pos {0};
+    // Of the next character of text
+  bool eof {false};
   static const string delimiters;
 public:
 
@@ -3499,12 +3725,11 @@ public:
   };
 
 
-  Newick (istream &f_arg,
+  Newick (string_view text_arg,
           DistTree &tree_arg)
-    : f (f_arg)
+    : text (text_arg)
     , tree (tree_arg)
     { 
-      ASSERT (f. good ()); 
       ASSERT (tree. nodes. empty ());
 
       // Comment
@@ -3514,13 +3739,15 @@ public:
         for (;;)
         {
           readChar ();
+          if (eof)
+            throw Error ("Unexpected end of file", *this);
           if (c == ']')
             break;
         }
         readChar ();
       }
 
-      parseSubtree (nullptr);
+      parseTree ();
 
       skipSpaces ();
       if (c != ';')
@@ -3533,7 +3760,13 @@ private:
   {
     for (;;)
     {
-      f. get (c);
+      if (pos >= text. size ())
+      {
+        eof = true;
+        c = '\0';
+        return;
+      }
+      c = text [pos];
       pos++;
       if (   c != '\n'
           && c != '\r'
@@ -3546,7 +3779,7 @@ private:
   {
     while (c == ' ')
       readChar ();
-    if (f. eof ())
+    if (eof)
       throw Error ("Unexpected end of file", *this);
   }
   
@@ -3559,6 +3792,8 @@ private:
       for (;;)
       {
         readChar ();
+        if (eof)
+          throw Error ("Unexpected end of file", *this);
         if (c == '\'')
           break;
         name += c;
@@ -3568,7 +3803,7 @@ private:
     else
       for (;;)
       {
-        if (contains (delimiters, c))
+        if (eof || contains (delimiters, c))
           break;
         if (! printable (c))
           throw Error ("Non-printable character in name: " + toString ((int) c), *this);
@@ -3579,67 +3814,88 @@ private:
       throw Error ("Empty name", *this);
     return name;
   }
-
-  void parseSubtree (Steiner* parent)
+  
+  void parseLen (DTNode* node)
   {
-    DTNode* node = parseItem (parent);
+    ASSERT (node);
     skipSpaces ();
     Real len = 0.0;
     if (c == ':')
     {
-      const streamsize start = f. tellg ();
-      len = NaN;
-      f >> len;
-      pos += (streamsize) f. tellg () - start;
+      while (pos < text. size () && isSpace (text [pos]))
+        pos++;
+      char buf [64];  // PAR
+      size_t n = 0;
+      while (   pos < text. size () 
+             && n < sizeof (buf) - 1
+             && (   isDigit (text [pos]) 
+                 || isLetter (text [pos]) 
+                 || text [pos] == '+'
+                 || text [pos] == '-'
+                 || text [pos] == '.'
+                )
+            )
+      {
+        buf [n] = text [pos];
+        n++;
+        pos++;
+      }
+      buf [n] = '\0';
+      char* end = nullptr;
+      len = strtod (buf, & end);
+      if (end == buf)
+        len = NaN;
       QC_ASSERT (! isNan (len));
       readChar ();
     }
     node->len = max (0.0, len);
   }
-  
-  DTNode* parseItem (Steiner* parent)
-  {
-    DTNode* node = nullptr;
-    skipSpaces ();
-    if (c == '(')
-    {
-      auto st = new Steiner (tree, parent, NaN);
-      parseInterior (st);
-      node = st;
-    }
-    else
-      node = new Leaf (tree, parent, NaN, parseName ());
-    ASSERT (node);
-    return node;
-  }
-  
-  void parseInterior (Steiner* parent)
+
+  void parseTree ()
   {
-    ASSERT (parent);
-    skipSpaces ();
-    if (c != '(')
-      throw Error ("'(' expected", *this);
-    // List
+    Vector<Steiner*> parents;
+      // Interior nodes whose list is being parsed
     for (;;)
     {
-      readChar ();
-      parseSubtree (parent);
+      // item
       skipSpaces ();
-      if (c == ')')
-        break;
-      if (c != ',')
-        throw Error ("Comma expected", *this);
-    }
-    readChar ();
-    skipSpaces ();
-    // Name
-    if (! contains (delimiters, c))
-    {
-      const string s (parseName ());
-      // bootstrap is lost ??
-      const size_t colonPos = s. find (':');      
-      if (colonPos != string::npos)
-        parent->name = s. substr (colonPos + 1);
+      Steiner* parent = parents. empty () ? nullptr : parents. back ();
+      if (c == '(')
+      {
+        parents << new Steiner (tree, parent, NaN);
+        readChar ();
+        continue;
+      }
+      DTNode* node = new Leaf (tree, parent, NaN, parseName ());
+      // The end of subtree's
+      for (;;)
+      {
+        parseLen (node);
+        if (parents. empty ())
+          return;
+        skipSpaces ();
+        if (c == ',')
+        {
+          readChar ();
+          break;
+        }
+        if (c != ')')
+          throw Error ("Comma expected", *this);
+        readChar ();
+        skipSpaces ();
+        Steiner* st = parents. back ();
+        parents. pop_back ();
+        // Name
+        if (! contains (delimiters, c))
+        {
+          const string s (parseName ());
+          // bootstrap is lost ??
+          const size_t colonPos = s. find (':');      
+          if (colonPos != string::npos)
+            st->name = s. substr (colonPos + 1);
+        }
+        node = st;
+      }
     }
   }
 };
@@ -3656,8 +3912,9 @@ DistTree::DistTree (const string &newickFName)
 : rand (seed_global)
 { 
   {
-    ifstream f (newickFName);
-    const Newick newick (f, *this);
+    const MappedFile mf (newickFName);
+    const Arena::Scope arenaScope (arena);
+    const Newick newick (mf. getView (), *this);
   }
   ASSERT (root);
   ASSERT (nodes. front () == root);
@@ -4029,157 +4286,176 @@ Steiner* DistTree::getName2steiner (const string &name,
 
 
 
-void DistTree::loadTreeFile (const string &fName)
-{
-  ASSERT (! subDepth);
-  ASSERT (! fName. empty ());
-
-  const StringVector lines (fName, (size_t) 10000, false);  // PAR
-  QC_ASSERT (! lines. empty ());
-
-  size_t lineNum = 0; 
-  Steiner* steiner = nullptr;   
-  EXEC_ASSERT (loadLines (lines, lineNum, steiner, 0));
-  ASSERT (lineNum <= lines. size ());
-  if (lineNum < lines. size ())
-    throw runtime_error ("Only " + to_string (lineNum) + " line(s) of " + strQuote (fName) + " have been loaded");
-}
-
-
-
 namespace 
 {
-  string token2string (const string &s,
-                       const string &token)
+  
+  bool nextTreeLine (string_view text,
+                     size_t &pos,
+                     string_view &line)
+  // The same lines as LineInput::nextLine()
+  // Update: pos
+  // Output: line
+  {
+    if (pos >= text. size ())
+      return false;
+    const size_t eol = text. find ('\n', pos);
+    if (eol == string_view::npos)
+    {
+      line = text. substr (pos);
+      pos = text. size ();
+    }
+    else
+    {
+      line = text. substr (pos, eol - pos);
+      pos = eol + 1;
+    }
+    return true;
+  }
+  
+  
+
+  string_view token2view (string_view s,
+                          const string &token)
+  // Return: the value of " <token>=<value>" in " " + s; points into s
   {
-    const string s1 (" " + s);
-    const string token1 (" " + token + "=");
-    const size_t pos = s1. find (token1);
-    if (pos == string::npos)
-      return string ();  
+    size_t pos = 0;
+    for (;;)
+    {
+      pos = s. find (token, pos);
+      if (pos == string_view::npos)
+        return string_view ();
+      if (   (! pos || s [pos - 1] == ' ')
+          && pos + token. size () < s. size ()
+          && s [pos + token. size ()] == '='
+         )
+        break;
+      pos++;
+    }
       
-    string valueS (s1. substr (pos + token1. size ()));
-    trim (valueS);
+    string_view valueS (s. substr (pos + token. size () + 1));
+    while (! valueS. empty () && isSpace (valueS. front ()))
+      valueS. remove_prefix (1);
+    while (! valueS. empty () && isSpace (valueS. back ()))
+      valueS. remove_suffix (1);
     if (valueS. empty ())
-      throw runtime_error (FUNC "Empty token '" + token + "' in: " + s);
+      throw runtime_error (FUNC "Empty token '" + token + "' in: " + string (s));
       
     if (valueS [0] == '\'')
     {
-      string name;
-      size_t i = 0;
-      for (;;)
-      {
-        i++;
-        if (! valueS [i])
-          throw runtime_error (FUNC "No closing single quote");
-        if (valueS [i] == '\'')
-          break;
-        else
-          name += valueS [i];
-      }
-      return name;
+      const size_t end = valueS. find ('\'', 1);
+      if (end == string_view::npos)
+        throw runtime_error (FUNC "No closing single quote");
+      return valueS. substr (1, end - 1);
     }
     
-    return findSplit (valueS);
+    return valueS. substr (0, valueS. find (' '));
   }
 
 
-  Real token2real (const string &s,
+  Real token2real (string_view s,
                    const string &token)
   {
-    const string valueS (token2string (s, token));
+    const string_view valueS (token2view (s, token));
     if (valueS. empty ())
       return NaN;
-    return str2real (valueS);
+    return str2real (string (valueS));
   }
 }
 
 
 
-bool DistTree::loadLines (const StringVector &lines,
-                          size_t &lineNum,
-                          Steiner* parent,
-                          size_t expectedOffset)
-{ 
+void DistTree::loadTreeFile (const string &fName)
+{
   ASSERT (! subDepth);
-  ASSERT (lineNum <= lines. size ());
-
-  if (lineNum == lines. size ())
-    return false;
+  ASSERT (! fName. empty ());
+  ASSERT (nodes. empty ());
 
-  const string& line = lines [lineNum];
-  string s (line);
-  trimLeading (s);
-  const size_t offset = line. size () - s. size ();
-  if (offset < expectedOffset)
-    return false;
-  if (offset != expectedOffset)
-  {
-    cout << "Line " << lineNum + 1 << ": " << line << endl;
-    throw runtime_error (FUNC "Tree file is damaged");
-  }
-  
-  lineNum++;
-
-  const size_t colonPos = s. find (": ");
-  if (colonPos == string::npos)
-    throw runtime_error (FUNC "No colon in line " + toString (lineNum));
-  const string idS = s. substr (0, colonPos);
-  s. erase (0, colonPos + 2);
-  if (idS. empty () || s. empty ())
-    throw runtime_error (FUNC "Bad format of line " + toString (lineNum));
-  const Real   len               = token2real (s, lenS);
-  const Real   errorDensity      = token2real (s, err_densityS);
-  const Real   normCriterion     = token2real (s, normCriterionS);  
-        string deformationObj    = token2string (s, deformationS);
-  const Real   deformation       = token2real (s, deformation_criterionS);
-  const string name              = token2string (s, "name");
-  const bool indiscernible = contains (s, Leaf::non_discernible);
-  QC_IMPLY (parent, len >= 0.0);
-  DTNode* dtNode = nullptr;
-  if (isLeft (idS, "0x"))
-  {
-    QC_ASSERT (! indiscernible);
-    Steiner* steinerParent = nullptr;
-    if (parent)
-    {
-      steinerParent = var_cast (parent->asSteiner ());
-      ASSERT (steinerParent);
-    }
-    auto steiner = new Steiner (*this, steinerParent, len);
-    while (loadLines (lines, lineNum, steiner, expectedOffset + Offset::delta))
-      ;
-    dtNode = steiner;
-    QC_ASSERT (isNan (normCriterion));
-  }
-  else
-  {
-    QC_ASSERT (parent);
-    auto leaf = new Leaf (*this, parent, len, idS);
-    leaf->discernible = /*DistTree_sp::variance_min ||*/ ! indiscernible;
-    leaf->normCriterion = normCriterion;
-    dtNode = leaf;
-  }
-  ASSERT (dtNode);
-  
-  dtNode->errorDensity = errorDensity;
-  if (! name. empty ())
-  {
-    QC_ASSERT (! dtNode->asLeaf ());
-    dtNode->name = name;
-  }
-  
-  QC_ASSERT (deformationObj. empty () == isNan (deformation));
-  if (! deformationObj. empty ())
-  {
-    const string leafName1 (findSplit (deformationObj, ':'));
-    QC_ASSERT (! deformationObj. empty ());
-    QC_ASSERT (deformation >= 0.0);
-    ASSERT (! contains (node2deformationPair, dtNode));
-    node2deformationPair [dtNode] = move (DeformationPair {leafName1, deformationObj, deformation});
+  const MappedFile mf (fName);
+  const string_view text (mf. getView ());
+  QC_ASSERT (! text. empty ());
+  
+  const Arena::Scope arenaScope (arena);
+
+  // Non-recursive: the depth of a tree may be O(n)
+  Vector<Steiner*> parents;  parents. reserve (1024);  // PAR
+    // parents[i]: the last Steiner with offset i * Offset::delta
+  size_t lineNum = 0;
+  size_t pos = 0;
+  string_view line;
+  while (nextTreeLine (text, pos, line))
+  {
+    size_t offset = 0;
+    while (offset < line. size () && isSpace (line [offset]))
+      offset++;
+    while (! parents. empty () && offset < parents. size () * Offset::delta)
+      parents. pop_back ();
+    if (parents. empty () && root)
+      throw runtime_error ("Only " + to_string (lineNum) + " line(s) of " + strQuote (fName) + " have been loaded");
+    if (offset != parents. size () * Offset::delta)
+    {
+      cout << "Line " << lineNum + 1 << ": " << line << endl;
+      throw runtime_error (FUNC "Tree file is damaged");
+    }
+    lineNum++;
+    
+    string_view s (line. substr (offset));
+    const size_t colonPos = s. find (": ");
+    if (colonPos == string_view::npos)
+      throw runtime_error (FUNC "No colon in line " + toString (lineNum));
+    const string_view idS (s. substr (0, colonPos));
+    s. remove_prefix (colonPos + 2);
+    if (idS. empty () || s. empty ())
+      throw runtime_error (FUNC "Bad format of line " + toString (lineNum));
+    const Real        len            = token2real (s, lenS);
+    const Real        errorDensity   = token2real (s, err_densityS);
+    const Real        normCriterion  = token2real (s, normCriterionS);  
+    const string_view deformationObj = token2view (s, deformationS);
+    const Real        deformation    = token2real (s, deformation_criterionS);
+    const string_view name           = token2view (s, "name");
+    const bool indiscernible = s. find (Leaf::non_discernible) != string_view::npos;
+    Steiner* parent = parents. empty () ? nullptr : parents. back ();
+    QC_IMPLY (parent, len >= 0.0);
+    DTNode* dtNode = nullptr;
+    if (idS. substr (0, 2) == "0x")
+    {
+      QC_ASSERT (! indiscernible);
+      QC_ASSERT (isNan (normCriterion));
+      auto steiner = new Steiner (*this, parent, len);
+      parents << steiner;
+      dtNode = steiner;
+    }
+    else
+    {
+      QC_ASSERT (parent);
+      auto leaf = new Leaf (*this, parent, len, string (idS));
+      leaf->discernible = /*DistTree_sp::variance_min ||*/ ! indiscernible;
+      leaf->normCriterion = normCriterion;
+      dtNode = leaf;
+    }
+    ASSERT (dtNode);
+    
+    dtNode->errorDensity = errorDensity;
+    if (! name. empty ())
+    {
+      QC_ASSERT (! dtNode->asLeaf ());
+      dtNode->name = name;
+    }
+    
+    QC_ASSERT (deformationObj. empty () == isNan (deformation));
+    if (! deformationObj. empty ())
+    {
+      const size_t sepPos = deformationObj. find (':');
+      QC_ASSERT (sepPos != string_view::npos);
+      QC_ASSERT (sepPos + 1 < deformationObj. size ());
+      QC_ASSERT (deformation >= 0.0);
+      ASSERT (! contains (node2deformationPair, dtNode));
+      node2deformationPair [dtNode] = move (DeformationPair { string (deformationObj. substr (0, sepPos))
+                                                            , string (deformationObj. substr (sepPos + 1))
+                                                            , deformation
+                                                            });
+    }
   }
-  
-  return true;
+  QC_ASSERT (root);
 }
 
 
@@ -4828,17 +5104,303 @@ namespace
         return false;  
       }
   };
-}
-
 
 
-void DistTree::neighborJoin ()
-{
-  ASSERT (isStar ());
-  ASSERT (name2leaf. size () >= 2);
 
-    
-  // DTNode::len: sum of dissimilarities from other objects (dissim_sum)
+  struct NeighborJoin
+  // Neighbor joining of the children of DistTree::root on the matrix of their dissimilarities
+  // The search of the minimum criterion: M. Simonsen, T. Mailund, C.N.S. Pedersen, Rapid Neighbour-Joining, 2008
+  // The result is the same as of the exhaustive search over NodePair's sorted by NodePair::strictlyLess()
+  // DTNode::len: dissim_sum
+  {
+    typedef  uint32_t  NodeId;
+    struct Cell
+    {
+      Real dissim {NaN};
+      NodeId id {0};
+      bool operator< (const Cell &other) const
+        { return dissim < other. dissim; }
+    };
+    struct Best
+    {
+      Real criterion {inf};
+      NodePair nodePair;
+      array<size_t,2> slots {{no_index, no_index}};
+        // Parallel to nodePair.nodes
+      void improve (Real criterion_arg,
+                    const DTNode* node1,
+                    const DTNode* node2,
+                    size_t slot1,
+                    size_t slot2,
+                    Real dissim)
+        { if (node2 < node1)
+          { swap (node1, node2);
+            swap (slot1, slot2);
+          }
+          if (criterion_arg > criterion)
+            return;
+          // Tie resolution as in the sorted NodePair's
+          if (   criterion_arg == criterion
+              && ! (   node1 < nodePair. nodes [0]
+                    || (node1 == nodePair. nodes [0] && node2 < nodePair. nodes [1])
+                   )
+             )
+            return;
+          criterion = criterion_arg;
+          nodePair. nodes [0] = node1;
+          nodePair. nodes [1] = node2;
+          nodePair. dissim = dissim;
+          slots [0] = slot1;
+          slots [1] = slot2;
+        }
+      void improve (const Best &other)
+        { if (other. nodePair. nodes [0])
+            improve (other. criterion, other. nodePair. nodes [0], other. nodePair. nodes [1], other. slots [0], other. slots [1], other. nodePair. dissim);
+        }
+    };
+
+    size_t n {0};
+      // # children of DistTree::root
+    size_t pairs {0};
+      // # non-missing dissimilarities between the current nodes
+  private:
+    // Index: slot
+    Vector<DTNode*> slot2node;
+      // nullptr <=> the slot is free
+    Vector<NodeId> slot2id;
+    Vector<Real> matrix;
+      // Size: slot2node.size()^2
+      // NaN <=> missing
+    vector<Vector<Cell>> rows;
+      // Cell::id: a node created before slot2id[slot]
+      // Sorted by Cell::dissim
+      // May contain joined nodes
+    // Index: NodeId
+    Vector<size_t> id2slot;
+      // no_index <=> the node is joined
+    size_t rows_n {0};
+      // n after the last removal of the joined nodes from rows
+    Best best;
+  public:
+
+
+    NeighborJoin (const DiGraph::Node* root,
+                  const Vector<NodePair> &leafPairs)
+      { ASSERT (root);
+        unordered_map<const DTNode*,size_t> node2slot;  node2slot. rehash (root->arcs [false]. size ());
+        for (const DiGraph::Arc* arc : root->arcs [false])
+        { DTNode* node = static_cast <DTNode*> (arc->node [false]);
+          node2slot [node] = slot2node. size ();
+          slot2id << (NodeId) slot2node. size ();
+          id2slot << slot2node. size ();
+          slot2node << node;
+        }
+        n = slot2node. size ();
+        rows_n = n;
+        matrix. resize (n * n, NaN);
+        for (const NodePair& leafPair : leafPairs)
+        { const size_t slot1 = node2slot [leafPair. nodes [0]];
+          const size_t slot2 = node2slot [leafPair. nodes [1]];
+          ASSERT (isNan (matrix [slot1 * n + slot2]));
+          matrix [slot1 * n + slot2] = leafPair. dissim;
+          matrix [slot2 * n + slot1] = leafPair. dissim;
+          pairs++;
+        }
+        rows. resize (n);
+        vector<Notype> notypes;
+        arrayThreads (true, initRows, n, notypes, ref (*this));
+      }
+  private:
+    static void initRows (size_t from,
+                          size_t to,
+                          Notype /*&res*/,
+                          NeighborJoin &nj)
+      { const size_t slots = nj. slot2node. size ();
+        FOR_START (size_t, slot, from, to)
+        { Vector<Cell>& row = nj. rows [slot];
+          FOR (size_t, other, slot)
+          { const Real dissim = nj. matrix [slot * slots + other];
+            if (! isNan (dissim))
+              row << Cell {dissim, nj. slot2id [other]};
+          }
+          row. shrink_to_fit ();
+          std::sort (row. begin (), row. end ());
+        }
+      }
+    static void findBest_ (size_t from,
+                           size_t to,
+                           Best &best,
+                           const NeighborJoin &nj,
+                           Real len_max)
+      { const Real n_2 = (Real) (nj. n - 2);
+        FOR_START (size_t, slot, from, to)
+        { const DTNode* node = nj. slot2node [slot];
+          if (! node)
+            continue;
+          const Real len = node->len;
+          const Real criterion_bound = (len + len_max) / n_2;
+          for (const Cell& cell : nj. rows [slot])
+          { if (cell. dissim - criterion_bound > best. criterion)
+              break;
+            const size_t other = nj. id2slot [cell. id];
+            if (other == no_index)
+              continue;
+            const DTNode* otherNode = nj. slot2node [other];
+            best. improve (cell. dissim - (len + otherNode->len) / n_2, node, otherNode, slot, other, cell. dissim);
+          }
+        }
+      }
+    static void removeJoined (size_t from,
+                              size_t to,
+                              Notype /*&res*/,
+                              NeighborJoin &nj)
+      { FOR_START (size_t, slot, from, to)
+          if (nj. slot2node [slot])
+          { Vector<Cell>& row = nj. rows [slot];
+            row. filterValue ([&nj] (const Cell &cell) { return nj. id2slot [cell. id] == no_index; });
+          }
+      }
+  public:
+
+
+    void print (ostream &os) const
+      { os << endl << "Nodes and sum:" << endl;
+        for (const DTNode* node : slot2node)
+          if (node)
+            os << node->getLcaName () << ": " << node->len << endl;
+        os << endl << "Pairs:" << endl;
+        const size_t slots = slot2node. size ();
+        FFOR (size_t, slot1, slots)
+          if (slot2node [slot1])
+            FOR (size_t, slot2, slot1)
+              if (slot2node [slot2] && ! isNan (matrix [slot1 * slots + slot2]))
+              { NodePair leafPair;
+                leafPair. nodes [0] = slot2node [slot1];
+                leafPair. nodes [1] = slot2node [slot2];
+                leafPair. orderNodes ();
+                leafPair. dissim = matrix [slot1 * slots + slot2];
+                leafPair. print (os);
+              }
+      }
+    const NodePair& findBest ()
+      // Return: the pair of nodes to join
+      // Requires: pairs > 1
+      { ASSERT (pairs > 1);
+        ASSERT (n > 2);
+        if (rows_n >= 2 * n)  // PAR
+        { vector<Notype> notypes;
+          arrayThreads (true, removeJoined, slot2node. size (), notypes, ref (*this));
+          rows_n = n;
+        }
+        Real len_max = - inf;
+        for (const DTNode* node : slot2node)
+          if (node)
+            maximize (len_max, node->len);
+        best = Best ();
+        if (n >= 1000)  // PAR
+        { vector<Best> results;
+          arrayThreads (true, findBest_, slot2node. size (), results, cref (*this), len_max);
+          for (const Best& res : results)
+            best. improve (res);
+        }
+        else
+          findBest_ (0, slot2node. size (), best, *this, len_max);
+        ASSERT (best. nodePair. nodes [0]);
+        return best. nodePair;
+      }
+    void join (DTNode* newNode)
+      // Update: DTNode::len of the nodes having a dissimilarity with the best pair
+      // Requires: after findBest(); nodes of the best pair have the arc lengths
+      { ASSERT (newNode);
+        const size_t slots = slot2node. size ();
+        const array<const DTNode*,2>& nodes = best. nodePair. nodes;
+        const size_t slot_new = best. slots [0];
+        const size_t slot_del = best. slots [1];
+        Vector<Cell>& row_new = rows [slot_new];
+        row_new. clear ();
+        FFOR (size_t, slot, slots)
+        { DTNode* node = slot2node [slot];
+          if (   ! node
+              || slot == slot_new
+              || slot == slot_del
+             )
+            continue;
+          array<Real,2> dissims {{matrix [best. slots [0] * slots + slot], matrix [best. slots [1] * slots + slot]}};
+          // Order of the NodePair's {nodes[i],node}
+          const auto key = [node] (const DTNode* other) 
+                             { return other < node ? make_pair (other, (const DTNode*) node) : make_pair ((const DTNode*) node, other); };
+          const bool first = key (nodes [1]) < key (nodes [0]);
+          for (const bool i : {first, ! first})
+          { Real& dissim = dissims [i];
+            if (isNan (dissim))
+              continue;
+            node->len -= dissim;
+            dissim -= nodes [i] -> len;
+            maximize (dissim, 0.0);
+            node->len += dissim / 2.0;
+          }
+          Real dissim_new = NaN;
+          if (isNan (dissims [0]))
+            dissim_new = dissims [1];
+          else if (isNan (dissims [1]))
+            dissim_new = dissims [0];
+          else
+          { dissim_new = (dissims [0] + dissims [1]) / 2.0;
+            ASSERT (pairs);
+            pairs--;
+          }
+          matrix [slot_new * slots + slot] = dissim_new;
+          matrix [slot * slots + slot_new] = dissim_new;
+          if (! isNan (dissim_new))
+            row_new << Cell {dissim_new, slot2id [slot]};
+        }
+        std::sort (row_new. begin (), row_new. end ());
+        ASSERT (pairs);
+        pairs--;
+
+        id2slot [slot2id [slot_new]] = no_index;
+        id2slot [slot2id [slot_del]] = no_index;
+        slot2id [slot_new] = (NodeId) id2slot. size ();
+        id2slot << slot_new;
+        slot2node [slot_new] = newNode;
+        slot2node [slot_del] = nullptr;
+        rows [slot_del]. clear ();
+        rows [slot_del]. shrink_to_fit ();
+
+        ASSERT (n > 2);
+        n--;
+      }
+    NodePair getLast () const
+      // Requires: pairs == 1
+      { ASSERT (pairs == 1);
+        FFOR (size_t, slot, slot2node. size ())
+          if (slot2node [slot])
+            for (const Cell& cell : rows [slot])
+            { const size_t other = id2slot [cell. id];
+              if (other == no_index)
+                continue;
+              NodePair leafPair;
+              leafPair. nodes [0] = slot2node [slot];
+              leafPair. nodes [1] = slot2node [other];
+              leafPair. orderNodes ();
+              leafPair. dissim = cell. dissim;
+              return leafPair;
+            }
+        NEVER_CALL;
+        return NodePair ();
+      }
+  };
+}
+
+
+
+void DistTree::neighborJoin ()
+{
+  ASSERT (isStar ());
+  ASSERT (name2leaf. size () >= 2);
+
+    
+  // DTNode::len: sum of dissimilarities from other objects (dissim_sum)
 
   size_t n = 0;
   for (DiGraph::Arc* arc : root->arcs [false])
@@ -4903,116 +5465,68 @@ void DistTree::neighborJoin ()
     return;
   
 
+  // Remove duplicate NodePair 
+  leafPairs. sort (NodePair::strictlyLess);
+  leafPairs. filterIndex ([&leafPairs] (size_t i) 
+                               { return i && leafPairs [i - 1]. merge (leafPairs [i]); }
+                            );    
+  for (NodePair& leafPair : leafPairs)
+    for (const bool first : {false, true})
+      var_cast (leafPair. nodes [first]) -> len += leafPair. dissim;
+
+  NeighborJoin nj (root, leafPairs);
+  ASSERT (nj. n == n);
+  leafPairs. clear ();
+  leafPairs. shrink_to_fit ();
+
   Progress prog (n - 1);
-  NodePair leafPair_best;
-  for (;;)
+  while (nj. pairs > 1)
   {
     prog ();
     
-    // Remove duplicate NodePair 
-    leafPairs. sort (NodePair::strictlyLess);
-    leafPairs. filterIndex ([&leafPairs, &leafPair_best] (size_t i) 
-                                 { return    leafPairs [i] == leafPair_best 
-                                          || (i && leafPairs [i - 1]. merge (leafPairs [i]));
-                                 }
-                              );    
-
-    if (leafPairs. size () == 1)
-      break;
-    ASSERT (n > 2);
-    
-    if (! leafPair_best. nodes [0])  // First iteration
-      for (NodePair& leafPair : leafPairs)
-        for (const bool first : {false, true})
-          var_cast (leafPair. nodes [first]) -> len += leafPair. dissim;
-          
     if (verbose (-2))  
+      nj. print (cout);
+      
+    // leafPair_best
+    const NodePair& leafPair_best = nj. findBest ();
+    if (verbose (-1))
     {
-      cout << endl << "Nodes and sum:" << endl;
-      for (const DiGraph::Arc* arc : root->arcs [false])
-      {
-        const DTNode* node = static_cast <const DTNode*> (arc->node [false]);
-        cout << node->getLcaName () << ": " << node->len << endl;
-      }     
-      cout << endl << "Pairs:" << endl;
-      for (const NodePair& leafPair : leafPairs)
-        leafPair. print (cout);
+      cout << endl << "Best: ";
+      leafPair_best. print (cout);
     }
-      
-      
+    const Real dissim_min = leafPair_best. getParentDissim (nj. n);
+  //ASSERT (dissim_min >= 0);
+    ASSERT (! isNan (dissim_min));
+    ASSERT (dissim_min <= leafPair_best. dissim);
+    
     Steiner* newNode = nullptr;
     {
-      // leafPair_best
-      Real dissim_min = NaN;
-      {
-        Real criterion = inf;
-        size_t i_best = no_index;
-        FFOR (size_t, i, leafPairs. size ())
-          // P (criterion1 < criterion2) ??
-          if (minimize (criterion, leafPairs [i]. getCriterion (n)))            
-            i_best = i;
-        ASSERT (i_best != no_index);
-        leafPair_best = leafPairs [i_best];
-        if (verbose (-1))
-        {
-          cout << endl << "Best: ";
-          leafPair_best. print (cout);
-        }
-        dissim_min = leafPair_best. getParentDissim (n);
-      }
-    //ASSERT (dissim_min >= 0);
-      ASSERT (! isNan (dissim_min));
-      ASSERT (dissim_min <= leafPair_best. dissim);
-      {
-        DTNode* a = var_cast (leafPair_best. nodes [0]);
-        DTNode* b = var_cast (leafPair_best. nodes [1]);
-        const Real dissim_sum_a = a->len;
-        const Real dissim_sum_b = b->len;
-        a->len = max (0.0, dissim_min);
-        b->len = max (0.0, leafPair_best. dissim - dissim_min);
-        // dissim_sum
-        const Real dissim_sum = (  dissim_sum_a - leafPair_best. dissim - (Real) (n - 2) * a->len
-                                 + dissim_sum_b - leafPair_best. dissim - (Real) (n - 2) * b->len
-                                ) / 2;
-        newNode = new Steiner (*this, const_static_cast <Steiner*> (leafPair_best. nodes [0] -> getParent ()), dissim_sum);
-        a->setParent (newNode);
-        b->setParent (newNode);
-        if (verbose (-1))
-          cout << "New: " << newNode->getLcaName () << " " << a->len << " " << b->len << " " << newNode->len << endl;
-      }
+      DTNode* a = var_cast (leafPair_best. nodes [0]);
+      DTNode* b = var_cast (leafPair_best. nodes [1]);
+      const Real dissim_sum_a = a->len;
+      const Real dissim_sum_b = b->len;
+      a->len = max (0.0, dissim_min);
+      b->len = max (0.0, leafPair_best. dissim - dissim_min);
+      // dissim_sum
+      const Real dissim_sum = (  dissim_sum_a - leafPair_best. dissim - (Real) (nj. n - 2) * a->len
+                               + dissim_sum_b - leafPair_best. dissim - (Real) (nj. n - 2) * b->len
+                              ) / 2;
+      newNode = new Steiner (*this, const_static_cast <Steiner*> (leafPair_best. nodes [0] -> getParent ()), dissim_sum);
+      a->setParent (newNode);
+      b->setParent (newNode);
+      if (verbose (-1))
+        cout << "New: " << newNode->getLcaName () << " " << a->len << " " << b->len << " " << newNode->len << endl;
     }
     ASSERT (newNode);
     
-    // leafPairs
-    for (NodePair& leafPair : leafPairs)
-      if (! (leafPair == leafPair_best))
-        for (const bool first : {false, true})
-        {
-          bool found = false;
-          for (const bool best_first : {false, true})
-            if (leafPair. nodes [first] == leafPair_best. nodes [best_first])
-            {
-              leafPair. nodes [first] = newNode;
-              var_cast (leafPair. nodes [! first]) -> len -= leafPair. dissim;
-              leafPair. dissim -= leafPair_best. nodes [best_first] -> len;
-              maximize (leafPair. dissim, 0.0);
-              var_cast (leafPair. nodes [! first]) -> len += leafPair. dissim / 2.0;  
-                // Done twice for leafPair.nodes[!first]
-              found = true;
-            }
-          if (found)
-            leafPair. orderNodes ();
-          ASSERT (! leafPair. same ());
-        }
-
-    n--;
+    nj. join (newNode);
   }
-  ASSERT (leafPairs. size () == 1);
+  n = nj. n;
   ASSERT (n >= 2); 
   IMPLY (! missing, n == 2);
   
   
-  NodePair& leafPair = leafPairs [0];
+  const NodePair leafPair (nj. getLast ());
   ASSERT (! leafPair. same ());
   for (const bool first : {false, true})  
   {
@@ -5128,32 +5642,85 @@ void DistTree::loadDissimPrepare (size_t pairs_max)
 
 
 
-Vector<DissimLine> DistTree::getDissimLines (const string& fName,
-                                             size_t reserveSize) const
+DissimLines DistTree::getDissimLines (const string& fName) const
 {
-  Vector<DissimLine> dissimLines;  dissimLines. reserve (reserveSize);
+  DissimLines dissimLines;
+  dissimLines. mf. reset (new MappedFile (fName));
+  const string_view text (dissimLines. mf->getView ());
+  if (text. empty ())
+    throw runtime_error (FUNC "Empty " + fName);
+  
+  const LeafNameIndex index (name2leaf);
+
+  vector<DissimChunk> chunks;
   {
+    section ("Loading " + fName, true);
+    // Chunks of whole lines
+    Vector<size_t> bounds;  bounds. reserve (threads_max + 1);
+    bounds << 0;
+    const size_t chunk_min = 1024 * 1024;  // PAR
+    const size_t chunks_n = max<size_t> (1, min<size_t> (threads_max, text. size () / chunk_min));
+    FOR_START (size_t, i, 1, chunks_n)
     {
-      section ("Loading " + fName, true);
-      LineInput f (fName, dissim_progress);  
-      while (f. nextLine ())
+      size_t pos = max (bounds. back (), text. size () / chunks_n * i);
+      if (pos && text [pos - 1] != '\n')
       {
-        DissimLine dl (f. line, f. lineNum);
-        if (DM_sp::finite (dl. dissim))
-        {
-          dissimLines << move (dl);
-          ASSERT (dl. name1. empty ());
-        }
+        pos = text. find ('\n', pos);
+        pos = pos == string_view::npos ? text. size () : pos + 1;
       }
-      if (! f. lineNum)
-        throw runtime_error (FUNC "Empty " + fName);
+      bounds << pos;
     }
-    section ("Sorting dissimilarities", true);
-    dissimLines. sort ();
-    dissimLines. uniq ();
+    bounds << text. size ();
+    arrayThreads (true, parseDissimLines, chunks_n, chunks, text, cref (bounds), cref (index));
+  }
+  for (const DissimChunk& chunk : chunks)
+    if (chunk. errorPos != no_index)
+      throw runtime_error (fName + ": Line " + to_string (std::count (text. begin (), text. begin () + (long) chunk. errorPos, '\n') + 1) + ": " + chunk. error);
+
+  section ("Sorting dissimilarities", true);
+  {
+    size_t size = 0;
+    for (const DissimChunk& chunk : chunks)
+      size += chunk. dissimLines. size ();
+    dissimLines. reserve (size);
+  }
+  Vector<size_t> runs;  runs. reserve (chunks. size () + 1);
+  runs << 0;
+  for (DissimChunk& chunk : chunks)
+  {
+    dissimLines. insert (dissimLines. end (), chunk. dissimLines. begin (), chunk. dissimLines. end ());
+    chunk. dissimLines = Vector<DissimLine> ();
+    runs << dissimLines. size ();
+  }
+  while (runs. size () > 2)
+  {
+    vector<Notype> notypes;
+    arrayThreads (true, mergeDissimLines, (runs. size () - 1) / 2, notypes, ref (dissimLines), cref (runs));
+    Vector<size_t> runs_new;  runs_new. reserve (runs. size () / 2 + 1);
+    for (size_t i = 0; i < runs. size (); i += 2)
+      runs_new << runs [i];
+    if (runs_new. back () != runs. back ())
+      runs_new << runs. back ();
+    runs = move (runs_new);
   }
-  vector<Notype> notypes;
-  arrayThreads (true, processDissimLine, dissimLines. size (), notypes, ref (dissimLines), cref (name2leaf));
+  
+  // Unique, first in the file
+  size_t j = 0;
+  FFOR (size_t, i, dissimLines. size ())
+  {
+    const DissimLine& dl = dissimLines [i];
+    if (j && dl == dissimLines [j - 1])
+      continue;
+    if (dl. leaf1)
+      dl. leaf1->badCriterion = -1.0;  // temporary
+    if (dl. leaf2)
+      dl. leaf2->badCriterion = -1.0;  // temporary
+    if (i != j)
+      dissimLines [j] = dl;
+    j++;
+  }
+  dissimLines. resize (j);
+  dissimLines. searchSorted = true;
   
   return dissimLines;
 }
@@ -6586,6 +7153,7 @@ size_t DistTree::optimizeLenNode ()
   const Real absCriterion_old1 = absCriterion;
 #endif
   Tree::LcaBuffer buf;
+  static thread_local BinaryRegression lr;
   for (const Star& star : stars)
   {
     if (star. liveNodes () <= 2)  
@@ -6608,78 +7176,30 @@ size_t DistTree::optimizeLenNode ()
     subgraph. dissimNums2subPaths ();
     subgraph. qc ();    
   
-    Dataset starDs;
-    starDs. objs. reserve (subgraph. subPaths. size ());
-    auto targetAttr = new RealAttr1 ("target", starDs);
-    FFOR (size_t, objNum, subgraph. subPaths. size ())
-      starDs. appendObj ();
-    Space1<NumAttr1> sp (starDs, false);  sp. reserve (star. arcNodes. size ());
-    FFOR (size_t, i, star. arcNodes. size ())
-    {
-      auto attr = new ExtBoolAttr1 ("X" + toString (i + 1), starDs);;
-      sp << attr;
-      attr->setAll (efalse);
-    }
-    FFOR (size_t, objNum, subgraph. subPaths. size ())
+    lr. reset (arcNodes. size ());
+    for (const SubPath& subPath : subgraph. subPaths)
     {
-      const SubPath& subPath = subgraph. subPaths [objNum];
-      const size_t wholeObjNum = subPath. dissimNum;
+      const Dissim& dissim = dissims [subPath. dissimNum];
+      lr. addRow (dissim. target - subPath. dist_hat_tails, dissim. mult);
       const VectorPtr<TreeNode>& path = subgraph. getPath (subPath, buf);
-      FFOR (size_t, i, star. arcNodes. size ())
-        if (path. contains (static_cast <const TreeNode*> (star. arcNodes [i])))
-      //if (star. arcNodes [i] -> pathDissimNums. containsFast (wholeObjNum))  // needs sorting ??
-          (* const_static_cast <ExtBoolAttr1*> (sp [i])) [objNum] = etrue;        
-      var_cast (starDs. objs [objNum]) -> mult = dissims [wholeObjNum]. mult; 
-      (*targetAttr) [objNum] = dissims [wholeObjNum]. target - subPath. dist_hat_tails;
-    }
-    starDs. qc ();
-    sp. qc ();        
-    const Sample sample (starDs);
-    
-    L2LinearNumPrediction lr (sample, sp, *targetAttr);
-    ASSERT (lr. beta. size () == arcNodes. size ());
-    FFOR (size_t, attrNum, lr. beta. size ())
-      lr. beta [attrNum] = static_cast <const DTNode*> (arcNodes [attrNum]) -> len;
-  #if 0
-    // For "!!optimizeLenNode1"
-    const auto beta_init (lr. beta);
-    lr. setAbsCriterion ();
-    const auto absCriterion_lr_init = lr. absCriterion;
-  #endif
-    const bool solved = lr. solveUnconstrainedFast (nullptr, true, 10, 0.01);  // PAR
-    lr. qc ();
+      FFOR (size_t, i, arcNodes. size ())
+        if (path. contains (static_cast <const TreeNode*> (arcNodes [i])))
+      //if (star. arcNodes [i] -> pathDissimNums. containsFast (subPath. dissimNum))  // needs sorting ??
+          lr. addPredictor (i);
+    }
+    FFOR (size_t, i, arcNodes. size ())
+      lr. beta [i] = static_cast <const DTNode*> (arcNodes [i]) -> len;
+    const bool solved = lr. solveUnconstrainedFast (10, 0.01);  // PAR
   
     // DTNode::len
     if (solved)
     {
-      FFOR (size_t, attrNum, arcNodes. size ())
-        const_static_cast <DTNode*> (arcNodes [attrNum]) -> len = lr. beta [attrNum];
+      FFOR (size_t, i, arcNodes. size ())
+        const_static_cast <DTNode*> (arcNodes [i]) -> len = lr. beta [i];
       const Real absCriterion_old = absCriterion;  
       subgraph. subPaths2tree ();
       if (! leRealRel (absCriterion, absCriterion_old, 1e-3))  // PAR 
         BAD_CRITERION (optimizeLenNode);
-    #if 0
-      { 
-        cout << "!!optimizeLenNode1" << endl;  
-        PRINT (absCriterion_lr_init);
-        PRINT (lr. absCriterion);
-        PRINT (absCriterion_old);
-        PRINT (absCriterion);
-        PRINT (subDepth);
-        PRINT (star. center);
-        PRINT (star. center->getParent ());
-        cout << "beta_init:" << endl;
-        FFOR (size_t, attrNum, arcNodes. size ())
-          PRINT (beta_init [attrNum]);
-        cout << "beta result:" << endl;
-        FFOR (size_t, attrNum, arcNodes. size ())
-          PRINT (lr. beta [attrNum]);
-        OFStream ofs ("optimizeLenNode.dm");
-        starDs. saveText (ofs);
-        // 2 arcs of an equal length, and all the other arcs have a positive length close to 0: why ??
-        ERROR;
-      }
-    #endif
       prog (absCriterion2str ()); 
     }
   }
@@ -6873,11 +7393,16 @@ void DistTree::optimizeReinsert ()
   vector<VectorPtr<Change>> results;
   arrayThreads (false, reinsert_thread, nodeVec. size (), results, cref (*this), cref (nodeVec));
 
-  VectorOwn<Change> changes;  changes. reserve (256);  // PAR 
+  // Per-thread buffers are concatenated, sorting is done by optimizeLargeSubgraphs() for each region
+  VectorOwn<Change> changes;  
+  {
+    size_t n = 0;
+    for (const VectorPtr<Change>& threadChanges : results)
+      n += threadChanges. size ();
+    changes. reserve (n);
+  }
   for (const VectorPtr<Change>& threadChanges : results)
     changes << threadChanges;
-
-  changes. sort (Change::longer); 
 //PRINT (changes. size ());  
 
   optimizeLargeSubgraphs (& changes);
@@ -6979,7 +7504,7 @@ const Change* DistTree::getBestChange (const DTNode* from)
 
 
 
-bool DistTree::applyChanges (const VectorOwn<Change> &changes,
+bool DistTree::applyChanges (const VectorPtr<Change> &changes,
                              bool byNewLeaf)
 { 
   ASSERT (toDelete. empty ());
@@ -7153,10 +7678,19 @@ void DistTree::tryChange (Change* ch,
 namespace
 {
 
+VectorPtr<Change> sortLonger (const VectorPtr<Change> &changes)
+{
+  VectorPtr<Change> sorted (changes);
+  sorted. sort (Change::longer);
+  return sorted;
+}
+
+
+
 void processLargeImage_thread (Image &image,
                                const Steiner* subTreeRoot,
                                const VectorPtr<Tree::TreeNode> possibleBoundary,  // needs a copy
-                               const VectorOwn<Change>* changes)
+                               const VectorPtr<Change>* changes)
 { 
   image. processLarge (subTreeRoot, possibleBoundary, changes); 
 }
@@ -7165,7 +7699,7 @@ void processLargeImage_thread (Image &image,
                         
 
 
-void DistTree::optimizeLargeSubgraphs (const VectorOwn<Change>* changes)
+void DistTree::optimizeLargeSubgraphs (const VectorPtr<Change>* changes)
 {
   ASSERT (threads_max);
   
@@ -7184,7 +7718,7 @@ void DistTree::optimizeLargeSubgraphs (const VectorOwn<Change>* changes)
   if (! largeParts)  
   {
     if (changes)
-      applyChanges (*changes, true); 
+      applyChanges (sortLonger (*changes), true); 
     else
       optimizeSmallSubgraphs (areaRadius_std);
     return;
@@ -7267,7 +7801,7 @@ void DistTree::optimizeLargeSubgraphs (const VectorOwn<Change>* changes)
     if (cuts. empty ()) 
     {
       if (changes)
-        applyChanges (*changes, true); 
+        applyChanges (sortLonger (*changes), true); 
       else
         optimizeSmallSubgraphs (areaRadius_std);
       return;
@@ -7288,6 +7822,46 @@ void DistTree::optimizeLargeSubgraphs (const VectorOwn<Change>* changes)
 //qc ();  // Breaks due to transients
 
 
+  // Disjoint regions of the Image's: boundary[i] -> i, root -> boundary.size()
+  // Change::from is not transient and belongs to one region
+  Vector<VectorPtr<Change>> regionChanges;
+  if (changes)
+  {
+    regionChanges. resize (boundary. size () + 1);
+    unordered_map<const TreeNode*, size_t> node2region;  node2region. rehash (nodes. size ());
+    node2region [root] = boundary. size ();
+    FFOR (size_t, i, boundary. size ())
+      node2region [boundary [i]] = i;
+    VectorPtr<TreeNode> path;
+    for (const Change* change : *changes)
+    {
+      ASSERT (change);
+      ASSERT (! change->from->isTransient ());
+      path. clear ();
+      const TreeNode* node = change->from;
+      size_t region = no_index;
+      for (;;)
+      {
+        ASSERT (node);
+        const auto it = node2region. find (node);
+        if (it != node2region. end ())
+        {
+          region = it->second;
+          break;
+        }
+        path << node;
+        node = node->getParent ();
+      }
+      ASSERT (region < regionChanges. size ());
+      for (const TreeNode* pathNode : path)
+        node2region [pathNode] = region;
+      regionChanges [region] << change;
+    }
+  }
+  const auto getRegionChanges = [changes, &regionChanges] (size_t region) 
+                                  { return changes ? & regionChanges [region] : nullptr; };
+
+
   bool failed = false;
   {
     VectorOwn<Image> images;  images. reserve (boundary. size ());
@@ -7298,26 +7872,27 @@ void DistTree::optimizeLargeSubgraphs (const VectorOwn<Change>* changes)
         th. reset (new Threads (boundary. size ()));
       VectorPtr<Tree::TreeNode> possibleBoundary;  possibleBoundary. reserve (boundary. size ());
       Progress prog (boundary. size () + 1, ! threadsUsed);
-      for (const Steiner* cut : boundary)
+      FFOR (size_t, i, boundary. size ())
       {
         prog ();
+        const Steiner* cut = boundary [i];
         ASSERT (cut);
         ASSERT (cut->isTransient ());
         auto image = new Image (*this);
         images << image;
         ASSERT (cut->isTransient ());
         if (th. get ())
-          *th << thread (processLargeImage_thread, ref (*image), cut, possibleBoundary, changes);
+          *th << thread (processLargeImage_thread, ref (*image), cut, possibleBoundary, getRegionChanges (i));
             // Use functional ??
         else
-          image->processLarge (cut, possibleBoundary, changes);
+          image->processLarge (cut, possibleBoundary, getRegionChanges (i));
         possibleBoundary << cut;
       }   
       // Top subgraph
       prog ();
       {
         Unverbose unv;
-        mainImage. processLarge (nullptr, possibleBoundary, changes);
+        mainImage. processLarge (nullptr, possibleBoundary, getRegionChanges (boundary. size ()));
       }
     }
     // Image::apply() can be done by Threads if it is done in the order of cuts and for sibling subtrees ??!
@@ -8145,110 +8720,81 @@ Real DistTree::reroot (bool topological)
 
 
 
-Real DistTree::getMeanResidual () const
+void DistTree::DissimStat::add (const Dissim &dissim)
 {
-  ASSERT (optimizable ());
-
-  Real s = 0.0;
-  for (const Dissim& dissim : dissims)
-    if (dissim. validMult ())
-      s += dissim. mult * dissim. getResidual ();
-    ASSERT (! isNan (s));
-  
-  return s / mult_sum;
-}
-
-
-
-Real DistTree::getMinLeafLen () const
-{
-  Real len_min = inf;
-  for (DiGraph::Node* node : nodes)
+  ASSERT (dissim. validMult ());
+  n++;
+  if (dissim. indiscernible ())
   {
-    const DTNode* dtNode = static_cast <DTNode*> (node);
-    if (   (  dtNode->isLeaf () && ! dtNode->inDiscernible ())
-        || (! dtNode->isLeaf () && ! dtNode->childrenDiscernible ())
-       )
-      minimize (len_min, dtNode->len);
+    ASSERT (! dissim. prediction);
+    unoptimizable += dissim. mult * sqr (dissim. target);
   }
-  return len_min;
+  const Real res = dissim. getResidual ();
+  residual. add (res, dissim. mult);
+  sqrResidualCorr. add (dissim. target, sqr (res));
+  deformation << dissim. getDeformation ();
 }
 
 
 
-Real DistTree::getSqrResidualCorr () const
+void DistTree::DissimStat::add (const DissimStat &other)
 {
-  ASSERT (optimizable ());
-
-  Correlation corr;
-  for (const Dissim& dissim : dissims)
-    if (dissim. validMult ())
-      corr. add (dissim. target, sqr (dissim. getResidual ()));
-  
-  return corr. getCorrelation ();
-}
-  
-  
-
-Real DistTree::getUnoptimizable () const
-{
-  ASSERT (optimizable ());
-
-  Real epsilon2_0 = 0.0;
-  for (const Dissim& dissim : dissims)
-    if (   dissim. validMult ()
-        && dissim. indiscernible ()
-       )
-    {
-      ASSERT (! dissim. prediction);
-      epsilon2_0 += dissim. mult * sqr (dissim. target);
-    }
-
-  return epsilon2_0;
+  n += other. n;
+  unoptimizable += other. unoptimizable;
+  residual. add (other. residual);
+  sqrResidualCorr. add (other. sqrResidualCorr);
+  deformation << other. deformation;
 }
 
 
 
 namespace
 {
-
-void setErrorDensity_array (size_t from,
-                            size_t to,
-                            Notype /*&res*/,
-                            const VectorPtr<DiGraph::Node> &nodeVec,
-                            Real c)
+  
+void getDissimStat_array (size_t from,
+                          size_t to,
+                          DistTree::DissimStat &res,
+                          const Vector<Dissim> &dissims)
 {
   FOR_START (size_t, i, from, to)
   {
-    DTNode* dtNode = const_static_cast <DTNode*> (nodeVec [i]);
-    dtNode->setErrorDensity (c);
+    const Dissim& dissim = dissims [i];
+    if (dissim. validMult ())
+      res. add (dissim);
   }
 }
-
+  
 }
 
 
 
-void DistTree::setErrorDensities () 
+DistTree::DissimStat DistTree::getDissimStat () const
 {
   ASSERT (optimizable ());
+  
+  vector<DissimStat> results;
+  arrayThreads (true, getDissimStat_array, dissims. size (), results, cref (dissims));
+  
+  DissimStat ds;
+  for (const DissimStat& res : results)
+    ds. add (res);
+  return ds;
+}
 
-  size_t n = 0;
-  for (const Dissim& dissim : dissims)
-    if (dissim. validMult ())
-      n++;
-  ASSERT (n);
-
-  const Real c = absCriterion / (Real) n;
-  ASSERT (c >= 0.0);
 
-  VectorPtr<DiGraph::Node> nodeVec;  nodeVec. reserve (nodes. size ());
-  for (DiGraph::Node* node : nodes)  
-    nodeVec << node;
-  nodeVec. randomOrder ();
 
-  vector<Notype> notypes;
-  arrayThreads (false, setErrorDensity_array, nodeVec. size (), notypes, cref (nodeVec), c);
+Real DistTree::getMinLeafLen () const
+{
+  Real len_min = inf;
+  for (DiGraph::Node* node : nodes)
+  {
+    const DTNode* dtNode = static_cast <DTNode*> (node);
+    if (   (  dtNode->isLeaf () && ! dtNode->inDiscernible ())
+        || (! dtNode->isLeaf () && ! dtNode->childrenDiscernible ())
+       )
+      minimize (len_min, dtNode->len);
+  }
+  return len_min;
 }
 
 
@@ -8331,20 +8877,75 @@ void DistTree::setNodeMaxDeformationDissimNum ()
 
 
 
-Real DistTree::getDeformation_mean () const
+namespace
+{
+
+void setNodeErrors_array (size_t from,
+                          size_t to,
+                          Notype /*&res*/,
+                          const VectorPtr<DiGraph::Node> &nodeVec,
+                          const DistTree &tree,
+                          Real absCriterion_ave)
+// Output: DTNode::maxDeformationDissimNum, DTNode::errorDensity, Leaf::normCriterion
+{
+  FOR_START (size_t, i, from, to)
+  {
+    DTNode* dtNode = const_static_cast <DTNode*> (nodeVec [i]);
+    dtNode->maxDeformationDissimNum = dissims_max;
+    Real deformation_max = 0.0;
+    Real criterion_sum = 0.0;
+    Real a = 0.0;
+    Real b = 0.0;
+    for (const uint dissimNum : dtNode->pathDissimNums)
+    {
+      const Dissim& dissim = tree. dissims [dissimNum];
+      if (! dissim. validMult ())
+        continue;
+      if (maximize (deformation_max, dissim. getDeformation ()))
+        dtNode->maxDeformationDissimNum = dissimNum;
+      const Real criterion = dissim. getAbsCriterion ();
+      ASSERT (criterion >= 0.0);
+      ASSERT (criterion < inf);
+      criterion_sum += criterion;
+      ASSERT (dissim. prediction >= 0.0);
+      if (! dissim. prediction)
+        continue;
+      a += (criterion / absCriterion_ave - 1.0) / dissim. prediction;
+      b += 1.0 / sqr (dissim. prediction);
+    }
+    dtNode->errorDensity = a / sqrt (2.0 * b);
+    if (const Leaf* leaf = dtNode->asLeaf ())
+    {
+      const Real n = (Real) leaf->pathDissimNums. size ();
+      var_cast (leaf) -> normCriterion = (criterion_sum / absCriterion_ave - n) / sqrt (2.0 * n);
+    }
+  }
+}
+
+}
+
+
+
+void DistTree::setNodeErrors ()
 {
   ASSERT (optimizable ());
 
-  Real deformation_mean = NaN;
-  
-  MeanVar mv;
+  size_t n = 0;
   for (const Dissim& dissim : dissims)
     if (dissim. validMult ())
-      mv << dissim. getDeformation ();
-  deformation_mean = mv. getMean ();
-  ASSERT (deformation_mean >= 0.0);
-  
-  return deformation_mean;
+      n++;
+  ASSERT (n);
+
+  const Real c = absCriterion / (Real) n;
+  ASSERT (c >= 0.0);
+
+  VectorPtr<DiGraph::Node> nodeVec;  nodeVec. reserve (nodes. size ());
+  for (DiGraph::Node* node : nodes)  
+    nodeVec << node;
+  nodeVec. randomOrder ();
+
+  vector<Notype> notypes;
+  arrayThreads (false, setNodeErrors_array, nodeVec. size (), notypes, cref (nodeVec), cref (*this), c);
 }
 
 
@@ -8396,18 +8997,20 @@ bool leafRelCriterionStrictlyGreater (const Leaf* a,
 
 
 
-VectorPtr<Leaf> DistTree::findCriterionOutliers (const Dataset &leafErrorDs,
-                                                 Real outlier_EValue_max,
+VectorPtr<Leaf> DistTree::findCriterionOutliers (Real outlier_EValue_max,
                                                  Real &outlier_min_excl) const
 {
-  const Attr* attr = leafErrorDs. name2attr ("leaf_error");
-  ASSERT (attr);
-  const PositiveAttr1* criterionAttr = attr->asPositiveAttr1 ();
-  ASSERT (criterionAttr);
-  
-  Normal distr;  
-  const Sample sample (leafErrorDs);
-  outlier_min_excl = criterionAttr->locScaleDistr2outlier (sample, distr, true, outlier_EValue_max);
+  {
+    Vector<Real> values;  values. reserve (name2leaf. size ());
+    for (const auto& it : name2leaf)
+    {
+      const Leaf* leaf = it. second;
+      if (leaf->graph)
+        values << leaf->normCriterion;
+    }
+    Normal distr;  
+    outlier_min_excl = locScaleDistr2outlier (values, distr, true, outlier_EValue_max);
+  }
 
   VectorPtr<Leaf> res;
   if (! isNan (outlier_min_excl))
@@ -8593,17 +9196,246 @@ void hybrid2requests (size_t from,
 
 
 
+struct HybridIndex
+// Valid dissimilarities of each Leaf
+{
+  struct Neighbor
+  {
+    const Leaf* leaf {nullptr};
+    uint num {0};
+      // Index of leaf in HybridIndex::leaves
+    size_t dissimType {no_index};
+    Real target {NaN};
+    
+    static bool leafLess (const Neighbor &a,
+                          const Neighbor &b)
+      { LESS_PART (a, b, dissimType);
+        return a. leaf < b. leaf;
+      }
+    static bool targetLess (const Neighbor &a,
+                            const Neighbor &b)
+      { LESS_PART (a, b, dissimType);
+        return a. target < b. target;
+      }
+  };
+  typedef  Vector<Neighbor>::const_iterator  Iter;
+
+  VectorPtr<Leaf> leaves;
+  unordered_map<const Leaf*,uint/*index in leaves*/> leaf2num;
+  Vector<size_t> start;
+    // Neighbors of leaves[i]: [start[i], start[i+1])
+    // size() = leaves.size() + 1
+  Vector<Neighbor> byLeaf;
+    // Sorted by Neighbor::leafLess() for each Leaf
+  Vector<Neighbor> byTarget;
+    // Sorted by Neighbor::targetLess() for each Leaf
+  Vector<size_t> signatures;
+    // Of the valid dissimilarities of leaves[i]
+  
+  
+  explicit HybridIndex (const DistTree &tree);
+    // Time: O(p log(p/n) / threads_max)
+private:
+  static void sort_thread (size_t from,
+                           size_t to,
+                           Notype /*&res*/,
+                           HybridIndex &hi)
+    { FOR_START (size_t, i, from, to)
+      { const auto b = (long) hi. start [i];
+        const auto e = (long) hi. start [i + 1];
+        std::sort (hi. byLeaf.   begin () + b, hi. byLeaf.   begin () + e, Neighbor::leafLess);
+        std::sort (hi. byTarget. begin () + b, hi. byTarget. begin () + e, Neighbor::targetLess);
+      }
+    }
+  static size_t mix (size_t x)
+    // splitmix64
+    { x += 0x9e3779b97f4a7c15;
+      x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+      x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+      return x ^ (x >> 31);
+    }
+  pair<Iter,Iter> typeRange (const Vector<Neighbor> &vec,
+                             uint num,
+                             size_t dissimType) const
+    { Neighbor n;
+      n. dissimType = dissimType;
+      return std::equal_range ( vec. begin () + (long) start [num]
+                              , vec. begin () + (long) start [num + 1]
+                              , n
+                              , [] (const Neighbor &a, const Neighbor &b) { return a. dissimType < b. dissimType; }
+                              );
+    }
+public:
+  
+  
+  size_t getSignature (uint num) const;
+    // Of the valid dissimilarities of leaves[num], of its neighbors and of hybridness_min
+    // Return: != 0
+  void addTriangles (uint num,
+                     Vector<Triangle> &triangles) const;
+    // Append: triangles: with vertex leaves[num], may be non-unique
+    // Invokes: addTriangle()
+    // Average time: O(p^2/n^2 log(n))
+};
+
+
+
+HybridIndex::HybridIndex (const DistTree &tree)
+{
+  leaf2num. rehash (tree. name2leaf. size ());
+  leaves. reserve (tree. name2leaf. size ());
+  for (const auto& it : tree. name2leaf)
+  {
+    const Leaf* leaf = it. second;
+    if (! leaf->graph)
+      continue;
+    leaf2num [leaf] = (uint) leaves. size ();
+    leaves << leaf;
+  }
+  
+  start. resize (leaves. size () + 1, 0);
+  for (const Dissim& dissim : tree. dissims)
+    if (dissim. validMult ())
+    {
+      start [leaf2num [dissim. leaf1] + 1] ++;
+      start [leaf2num [dissim. leaf2] + 1] ++;
+    }
+  FFOR (size_t, i, leaves. size ())
+    start [i + 1] += start [i];
+    
+  byLeaf. resize (start. back ());
+  signatures. resize (leaves. size (), 0);
+  {
+    Vector<size_t> pos (start);
+    FFOR (size_t, dissimNum, tree. dissims. size ())
+    {
+      const Dissim& dissim = tree. dissims [dissimNum];
+      if (! dissim. validMult ())
+        continue;
+      ASSERT (dissim. target >= 0.0);
+      const uint num1 = leaf2num [dissim. leaf1];
+      const uint num2 = leaf2num [dissim. leaf2];
+      byLeaf [pos [num1] ++] = Neighbor {dissim. leaf2, num2, dissim. type, dissim. target};
+      byLeaf [pos [num2] ++] = Neighbor {dissim. leaf1, num1, dissim. type, dissim. target};
+      uint64_t targetBits = 0;
+      memcpy (& targetBits, & dissim. target, sizeof (targetBits));
+      const size_t h = mix (mix (dissimNum) ^ targetBits);
+      signatures [num1] += h;
+      signatures [num2] += h;
+    }
+  }
+  byTarget = byLeaf;
+  
+  vector<Notype> notypes;
+  arrayThreads (false, sort_thread, leaves. size (), notypes, ref (*this));
+}
+
+
+
+size_t HybridIndex::getSignature (uint num) const
+{
+  uint64_t hybridnessBits = 0;
+  memcpy (& hybridnessBits, & DistTree_sp::hybridness_min, sizeof (hybridnessBits));
+  size_t signature = mix (signatures [num] ^ hybridnessBits);
+  FOR_START (size_t, i, start [num], start [num + 1])
+    signature += mix (signatures [byLeaf [i]. num]);
+  return max<size_t> (1, signature);
+}
+
+
+
+void HybridIndex::addTriangles (uint num,
+                                Vector<Triangle> &triangles) const
+{
+  ASSERT (DistTree_sp::hybridness_min > 1.0);
+  
+  const Leaf* leaf = leaves [num];
+  const Real h = DistTree_sp::hybridness_min;
+  
+  // Triangle (leaf, parent1, parent2) with d1 = d(leaf,parent1), d2 = d(leaf,parent2), d12 = d(parent1,parent2)
+  // has hybridness >= h only if:
+  //   child = leaf:    d12 >= h (d1 + d2)  => d12 >= h (d1 + d2_min)
+  //   child = parent1: d2 >= h (d1 + d12)  => d12 <= d2_max / h - d1
+  //   child = parent2: d1 >= h (d2 + d12)  => d12 <= d1 / h - d2_min
+  const auto leafEnd = byLeaf. begin () + (long) start [num + 1];
+  auto typeEnd = byLeaf. begin () + (long) start [num];
+  while (typeEnd != leafEnd)
+  {
+    // Neighbors of leaf of the same dissimilarity type
+    const size_t dissimType = typeEnd->dissimType;
+    const pair<Iter,Iter> leafRange (typeEnd, std::upper_bound (typeEnd, leafEnd, *typeEnd, [] (const Neighbor &a, const Neighbor &b) { return a. dissimType < b. dissimType; }));
+    typeEnd = leafRange. second;
+    const pair<Iter,Iter> targetRange (typeRange (byTarget, num, dissimType));
+    ASSERT (leafRange. second - leafRange. first == targetRange. second - targetRange. first);
+    const Real d2_min = targetRange. first->target;
+    const Real d2_max = (targetRange. second - 1) -> target;
+    
+    for (Iter neighbor1 = leafRange. first; neighbor1 != leafRange. second; neighbor1++)
+    {
+      const Real d1 = neighbor1->target;
+      const pair<Iter,Iter> range1 (typeRange (byTarget, neighbor1->num, dissimType));
+      // Admissible d12: [0, hi] or [lo, inf)
+      const Real slack = 1e-9 * (d1 + d2_max);  // PAR
+      const Real hi = max (d2_max / h - d1, d1 / h - d2_min) + slack;
+      const Real lo = h * (d1 + d2_min) - slack;
+      Neighbor bound;
+      bound. dissimType = dissimType;
+      bound. target = hi;
+      const Iter hiEnd = lo <= hi ? range1. second : std::upper_bound (range1. first, range1. second, bound, Neighbor::targetLess);
+      bound. target = lo;
+      const Iter loStart = lo <= hi ? range1. second : std::lower_bound (hiEnd, range1. second, bound, Neighbor::targetLess);
+      for (const pair<Iter,Iter>& candidates : {make_pair (range1. first, hiEnd), make_pair (loStart, range1. second)})
+        for (Iter neighbor2 = candidates. first; neighbor2 != candidates. second; neighbor2++)
+        {
+          const Leaf* parent2 = neighbor2->leaf;
+          if (parent2 == leaf)
+            continue;
+          Neighbor key;
+          key. dissimType = dissimType;
+          key. leaf = parent2;
+          const Iter it = std::lower_bound (leafRange. first, leafRange. second, key, Neighbor::leafLess);
+          if (it == leafRange. second || it->leaf != parent2)
+            continue;
+          addTriangle ( triangles
+                      , leaf
+                      , neighbor1->leaf
+                      , parent2
+                      , neighbor2->target
+                      , it->target
+                      , d1
+                      , dissimType
+                      );
+        }
+    }
+  }
+}
+
+
+
 void addHybridTriangles_thread (size_t from,
                                 size_t to,
                                 Vector<Triangle>& res,
-                                const VectorPtr<Leaf> &badLeaves)
+                                const Vector<uint> &badLeafNums,
+                                const HybridIndex &hi)
+// Update: Leaf::hybridTriangles, Leaf::hybridTriangles_signature
 {
   ASSERT (from <= to);
-  ASSERT (to <= badLeaves. size ());
+  ASSERT (to <= badLeafNums. size ());
   ASSERT (res. empty ());
     
   FOR_START (size_t, i, from, to)
-    badLeaves [i] -> addHybridTriangles (res);
+  {
+    const uint num = badLeafNums [i];
+    Leaf* leaf = var_cast (hi. leaves [num]);
+    const size_t signature = hi. getSignature (num);
+    if (leaf->hybridTriangles_signature != signature)
+    {
+      leaf->hybridTriangles. clear ();
+      hi. addTriangles (num, leaf->hybridTriangles);
+      leaf->hybridTriangles_signature = signature;
+    }
+    res << leaf->hybridTriangles;
+  }
 }
 
 
@@ -8655,23 +9487,18 @@ Vector<TriangleParentPair> DistTree::findHybrids (Real dissimOutlierEValue_max,
   // Time: O(p log(p))
   {
     // Bad dissims
-    Dataset ds;
-    ds. objs. reserve (dissims. size ());  
-    auto criterionAttr = new PositiveAttr1 ("dissim_error", ds);  
+    Vector<Real> errs;  errs. reserve (dissims. size ());  
     for (const Dissim& dissim : dissims)    
       if (dissim. validMult ())
       {
-        const size_t index = ds. appendObj ();
         const Real err = dissim. getDeformation ();
         ASSERT (err >= 0.0);
-        (*criterionAttr) [index] = err;
+        errs << err;
       }
-    ds. qc ();
-    const Sample sample (ds); 
     Chi2 chi2;
     chi2. setParam (1.0);
     chi2. qc ();
-    const Real outlier_min_excl = criterionAttr->contDistr2outlier (sample, chi2, true, dissimOutlierEValue_max * (Real) dissimTypesNum () * 1e1);  // PAR
+    const Real outlier_min_excl = contDistr2outlier (errs, chi2, true, dissimOutlierEValue_max * (Real) dissimTypesNum () * 1e1);  // PAR
   #if 0
     Normal normal; 
     outlier_min_excl [criterionType] = criterionAttrs [criterionType] -> locScaleDistr2outlier (sample, normal, true, dissimOutlierEValue_max * (Real) dissimTypesNum () * 1e-2);  // PAR
@@ -8707,8 +9534,7 @@ Vector<TriangleParentPair> DistTree::findHybrids (Real dissimOutlierEValue_max,
     }
     Real outlier_min_excl = NaN;
   #if 1
-    const Dataset leafErrorDs (getLeafErrorDataset (true, NaN));
-    badLeaves << findCriterionOutliers (leafErrorDs, dissimOutlierEValue_max * 1e0, outlier_min_excl);  // PAR  
+    badLeaves << findCriterionOutliers (dissimOutlierEValue_max * 1e0, outlier_min_excl);  // PAR  
     badLeaves. sort (leafRelCriterionStrictlyGreater);
   #else  
     // Too few hybrids
@@ -8722,9 +9548,14 @@ Vector<TriangleParentPair> DistTree::findHybrids (Real dissimOutlierEValue_max,
       // Size: O(n/log^2(n))
     if (! qc_on)
       badLeaves. randomOrder ();
+    const HybridIndex hi (*this);
+    Vector<uint> badLeafNums;  badLeafNums. reserve (badLeaves_size);
+    for (const Leaf* leaf : badLeaves)
+      badLeafNums << hi. leaf2num. at (leaf);
     vector<Vector<Triangle>> resVec;
-    // Time: O(n/log^2(n) * p^2/n^2 log^2(n) / threads_max) = O(p^2/n / threads_max)
-    arrayThreads (false, addHybridTriangles_thread, badLeaves_size, resVec, cref (badLeaves));
+    // Time: O(n/log^2(n) * p^2/n^2 log(n) / threads_max) = O(p^2/n/log(n) / threads_max)
+    // Leaves whose neighborhood has not changed since the previous call reuse Leaf::hybridTriangles
+    arrayThreads (false, addHybridTriangles_thread, badLeaves_size, resVec, cref (badLeafNums), cref (hi));
     for (const Vector<Triangle>& res : resVec)
       for (const Triangle& tr : res)  
         triangleParentPairs_init << TriangleParentPair ( tr. parents [0]. leaf
@@ -9427,47 +10258,45 @@ NewLeaf::Leaf2dissim::Leaf2dissim (const Leaf* leaf_arg,
 
 // DissimLine
 
-DissimLine::DissimLine (string &line,
-                        uint lineNum)
+DissimLine::DissimLine (string_view line)
 { 
-  replace (line, '\t', ' ');
-  name1 = findSplit (line);
-  name2 = findSplit (line);
-  #define MSG  getErrorStr (lineNum) + 
+  const auto split = [&line] () 
+    { size_t i = 0;
+      while (i < line. size () && line [i] != ' ' && line [i] != '\t')
+        i++;
+      const string_view s (line. substr (0, i));
+      line. remove_prefix (min (i + 1, line. size ()));
+      return s;
+    };
+  name1 = split ();
+  name2 = split ();
   if (name2. empty ())
-    throw runtime_error (MSG "empty name2");
+    throw runtime_error ("empty name2");
   if (name1 == name2)
-    throw runtime_error (MSG "name1 == name2");
+    throw runtime_error ("name1 == name2");
   if (name1 > name2)
     swap (name1, name2);
-  dissim = str2real (line);
+  while (! line. empty () && isSpace (line. front ()))
+    line. remove_prefix (1);
+  while (! line. empty () && isSpace (line. back ()))
+    line. remove_suffix (1);
+  {
+    const char* end = line. data () + line. size ();
+    const from_chars_result res = from_chars (line. data (), end, dissim);
+    if (res. ec != errc () || res. ptr != end)
+    {
+      // "inf", "nan", "?", trailing text etc.
+      string s (line);
+      replace (s, '\t', ' ');
+      dissim = str2real (s);
+    }
+  }
   if (isNan (dissim))
-    throw runtime_error (MSG "dissimilarity is NaN");
+    throw runtime_error ("dissimilarity is NaN");
   if (dissim < 0.0)
-    throw runtime_error (MSG "dissimilarity is negative");
+    throw runtime_error ("dissimilarity is negative");
 //if (! DM_sp::finite (dissim))
-  //throw runtime_error (MSG "dissimilarity is infinite");
-  #undef MSG
-}
-
-
-
-void DissimLine::process (const DistTree::Name2leaf &name2leaf)
-{
-  ASSERT (! leaf1);
-  ASSERT (! leaf2);
-  
-  leaf1 = var_cast (findPtr (name2leaf, name1));
-  if (! leaf1)
-    return;
-  //throw runtime_error (FUNC "Tree has no object " + name1);
-  leaf1->badCriterion = -1.0;  // temporary
-
-  leaf2 = var_cast (findPtr (name2leaf, name2));
-  if (! leaf2)
-    return;
-  //throw runtime_error (FUNC "Tree has no object " + name2);
-  leaf2->badCriterion = -1.0;  // temporary
+  //throw runtime_error ("dissimilarity is infinite");
 }
 
 
@@ -9486,14 +10315,17 @@ void DissimLine::apply (DistTree &tree) const
      )  
     leaf1->collapse (leaf2);
   if (! tree. addDissim (leaf1, leaf2, dissim, 1.0/*temporary*/, no_index))
-    throw runtime_error (FUNC "Cannot add dissimilarity: " + name1 + " " + name2 + " " + toString (dissim));
+    throw runtime_error (FUNC "Cannot add dissimilarity: " + string (name1) + " " + string (name2) + " " + toString (dissim));
 }
 
 
 bool DissimLine::operator< (const DissimLine &other) const
 { 
-  LESS_PART (*this, other, name1);
-  LESS_PART (*this, other, name2);
+  // Same as the order of names
+  if (! sameName (name1, rank1, other. name1, other. rank1))
+    return rank1 != no_rank && other. rank1 != no_rank ? rank1 < other. rank1 : name1 < other. name1;
+  if (! sameName (name2, rank2, other. name2, other. rank2))
+    return rank2 != no_rank && other. rank2 != no_rank ? rank2 < other. rank2 : name2 < other. name2;
   return false;
 }
 
@@ -171,6 +171,7 @@ struct Image;
 struct NewLeaf;
 
 struct DissimLine;
+struct DissimLines;
 
 
 
@@ -425,6 +426,11 @@ protected:
           Steiner* parent_arg,
 	        Real len_arg);
 public:
+  static void* operator new (size_t size)
+    { return Arena::newObject (size); }
+  static void operator delete (void* p)
+    { Arena::deleteObject (p); }
+    // Arena::current: Image::arena
   void qc () const override;
   void saveContent (ostream& os) const override;
   Json* toJson (JsonContainer* parent_arg,
@@ -466,9 +472,6 @@ public:
     // Deterministic <=> (bool)seed
     // Invokes: getDistTree().rand
     // Time: O(log(n))
-  void setErrorDensity (Real absCriterion_ave);
-    // Output: errorDensity
-    // Time: O(|pathDissimNums|)
 private:
   void saveFeatureTree (ostream &os,
                         bool withTime,
@@ -612,6 +615,11 @@ private:
 public:
   // For DistTree::findHybrids()
   Real badCriterion {NaN};
+  Vector<Triangle> hybridTriangles;
+    // Triangles with a vertex *this and hybridness >= hybridness_min
+  size_t hybridTriangles_signature {0};
+    // Of the dissimilarities of *this and of its neighbors when hybridTriangles were computed
+    // 0 <=> hybridTriangles are not computed
   
 
 	Leaf (DistTree &tree,
@@ -679,9 +687,6 @@ private:
     // Invokes: setParent()
     // To be followed by: DistTree::cleanTopology()
 public:	
-  void addHybridTriangles (Vector<Triangle> &triangles) const;
-    // Invokes: addTriangle()
-    // Average time: O(p^2/n^2 log^2(n))  
   Vector<ClosestLeaf> findGenogroups (Real genogroup_dist_max) final
     { if (len <= genogroup_dist_max)
       { Vector<ClosestLeaf> res {{this, len}};
@@ -1073,6 +1078,8 @@ struct Image : Nocopy
   const DTNode* center {nullptr};
     // In subgraph.tree
     // May be delete'd
+  Arena arena;
+    // For the DTNode's and Arc's of tree in processSmall()
   DistTree* tree {nullptr};
     // nullptr <=> bad_alloc
   DiGraph::Node2Node new2old;  
@@ -1091,7 +1098,8 @@ struct Image : Nocopy
 	  // Time: ~ O(|area| (log(|area|) log^2(n) + |area|) + Time(optimizeWholeIter(|area|)))
 	void processLarge (const Steiner* subTreeRoot,
 	                   const VectorPtr<Tree::TreeNode> &possibleBoundary,
-	                   const VectorOwn<Change>* changes);
+	                   const VectorPtr<Change>* changes);
+	  // Input: changes: Change::from is in the subtree of subTreeRoot, any order
 	  // Time: ~ O(|area| log(|area|) log^2(n) + Time(optimizeSmallSubgraphs(|area|)))
   bool apply ();
     // Return: false <=> bad_alloc
@@ -1111,7 +1119,18 @@ struct SteinerHash;
 
 
 
-struct DistTree : Tree
+struct DistTreeArena
+// Base of DistTree which is destroyed after Tree
+// The nodes of a DistTree whose constructor has thrown are deleted by ~Tree()
+{
+protected:
+  Arena arena;
+    // For the DTNode's and DiGraph::Arc's of a tree loaded from a file
+};
+
+
+
+struct DistTree : DistTreeArena, Tree
 // Of DTNode*
 // Least-squares distance tree
 // Steiner tree
@@ -1229,9 +1248,12 @@ public:
     //         newLeaves2boundary
 	  // Time: ~ O(|area| (log(|area|) log^2(subgraph.tree.n) + (sparse ? log(|area|) : |area|)))
   DistTree () = default;
-  Vector<DissimLine> getDissimLines (const string& fName,
-                                     size_t reserveSize) const;
+ ~DistTree ()
+    { deleteNodes (); }
+  DissimLines getDissimLines (const string& fName) const;
     // Return: sort()'ed, unique
+    // Parallel
+    // Time: O(n/threads_max log(n))
 private:
   void loadTreeDir (const string &dir);
 	  // Input: dir: Directory with a tree of <dmSuff>-files
@@ -1242,14 +1264,9 @@ private:
                             Name2steiner &name2steiner);
     // Update: name2steiner
   void loadTreeFile (const string &fName);
-    // InvokesL loadLines()
-  bool loadLines (const StringVector &lines,
-		              size_t &lineNum,
-		              Steiner* parent,
-		              size_t expectedOffset);
-    // Return: a child of parent has been loaded
     // Output: topology, DTNode::len, Leaf::discernible
-    // Update: lineNum
+    // DTNode's are allocated in arena
+    // Time: O(n)
   void setName2leaf ();
   size_t getPathDissimNums_size () const
     { return 10 * (size_t) log (name2leaf. size () + 1); }  // PAR
@@ -1482,7 +1499,7 @@ private:
     // Return: May be nullptr
     // Invokes: tryChange()
     // Time: O(min(n,2^areaRadius_std) log^4(n))
-  bool applyChanges (const VectorOwn<Change> &changes,
+  bool applyChanges (const VectorPtr<Change> &changes,
                      bool byNewLeaf);
 	  // Return: false <=> no commits
 	  // Input: changes: !byNewLeaf <=> Change::apply()/restore() was done
@@ -1494,7 +1511,8 @@ private:
     // Update: bestChange: positive(improvement)
     // Invokes: Change::{apply(),restore()}
 public:
-  void optimizeLargeSubgraphs (const VectorOwn<Change>* changes);
+  void optimizeLargeSubgraphs (const VectorPtr<Change>* changes);
+    // Input: changes: any order
     // Invokes: optimizeSmallSubgraphs() or applyChanges(*changes), Threads
 	  // Time: ~ O(threads_max n log^3(n))
 
@@ -1563,29 +1581,44 @@ public:
     // Time: O(n)
     
   // Quality
-  Real getMeanResidual () const;
+  struct DissimStat
+  // Of Dissim::validMult()
+  // Mergeable
+  {
+    size_t n {0};
+    Real unoptimizable {0.0};
+      // epsilon2_0
+    WeightedMeanVar residual;
+      // Weight: Dissim::mult
+    Correlation sqrResidualCorr;
+      // Between Dissim::target and squared residual
+    MeanVar deformation;
+    
+    void add (const Dissim &dissim);
+    void add (const DissimStat &other);
+  };
+  DissimStat getDissimStat () const;
     // Input: Dissim::prediction
-	  // Time: O(p)
+    // Parallel
+    // Time: O(p/threads_max)
   Real getMinLeafLen () const;
     // Return: min. length of discernible leaf arcs 
-  Real getSqrResidualCorr () const;
-    // Return: correlation between squared residual and Dissim::target
-    // Input: Dissim::prediction
-	  // Time: O(p)
-  Real getUnoptimizable () const;
-    // Return: epsilon2_0
-  void setErrorDensities ();
-    // Invokes: DTNode::setErrorDensity()
-	  // Time: O(p log(n))
 	void setLeafNormCriterion ();
     // Output: Leaf::{normCriterion,absCriterion,absCriterion_ave}
     // Time: O(p)
 	void setNodeMaxDeformationDissimNum ();
     // Output: DTNode::maxDeformationDissimNum
     // Time: O(p log(n))
-  Real getDeformation_mean () const;
+  void setNodeErrors ();
+    // = setLeafNormCriterion(), setNodeMaxDeformationDissimNum() and DTNode::errorDensity in one pass over DTNode::pathDissimNums
+    // Parallel
+    // Time: O(p log(n) / threads_max)
+  Real getDeformation_mean () const
+    { const Real deformation_mean = getDissimStat (). deformation. getMean ();
+      ASSERT (deformation_mean >= 0.0);
+      return deformation_mean;
+    }
     // Return: >= 0
-    // Time: O(p)
   Dataset getLeafErrorDataset (bool criterionAttrP,
                                Real deformation_mean) const;
     // Input: deformation_mean: may be NaN
@@ -1596,14 +1629,13 @@ public:
 
   // Outliers
   // Return: distinct
-  VectorPtr<Leaf> findCriterionOutliers (const Dataset &leafErrorDs,
-                                         Real outlier_EValue_max,
+  VectorPtr<Leaf> findCriterionOutliers (Real outlier_EValue_max,
                                          Real &outlier_min_excl) const;
     // Relative average absolute criterion
     // Idempotent
     // Return: sort()'ed by Leaf::normCriterion descending
     // Output: outlier_min_excl
-    // Invokes: RealAttr2::locScaleDistr2outlier()
+    // Invokes: locScaleDistr2outlier()
     // Requires: after setLeafNormCriterion()
     // Time: O(n log(n))
   VectorPtr<Leaf> findDeformationOutliers (Real deformation_mean,
@@ -1679,42 +1711,60 @@ public:
 ///////////////////////////////////////////////////////////////////////////
 
 struct DissimLine
+// Line of a dissimilarity file: <name1> <name2> <dissim>
 {
   // Input
-  string name1;
-  string name2;
+  string_view name1;
+  string_view name2;
+    // Point into DissimLines::mf or Leaf::name
   // name1 < name2
   Real dissim {NaN};
   // Output
   Leaf* leaf1 {nullptr};
   Leaf* leaf2 {nullptr};
+    // leaf1 => leaf2
+  static constexpr uint no_rank {numeric_limits<uint>::max ()};
+  uint rank1 {no_rank};
+  uint rank2 {no_rank};
+    // Indexes of leaf1, leaf2 in the list of Leaf's sorted by name; for fast comparison
   
 
   DissimLine () = default;
-  DissimLine (string &line,
-              uint lineNum);
+  explicit DissimLine (string_view line);
   DissimLine (const string &name1_arg,
               const string &name2_arg)
     : name1 (name1_arg)
     , name2 (name2_arg)
     {}
-private:
-  static string getErrorStr (uint lineNum) 
-    { return "Line " + toString (lineNum) + ": "; }
-public:
     
 
-  void process (const DistTree::Name2leaf &name2leaf);
   void apply (DistTree &tree) const;
   bool operator< (const DissimLine &other) const;
   bool operator== (const DissimLine &other) const
-    { return    name1 == other. name1
-             && name2 == other. name2;
+    { return    sameName (name1, rank1, other. name1, other. rank1)
+             && sameName (name2, rank2, other. name2, other. rank2);
+    }
+private:
+  static bool sameName (string_view a,
+                        uint rankA,
+                        string_view b,
+                        uint rankB)
+    { if (rankA != no_rank && rankB != no_rank)
+        return rankA == rankB;
+      return a == b;
     }
 };
 
 
 
+struct DissimLines : Vector<DissimLine>
+{
+  unique_ptr<const MappedFile> mf;
+    // Dissimilarity file
+};
+
+
+
 struct NewLeaf : Named
 // To become Leaf
 // name = Leaf::name
@@ -42,6 +42,24 @@ diff Enterobacteriaceae.nw $DATA/Enterobacteriaceae.nw
 rm Enterobacteriaceae.nw
 rm Enterobacteriaceae.tree
 
+section "compareTrees"
+# Leaf h is only in tree 2
+# Non-trivial bipartitions on the common leaves: {a,b} {c,d} {e,f,g} in tree 1, {a,c} {b,d} {e,f} {e,f,g} in tree 2
+echo "((a:1,b:1):1,(c:1,d:1):1,(e:1,f:1,g:1):1);"            > $TMP.1.nw
+echo "((a:1,c:1):1,(b:1,d:1):1,((e:1,f:1):1,g:1):1,h:1);"    > $TMP.2.nw
+$THIS/newick2tree -qc $TMP.1.nw > $TMP.1.tree
+$THIS/newick2tree -qc $TMP.2.nw > $TMP.2.tree
+$THIS/compareTrees $TMP.1.tree $TMP.2.tree -qc > $TMP.compare
+grep -qx "# Deleted: 1" $TMP.compare
+[ "`grep '^Robinson-Foulds distance' $TMP.compare | cut -f 2`" == 5 ]
+[ `grep -c '^match+' $TMP.compare` == 1 ]
+[ `grep -c '^match-' $TMP.compare` == 2 ]
+echo "$TMP.1.tree" >  $TMP.list
+echo "$TMP.2.tree" >> $TMP.list
+$THIS/compareTrees $TMP.1.tree $TMP.list -batch -qc | tail -n +2 | cut -f 2- > $TMP.batch
+printf "7\t3\t3\t3\t0\t0\n7\t3\t4\t1\t5\t0.714286\n" > $TMP.batch.expected
+diff $TMP.batch $TMP.batch.expected
+
 section "Perfect tree"
 $THIS/makeDistTree  -qc  -data $DATA/tree4  -variance linExp  -optimize  -output_tree tree4 | grep -v '^CHRON: ' > tree4.makeDistTree
 $THIS/distTree_compare_criteria.sh tree4.makeDistTree $DATA/tree4.makeDistTree
@@ -656,9 +656,8 @@ struct ThisApplication : Application
       {
         section ("Finding criterion outliers", false);
 	      tree->setLeafNormCriterion (); 
-        const Dataset leafErrorDs (tree->getLeafErrorDataset (true, NaN));
 	      Real outlier_min_excl = NaN;
-	      const VectorPtr<Leaf> outliers (tree->findCriterionOutliers (leafErrorDs, 1e-6, outlier_min_excl));  // PAR
+	      const VectorPtr<Leaf> outliers (tree->findCriterionOutliers (1e-6, outlier_min_excl));  // PAR
 	      const ONumber on (cout, absCriterionDecimals, false);  
 	      cout << "# Criterion outliers: " << outliers. size () << endl;
 	      cout << "# Criterion outlier threshold: " << outlier_min_excl << endl;
@@ -728,9 +727,7 @@ struct ThisApplication : Application
       if (! noqual)
       {
         section ("Node/arc criteria", true);
-        tree->setLeafNormCriterion ();  
-        tree->setNodeMaxDeformationDissimNum ();
-        tree->setErrorDensities ();  
+        tree->setNodeErrors ();  
         tree->qc ();
       }
 
@@ -741,12 +738,6 @@ struct ThisApplication : Application
     }
     
     
-    chron_getBestChange.    print (cout);
-    chron_tree2subgraph.    print (cout);
-    chron_subgraphOptimize. print (cout); 
-    chron_subgraph2tree.    print (cout); 
-
-
     // Tree model is fixed
     
 
@@ -778,11 +769,11 @@ struct ThisApplication : Application
     if (! noqual && tree->optimizable ())
     {
 		  const ONumber on (cout, 2, false);  // PAR
-    	const Real dissim_var = tree->getUnoptimizable ();  
-      cout << "Relative epsilon2_0 = " << sqrt (dissim_var / tree->target2_sum) * 100.0 << " %" << endl;
+		  const DistTree::DissimStat dissimStat (tree->getDissimStat ());
+      cout << "Relative epsilon2_0 = " << sqrt (dissimStat. unoptimizable / tree->target2_sum) * 100.0 << " %" << endl;
         // Must be << "Average arc error"
-      cout << "Mean residual = " << tree->getMeanResidual () << endl;
-      cout << "Correlation between residual^2 and dissimilarity = " << tree->getSqrResidualCorr () << endl; 
+      cout << "Mean residual = " << dissimStat. residual. getMean () << endl;
+      cout << "Correlation between residual^2 and dissimilarity = " << dissimStat. sqrResidualCorr. getCorrelation () << endl; 
       cout << endl;
       tree->qc ();
     }
@@ -814,8 +805,7 @@ struct ThisApplication : Application
     
     if (! leaf_errors. empty ())
     {
-      tree->setLeafNormCriterion (); 
-      tree->setNodeMaxDeformationDissimNum ();
+      tree->setNodeErrors (); 
       const Dataset leafErrorDs (tree->getLeafErrorDataset (true, tree->getDeformation_mean ()));
       OFStream f (leaf_errors + dmSuff);
 	    leafErrorDs. saveText (f);    
@@ -0,0 +1,51 @@
+#!/bin/bash --noprofile
+THIS=`dirname $0`
+source $THIS/../bash_common.sh
+if [ $# -ne 1 ]; then
+  echo "Print the time of neighbor joining for random Euclidean dissimilarities: # objects, seconds"
+  echo "#1: list of the numbers of objects, e.g., '500 1000 2000 4000'"
+  exit 1
+fi
+SIZES="$1"
+
+
+TMP=`mktemp`
+comment $TMP
+#set -x
+
+
+for N in $SIZES; do
+  awk -v n=$N 'BEGIN {
+    srand (1);
+    dim = 10;
+    for (i = 0; i < n; i++)
+      for (k = 0; k < dim; k++)
+        x [i, k] = rand ();
+    print "OBJNUM " n " name nomult";
+    print "ATTRIBUTES";
+    print "  dist Positive2 6";
+    print "DATA";
+    for (i = 0; i < n; i++)
+      print "O" i;
+    print "dist full";
+    for (i = 0; i < n; i++)
+    {
+      s = "";
+      for (j = 0; j < n; j++)
+      {
+        d = 0;
+        for (k = 0; k < dim; k++)
+          d += (x [i, k] - x [j, k]) ^ 2;
+        s = s (j ? " " : "") sprintf ("%.6f", sqrt (d));
+      }
+      print s;
+    }
+  }' > $TMP.dm
+  START=`date +%s.%N`
+  $THIS/makeDistTree  -data $TMP  -variance lin  -output_tree $TMP.tree  -noqual  -threads 8 &> $TMP.out
+  END=`date +%s.%N`
+  echo -e "$N\t`awk -v s=$START -v e=$END 'BEGIN {print e - s}'`"
+done
+
+
+rm $TMP*
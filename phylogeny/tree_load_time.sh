@@ -0,0 +1,56 @@
+#!/bin/bash --noprofile
+THIS=`dirname $0`
+source $THIS/../bash_common.sh
+if [ $# -ne 1 ]; then
+  echo "Print the time of loading random binary trees: # leaves, seconds for the tree file format, seconds for the Newick format"
+  echo "#1: list of the numbers of leaves, e.g., '100000 1000000'"
+  exit 1
+fi
+SIZES="$1"
+
+
+TMP=`mktemp`
+comment $TMP
+#set -x
+
+
+for N in $SIZES; do
+  awk -v n=$N 'BEGIN {
+    srand (1);
+    # Stack of subtrees: size, depth
+    top = 1;
+    size [top] = n;
+    depth [top] = 0;
+    leaf = 0;
+    interior = 0;
+    while (top)
+    {
+      s = size [top];
+      d = depth [top];
+      top--;
+      indent = sprintf ("%*s", 2 * d, "");
+      len = d ? sprintf ("%e", rand ()) : "nan";
+      if (s == 1)
+      {
+        leaf++;
+        print indent "L" leaf ": len=" len;
+        continue;
+      }
+      interior++;
+      print indent "0x" interior ": len=" len;
+      k = 1 + int (rand () * (s - 1));
+      top++;  size [top] = s - k;  depth [top] = d + 1;
+      top++;  size [top] = k;      depth [top] = d + 1;
+    }
+  }' > $TMP.tree
+  $THIS/printDistTree $TMP.tree -format newick > $TMP.newick
+  START=`date +%s.%N`
+  $THIS/printDistTree $TMP.tree -format newick > /dev/null
+  MIDDLE=`date +%s.%N`
+  $THIS/newick2tree $TMP.newick > /dev/null
+  END=`date +%s.%N`
+  echo -e "$N\t`awk -v s=$START -v e=$MIDDLE 'BEGIN {print e - s}'`\t`awk -v s=$MIDDLE -v e=$END 'BEGIN {print e - s}'`"
+done
+
+
+rm $TMP*
@@ -38,6 +38,13 @@
 using namespace Common_sp;
 #include "version.inc"
 
+#include <deque>
+#include <condition_variable>
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char** environ;
+
 
 
 namespace
@@ -47,29 +54,104 @@ namespace
 unique_ptr<OFStream> errors;
 std::mutex errorsMtx;
 
+unique_ptr<ofstream> checkpoint;
+std::mutex checkpointMtx;
+
+
+
+bool splitSimpleCommand (const string &cmd,
+                         StringVector &args)
+// Return: true <=> cmd does not need a shell
+// Output: args: words of cmd if true
+{
+  static const string special ("|&;<>()$`\\\"'*?[]{}~#!\n\r");
+  for (const char c : cmd)
+    if (charInSet (c, special))
+      return false;
+
+  static const StringVector shellWords {"cd", "export", "source", ".", "exit", "set", "unset", "alias", "eval", "exec", "read", "trap", "ulimit", "umask", "wait", "shift", "return", "type", "hash", "command",
+                                        "if", "then", "else", "elif", "fi", "case", "esac", "for", "while", "until", "do", "done", "function", "time"};
+  args. clear ();
+  string s (cmd);
+  replace (s, '\t', ' ');
+  for (;;)
+  {
+    trim (s);
+    if (s. empty ())
+      break;
+    args << findSplit (s);
+  }
+  if (args. empty ())
+    return false;
+  if (contains (args. front (), '='))  // Variable assignment
+    return false;
+  if (shellWords. contains (args. front ()))
+    return false;
+
+  return true;
+}
+
+
+
+int runCommand (const string &cmd)
+// Return: status in the format of system()
+{
+  StringVector args;
+  if (! splitSimpleCommand (cmd, args))
+    return system (cmd. c_str ());
+    // "set -o pipefail && ..." does not work with dash
+
+  // Without forking a shell
+  vector<char*> argv;  argv. reserve (args. size () + 1);
+  for (string& arg : args)
+    argv. push_back (& arg [0]);
+  argv. push_back (nullptr);
+  pid_t pid = 0;
+  if (posix_spawnp (& pid, argv [0], nullptr, nullptr, argv. data (), environ))
+    return 127 << 8;  // Exit status of the shell for a command not found
+  int status = 0;
+  while (waitpid (pid, & status, 0) == -1)
+    if (errno != EINTR)
+      return -1;
+  return status;
+}
+
+
 
+struct Command
+{
+  string cmd;
+  string item;
+};
 
-void executeCommand (const string &cmd,
-                     const string &item/*,
+
+
+void executeCommand (const Command &command/*,
                      uint blank_lines*/)
 {
-  ASSERT (! cmd. empty ());
-  ASSERT (! item. empty ());
+  ASSERT (! command. cmd. empty ());
+  ASSERT (! command. item. empty ());
   
-  const int exitStatus = system (cmd. c_str ());
-    // "set -o pipefail && ..." does not work with dash
+  const int exitStatus = runCommand (command. cmd);
   if (exitStatus)
   {
     if (errors. get ())
     {
     //cout << exitStatus << endl;  // always 256 ??
       errorsMtx. lock ();
-    	*errors << item << endl;
+    	*errors << command. item << endl;
       QC_ASSERT (exitStatus != -1);
       errorsMtx. unlock ();
     }
     else
-      throw runtime_error ("item=" + item + "  status=" + to_string (WEXITSTATUS (exitStatus)) + "\n" + cmd);
+      throw runtime_error ("item=" + command. item + "  status=" + to_string (WEXITSTATUS (exitStatus)) + "\n" + command. cmd);
+  }
+
+  if (! exitStatus && checkpoint. get ())
+  {
+    const lock_guard<mutex> lg (checkpointMtx);
+    *checkpoint << command. item << endl;
+    QC_ASSERT (checkpoint->good ());
   }
 #if 0
   if (isMainThread ())
@@ -80,30 +162,131 @@ void executeCommand (const string &cmd,
   
   
 
-struct Command
+struct CommandQueue : Nocopy
+// Bounded queue with dynamic dispatch to threads
 {
-  string cmd;
-  string item;
-};
-  
+private:
+  const size_t capacity;
+  std::mutex mtx;
+  condition_variable cv;
+  condition_variable cvNotFull;
+  deque<Command> commands;
+  bool closed {false};
+public:
+  string error;
+    // First error
   
   
-void executeCommands (size_t from,
-                      size_t to,
-                      Notype /*&res*/,
-                      const Vector<Command> &commands,
-                      uint step/*,
+  explicit CommandQueue (size_t capacity_arg)
+    : capacity (capacity_arg)
+    { ASSERT (capacity); }
+
+
+  bool push (Command &&command)
+    // Return: false <=> the queue is closed
+    // Waits while the queue is full
+    { { unique_lock<mutex> ul (mtx);
+        cvNotFull. wait (ul, [this] () { return closed || commands. size () < capacity; });
+        if (closed)
+          return false;
+        commands. push_back (move (command));
+      }
+      cv. notify_one ();
+      return true;
+    }
+  bool pop (Command &command)
+    // Return: false <=> no more commands
+    // Output: command
+    { { unique_lock<mutex> ul (mtx);
+        cv. wait (ul, [this] () { return closed || ! commands. empty (); });
+        if (! error. empty () || commands. empty ())
+          return false;
+        command = move (commands. front ());
+        commands. pop_front ();
+      }
+      cvNotFull. notify_one ();
+      return true;
+    }
+  void fail (const string &what)
+    { { const lock_guard<mutex> lg (mtx);
+        if (error. empty ())
+          error = what;
+        closed = true;
+      }
+      cv. notify_all ();
+      cvNotFull. notify_all ();
+    }
+  void close ()
+    { { const lock_guard<mutex> lg (mtx);
+        closed = true;
+      }
+      cv. notify_all ();
+      cvNotFull. notify_all ();
+    }
+};
+
+
+
+void executeCommands (CommandQueue &queue/*,
                       uint blank_lines*/)
 {
-  Progress prog (to - from, step);  
-  FOR_START (size_t, i, from, to)
+  try
+  {
+    Command command;
+    while (queue. pop (command))
+      executeCommand (command/*, blank_lines*/);
+  }
+  catch (const exception &e)
   {
-    prog ();
-    const Command& command = commands [i];
-    executeCommand (command. cmd, command. item/*, blank_lines*/);
+    queue. fail (e. what ());
   }
 }
 
+
+
+struct Workers : Nocopy
+// threads_max threads executing commands from queue
+// The main thread only generates commands
+{
+  CommandQueue queue {64 * threads_max};  // PAR
+private:
+  vector<thread> threads;
+    // Not Threads, which keeps a thread for the main thread
+public:
+
+
+  Workers ()
+    { if (threads_max == 1)
+        return;
+      threads. reserve (threads_max);
+      FOR (size_t, i, threads_max)
+        threads. push_back (thread (executeCommands, ref (queue)));
+    }
+ ~Workers ()
+    { if (threads. empty ())
+        return;
+      queue. fail ("Interrupted");  // The queued commands are not executed
+      join ();
+    }
+
+
+  bool parallel () const
+    { return ! threads. empty (); }
+  void finish ()
+    // Throws: the first error of the threads
+    { queue. close ();
+      join ();
+      if (! queue. error. empty ())
+        throw runtime_error (queue. error);
+    }
+private:
+  void join ()
+    { for (thread& t : threads)
+        t. join ();
+      threads. clear ();
+    }
+};
+
   
   
 struct ThisApplication : Application
@@ -132,6 +315,7 @@ struct ThisApplication : Application
   	//addKey ("blank_lines", "# Blank lines to be printed to stderr after each command", "0");
   	  addKey ("step", "# Items processed to output the progress for", "100");
   	  addKey ("start", "# Item to start with", "1");
+  	  addKey ("checkpoint", "File with the completed items. Items in this file are skipped, completed items are appended to it, so that a rerun after a failure resumes automatically");
   	  addFlag ("zero", "Item numbers are 0-based, otherwise 1-based");
   	  addFlag ("print", "Print command, not execute");
   	  addFlag ("tsv", "<items> is a tsv-file");
@@ -148,6 +332,7 @@ struct ThisApplication : Application
 //const uint blank_lines     = str2<uint> (getArg ("blank_lines"));
 		const uint step          = str2<uint> (getArg ("step"));
 		const uint start         = str2<uint> (getArg ("start"));
+		const string checkpointFName = getArg ("checkpoint");
 		const bool zero          = getFlag ("zero");
 		const bool printP        = getFlag ("print");
 		const bool tsv           = getFlag ("tsv");
@@ -160,13 +345,32 @@ struct ThisApplication : Application
       throw runtime_error ("-step must be >= 1");
   //if (blank_lines && step > 1)
     //throw runtime_error ("-blank_lines requires -step to be 1");
+    if (printP && ! checkpointFName. empty ())
+      throw runtime_error ("-print cannot be used with -checkpoint");
+
+
+    unordered_set<string> completed;
+    if (! checkpointFName. empty ())
+    {
+      if (fileExists (checkpointFName))
+      {
+        ifstream f (checkpointFName);
+        string line;
+        while (getline (f, line))
+          if (! f. eof ())  // The last line can be truncated by a failure
+            completed. insert (move (line));
+      }
+      checkpoint. reset (new ofstream (checkpointFName, ios_base::app));
+      if (! checkpoint->good ())
+        throw runtime_error ("Cannot open " + strQuote (checkpointFName));
+    }
 
 
-	  Vector<Command> commands;  commands. reserve (100000);  // PAR
+    // Items are generated while commands are executed
+    Workers workers;
     {
   	  unique_ptr<ItemGenerator> gen;
   	  {
-  	    const uint stepItemGen = threads_max > 1 ? 1000 : step;  // PAR
     	  const bool isFile = fileExists (itemsName);
     	  const bool isDir = 
     	    #ifdef _MSC_VER
@@ -178,9 +382,9 @@ struct ThisApplication : Application
     	  if (isDir && tsv)
     	    throw runtime_error ("-tsv cannot be used if <items> is a directory");
     	  if (isFile)
-    	    gen. reset (new FileItemGenerator (stepItemGen, itemsName, tsv));
+    	    gen. reset (new FileItemGenerator (step, itemsName, tsv));
     	  else if (isDir)
-    	    gen. reset (new DirItemGenerator (stepItemGen, itemsName, large));
+    	    gen. reset (new DirItemGenerator (step, itemsName, large));
         else 
         {
           size_t n = 0; 
@@ -188,7 +392,7 @@ struct ThisApplication : Application
           {
         	  if (tsv)
         	    throw runtime_error ("-tsv cannot be used if <items> is a number");
-            gen. reset (new NumberItemGenerator (stepItemGen, n));	  
+            gen. reset (new NumberItemGenerator (step, n));	  
           }
           else
             throw runtime_error ("File " + strQuote (itemsName) + " does not exist");
@@ -246,6 +450,8 @@ struct ThisApplication : Application
         const size_t n = gen->prog. n - (zero ? 1 : 0);
         if (n < start)
           continue;
+        if (contains (completed, item))
+          continue;
           
         const string item_orig (item);
         const size_t hash_class = str2hash_class (item_orig);
@@ -315,20 +521,16 @@ struct ThisApplication : Application
         if (printP)
           cout << thisCmd << endl;
         else
-          if (threads_max == 1)
-            executeCommand (thisCmd, item_orig/*, blank_lines*/);
-      	  else
-      	    commands << move (Command {move (thisCmd), move (item_orig)});
+        {
+          Command command {move (thisCmd), move (item_orig)};
+          if (! workers. parallel ())
+            executeCommand (command/*, blank_lines*/);
+          else if (! workers. queue. push (move (command)))
+            break;
+        }
       }
     }
-
-
-    if (threads_max > 1)
-    {
-      commands. randomOrder ();
-      vector<Notype> notypes;
-  	  arrayThreads (false, executeCommands, commands. size (), notypes, cref (commands), step/*, blank_lines*/);
-  	}
+    workers. finish ();
 	}
 };
 
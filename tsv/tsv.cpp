@@ -60,6 +60,51 @@ void TextTable::Header::qc () const
 
 
 
+void TextTable::Header::addField (string_view field)
+{
+  if (field. empty ())
+  {
+    null = true;
+    return;
+  }
+  maximize (len_max, field. size ());
+  if (choices. size () <= choices_max)
+    choices << string (field);
+  if (! numeric)
+    return;
+  {
+    double d = 0.0;
+    if (! str2number (field, d))
+    {
+      numeric = false;
+      scientific = false;
+      decimals = 0;
+      return;
+    }
+  }
+  bool hasPoint = false;
+  streamsize decimals_field = 0;
+  if (getDecimals (field, hasPoint, decimals_field))
+    scientific = true;
+  maximize<streamsize> (decimals, decimals_field);
+}
+
+
+
+void TextTable::Header::addNumericLen (string_view field)
+{
+  if (field. empty ())
+    return;
+  if (! numeric)
+    return;
+  bool hasPoint = false;
+  streamsize decimals_field = 0;
+  getDecimals (field, hasPoint, decimals_field);
+  maximize (len_max, field. size () + (size_t) (decimals - decimals_field) + (! hasPoint));
+}
+
+
+
 TextTable::TextTable (const string &tableFName,
                       const string &columnSynonymsFName)
 : Named (tableFName)
@@ -86,37 +131,52 @@ TextTable::TextTable (const string &tableFName,
     }
   }
   
-  if (! columnSynonymsFName. empty ())
+  renameColumns (header, columnSynonymsFName, name);
+  
+  setHeader ();
+}
+
+
+
+void TextTable::renameColumns (Vector<Header> &header,
+                               const string &columnSynonymsFName,
+                               const string &tableName)
+{
+  if (columnSynonymsFName. empty ())
+    return;
+    
+  const auto col2num_ = [&header] (const string &columnName)
+                          { FFOR (size_t, i, header. size ())
+                              if (header [i]. name == columnName)
+                                return i;
+                            return no_index;
+                          };
+  LineInput colF (columnSynonymsFName);
+  string mainSyn;
+  while (colF. nextLine ())
   {
-    LineInput colF (columnSynonymsFName);
-    string mainSyn;
-    while (colF. nextLine ())
+    trim (colF. line);
+    const string& syn = colF. line;
+    if (syn. empty ())
+      mainSyn. clear ();
+    else
     {
-      trim (colF. line);
-      const string& syn = colF. line;
-      if (syn. empty ())
-        mainSyn. clear ();
+      if (mainSyn. empty ())
+        mainSyn = syn;
       else
-      {
-        if (mainSyn. empty ())
-          mainSyn = syn;
-        else
-          if (mainSyn != syn)
+        if (mainSyn != syn)
+        {
+          const ColNum i = col2num_ (syn);
+          if (i != no_index)
           {
-            const ColNum i = col2num_ (syn);
-            if (i != no_index)
-            {
-              if (hasColumn (mainSyn))
-                throw runtime_error ("Table " + strQuote (name) + ": Column " + strQuote (mainSyn) + " already exists");
-              else
-                header [i]. name = mainSyn;
-            }
+            if (col2num_ (mainSyn) != no_index)
+              throw runtime_error ("Table " + strQuote (tableName) + ": Column " + strQuote (mainSyn) + " already exists");
+            else
+              header [i]. name = mainSyn;
           }
-      }
+        }
     }
   }
-  
-  setHeader ();
 }
 
 
@@ -129,57 +189,14 @@ void TextTable::setHeader ()
     row_num++;
     if (row. size () != header. size ())
       throw Error (*this, "Row " + to_string (row_num) + " contains " + to_string (row. size ()) + " columns whereas header has " + to_string (header. size ()) + " columns");
-    FFOR (RowNum, i, row. size ())
-    {
-      const string& field = row [i];
-      Header& h = header [i];
-      if (field. empty ())
-      {
-        h. null = true;
-        continue;
-      }
-      maximize (h. len_max, field. size ());
-      if (h. choices. size () <= Header::choices_max)
-        h. choices << field;
-      if (! h. numeric)
-        continue;
-      {
-        char* endptr = nullptr;
-        strtod (field. c_str (), & endptr);
-        if (endptr != field. c_str () + field. size ())
-        {
-          h. numeric = false;
-          h. scientific = false;
-          h. decimals = 0;
-        }
-      }
-      if (h. numeric)
-      {
-        bool hasPoint = false;
-        streamsize decimals = 0;
-        if (getDecimals (field, hasPoint, decimals))
-          h. scientific = true;
-        maximize<streamsize> (h. decimals, decimals);
-      }
-    }
+    FFOR (ColNum, i, row. size ())
+      header [i]. addField (row [i]);
   }
 
   // Header::len_max for numeric
   for (const StringVector& row : rows)
-    FFOR (RowNum, i, row. size ())
-    {
-      const string& field = row [i];
-      if (field. empty ())
-        continue;
-      Header& h = header [i];
-      if (h. numeric)
-      {
-        bool hasPoint = false;
-        streamsize decimals = 0;
-        getDecimals (field, hasPoint, decimals);
-        maximize (h. len_max, field. size () + (size_t) (h. decimals - decimals) + (! hasPoint));
-      }
-    }
+    FFOR (ColNum, i, row. size ())
+      header [i]. addNumericLen (row [i]);
 }
 
 
@@ -251,12 +268,11 @@ void TextTable::saveText (ostream &os) const
 
     
     
-bool TextTable::getDecimals (string s,
+bool TextTable::getDecimals (string_view s,
                              bool &hasPoint,
                              streamsize &decimals)
 {
-  strUpper (s);
-  const size_t ePos     = s. find ('E');
+  const size_t ePos     = s. find_first_of ("eE");
   const size_t pointPos = s. find ('.');
   
   hasPoint = pointPos != string::npos;
@@ -276,6 +292,32 @@ bool TextTable::getDecimals (string s,
   return ePos != string::npos;
 }
 
+
+
+bool TextTable::str2number (string_view s,
+                            double &d)
+{
+  // strtod() needs a '\0'-terminated string
+  constexpr size_t buf_size = 64;  // PAR
+  char buf [buf_size];
+  string longS;
+  const char* p = nullptr;
+  if (s. size () < buf_size)
+  {
+    memcpy (buf, s. data (), s. size ());
+    buf [s. size ()] = '\0';
+    p = buf;
+  }
+  else
+  {
+    longS = s;
+    p = longS. c_str ();
+  }
+  char* endptr = nullptr;
+  d = strtod (p, & endptr);
+  return endptr == p + s. size ();
+}
+
     
   
 void TextTable::printHeader (ostream &os) const
@@ -616,6 +658,577 @@ TextTable::Index::Index (const TextTable &tab,
 
 
 
+// ColumnTextTable
+
+#ifndef _MSC_VER
+
+namespace
+{
+
+bool nextLine (string_view text,
+               size_t &pos,
+               string_view &line)
+// The same lines as LineInput::nextLine()
+// Update: pos
+// Output: line
+{
+  if (pos >= text. size ())
+    return false;
+  const size_t eol = text. find ('\n', pos);
+  if (eol == string_view::npos)
+  {
+    line = text. substr (pos);
+    pos = text. size ();
+  }
+  else
+  {
+    line = text. substr (pos, eol - pos);
+    pos = eol + 1;
+  }
+  return true;
+}
+
+
+
+string_view trimView (string_view s)
+{
+  while (! s. empty () && isSpace (s. back ()))
+    s. remove_suffix (1);
+  while (! s. empty () && isSpace (s. front ()))
+    s. remove_prefix (1);
+  return s;
+}
+
+
+
+
+}
+
+
+
+ColumnTextTable::ColumnTextTable (const string &tableFName,
+                                  const string &columnSynonymsFName,
+                                  bool typed)
+: Named (tableFName)
+, mf (new MappedFile (tableFName))
+{
+  const string_view text (mf->getView ());
+  size_t pos = 0;
+  string_view line;
+  Vector<string_view> fields;
+
+  if (! nextLine (text, pos, line))
+    throw TextTable::Error (*this, "Cannot read the table header");
+  if (! line. empty () && line. front () == '#')
+  {
+    pound = true;
+    line. remove_prefix (1);
+  }
+  splitLine (line, fields);
+  for (const string_view field : fields)
+    header << Header (string (field));
+  TextTable::renameColumns (header, columnSynonymsFName, name);
+
+  columns. resize (header. size ());
+  {
+    const size_t rows_est = (size_t) std::count (text. begin () + (long) pos, text. end (), '\n') + 1;
+    for (Column& col : columns)
+      col. cells. reserve (rows_est);
+  }
+  while (nextLine (text, pos, line))
+  {
+    splitLine (line, fields);
+    rowsSize++;
+    if (fields. size () != header. size ())
+      throw TextTable::Error (*this, "Row " + to_string (rowsSize) + " contains " + to_string (fields. size ()) + " columns whereas header has " + to_string (header. size ()) + " columns");
+    FFOR (ColNum, i, fields. size ())
+      columns [i]. cells << fields [i];
+  }
+
+  if (! typed)
+  {
+    for (Header& h : header)
+      h. numeric = false;
+    return;
+  }
+
+  FFOR (ColNum, i, header. size ())
+  {
+    Header& h = header [i];
+    Column& col = columns [i];
+    for (const string_view field : col. cells)
+      h. addField (field);
+    if (! h. numeric)
+      continue;
+    col. numbers. reserve (rowsSize);
+    for (const string_view field : col. cells)
+    {
+      h. addNumericLen (field);
+      double d = 0.0;
+      if (! field. empty ())
+        EXEC_ASSERT (TextTable::str2number (field, d));
+      col. numbers << d;
+    }
+  }
+}
+
+
+
+void ColumnTextTable::splitLine (string_view line,
+                                 Vector<string_view> &fields)
+{
+  fields. clear ();
+  if (line. empty ())
+    return;
+  size_t start = 0;
+  for (;;)
+  {
+    const size_t tab = line. find ('\t', start);
+    if (tab == string_view::npos)
+    {
+      fields << trimView (line. substr (start));
+      break;
+    }
+    fields << trimView (line. substr (start, tab - start));
+    start = tab + 1;
+  }
+}
+
+
+
+void ColumnTextTable::qc () const
+{
+  if (! qc_on)
+    return;
+  Named::qc ();
+
+  QC_ASSERT (mf. get ());
+
+  {
+    StringVector v;  v. reserve (header. size ());
+    FFOR (size_t, i, header. size ())
+    {
+      const Header& h = header [i];
+      try { h. qc (); }
+        catch (const exception &e)
+        {
+          throw runtime_error ("Header column #" + to_string (i + 1) + ": " + e. what ());
+        }
+      v << h. name;
+    }
+    v. sort ();
+    const size_t i = v. findDuplicate ();
+    if (i != no_index)
+      throw TextTable::Error (*this, "Duplicate column name: " + strQuote (v [i]));
+  }
+
+  QC_ASSERT (columns. size () == header. size ());
+  FFOR (ColNum, i, columns. size ())
+  {
+    const Column& col = columns [i];
+    QC_ASSERT (col. cells. size () == rowsSize);
+    if (header [i]. numeric)
+    {
+      QC_ASSERT (col. numbers. size () == rowsSize);
+    }
+    else
+    {
+      QC_ASSERT (col. numbers. empty ());
+    }
+  }
+}
+
+
+
+void ColumnTextTable::printHeader (ostream &os) const
+{
+  FFOR (size_t, i, header. size ())
+  {
+    os << i + 1 << '\t';
+    header [i]. saveText (os);
+    os << endl;
+  }
+}
+
+
+
+ColumnTextTable::ColNum ColumnTextTable::col2num_ (const string &columnName) const
+{
+  FFOR (size_t, i, header. size ())
+    if (header [i]. name == columnName)
+      return i;
+  return no_index;
+}
+
+
+
+int ColumnTextTable::compare (RowNum row1,
+                              RowNum row2,
+                              ColNum col) const
+{
+  const Column& c = columns [col];
+
+  if (header [col]. numeric)
+  {
+    const double a = c. numbers [row1];
+    const double b = c. numbers [row2];
+    if (a < b)
+      return -1;
+    if (a > b)
+      return 1;
+    return 0;
+  }
+
+  const int res = c. cells [row1]. compare (c. cells [row2]);
+  if (res < 0)
+    return -1;
+  if (res > 0)
+    return 1;
+  return 0;
 }
 
 
+
+Vector<double> ColumnTextTable::getRanks (ColNum col) const
+{
+  const Column& c = columns [col];
+
+  unordered_map<string_view,size_t> value2rank;
+  for (const string_view value : c. cells)
+    value2rank. emplace (value, 0);
+  {
+    Vector<string_view> values;  values. reserve (value2rank. size ());
+    for (const auto& it : value2rank)
+      values << it. first;
+    values. sort ();
+    FFOR (size_t, i, values. size ())
+      value2rank [values [i]] = i;
+  }
+
+  Vector<double> ranks;  ranks. reserve (rowsSize);
+  for (const string_view value : c. cells)
+    ranks << (double) value2rank [value];
+
+  return ranks;
+}
+
+
+
+Vector<ColumnTextTable::RowNum> ColumnTextTable::sort (const StringVector &by) const
+{
+  const Vector<ColNum> byIndex (columns2nums (by));
+  
+  // Comparison of by-columns by numbers
+  Vector<Vector<double>> ranks;  ranks. reserve (byIndex. size ());
+  Vector<const Vector<double>*> byKeys;  byKeys. reserve (byIndex. size ());
+  for (const ColNum col : byIndex)
+    if (header [col]. numeric)
+      byKeys << & columns [col]. numbers;
+    else
+    {
+      ranks << getRanks (col);
+      byKeys << & ranks. back ();
+    }
+
+  // The first key is stored with the row number for locality
+  typedef  pair<double,RowNum>  Item;
+  Vector<Item> items;  items. reserve (rowsSize);
+  FFOR (RowNum, row, rowsSize)
+    items << Item (byKeys. empty () ? 0.0 : (*byKeys. front ()) [row], row);
+
+  const auto lt = [&byKeys,this] (const Item &a, const Item &b)
+                    { if (a. first < b. first)
+                        return true;
+                      if (a. first > b. first)
+                        return false;
+                      FOR_START (size_t, k, 1, byKeys. size ())
+                      { const Vector<double>& keys = *byKeys [k];
+                        const double x = keys [a. second];
+                        const double y = keys [b. second];
+                        if (x < y)
+                          return true;
+                        if (x > y)
+                          return false;
+                      }
+                      // Tie resolution
+                      FFOR (ColNum, i, header. size ())
+                        switch (this->compare (a. second, b. second, i))
+                        { case -1: return true;
+                          case  1: return false;
+                        }
+                      return false;
+                    };
+  Common_sp::sort (items, lt);
+
+  Vector<RowNum> rowNums;  rowNums. reserve (rowsSize);
+  for (const Item& item : items)
+    rowNums << item. second;
+
+  return rowNums;
+}
+
+
+
+TextTable ColumnTextTable::group (const StringVector &by,
+                                  const StringVector &sum,
+                                  const StringVector &minV,
+                                  const StringVector &maxV,
+                                  const StringVector &aggr,
+                                  const string &countName) const
+{
+  const Vector<ColNum> byIndex   (columns2nums (by));
+  const Vector<ColNum> sumIndex  (columns2nums (sum));
+  const Vector<ColNum> minIndex  (columns2nums (minV));
+  const Vector<ColNum> maxIndex  (columns2nums (maxV));
+  const Vector<ColNum> aggrIndex (columns2nums (aggr));
+
+  StringVector newNames;
+  const auto rename = [this,&newNames] (const StringVector &cols, const string &suffix)
+                        { StringVector renamed;
+                          for (const string& s : cols)
+                          { const string newName (s + suffix);
+                            if (hasColumn (newName) || newNames. contains (newName))
+                              throw runtime_error ("Table already has column " + strQuote (newName));
+                            newNames << newName;
+                            renamed << newName;
+                          }
+                          return renamed;
+                        };
+        StringVector sumNames (rename (sum,  "_sum"));
+  const StringVector minNames (rename (minV, "_min"));
+  const StringVector maxNames (rename (maxV, "_max"));
+  if (! countName. empty ())
+  {
+    if (hasColumn (countName) || newNames. contains (countName))
+      throw runtime_error ("Table already has column " + strQuote (countName));
+    sumNames << countName;
+  }
+
+  // QC
+  {
+    ColumnPartitionQC cp;
+    cp. add (by, "group by");
+    cp. add (sumNames, "sum");
+    cp. add (minNames, "min");
+    cp. add (maxNames, "max");
+    cp. add (aggr, "aggregation");
+  }
+  FFOR (size_t, i, sum. size ())
+    if (! header [sumIndex [i]]. numeric)
+      throw runtime_error ("Summation column " + strQuote (sumNames [i]) + " is not numeric");
+
+  TextTable out (pound, Vector<Header> ());
+  out. name = name;
+  {
+    const auto addHeader = [this,&out] (const Vector<ColNum> &colNums, const StringVector &names)
+                             { FFOR (size_t, i, colNums. size ())
+                               { out. header << header [colNums [i]];
+                                 out. header. back (). name = names [i];
+                               }
+                             };
+    addHeader (byIndex, by);
+    addHeader (sumIndex, sumNames);
+    if (! countName. empty ())
+      out. header << Header (countName);  // numeric
+    addHeader (minIndex, minNames);
+    addHeader (maxIndex, maxNames);
+    addHeader (aggrIndex, aggr);
+  }
+
+  // Output columns
+  Vector<ColNum> colNums;
+  colNums << byIndex << sumIndex;
+  const size_t countPos = countName. empty () ? no_index : colNums. size ();
+  if (! countName. empty ())
+    colNums << no_index;
+  const size_t minStart = colNums. size ();
+  colNums << minIndex;
+  const size_t maxStart = colNums. size ();
+  colNums << maxIndex;
+  const size_t aggrStart = colNums. size ();
+  colNums << aggrIndex;
+  ASSERT (colNums. size () == out. header. size ());
+
+  // Requires: !to.empty(), !cell(row,col).empty()
+  const auto cmp = [this] (const string &to, RowNum row, ColNum col)
+                     { if (header [col]. numeric)
+                       { const double a = stod (to);
+                         const double b = columns [col]. numbers [row];
+                         if (a < b)
+                           return -1;
+                         if (a > b)
+                           return 1;
+                         return 0;
+                       }
+                       const int res = string_view (to). compare (cell (row, col));
+                       if (res < 0)
+                         return -1;
+                       if (res > 0)
+                         return 1;
+                       return 0;
+                     };
+
+  RowNum groupRow = no_index;
+  for (const RowNum row : sort (by))
+  {
+    if (groupRow != no_index && sameRow (groupRow, row, byIndex))
+    {
+      // Merge row into out.rows.back()
+      StringVector& to = out. rows. back ();
+      FOR_START (size_t, i, by. size (), minStart)
+      {
+        const Header& h = out. header [i];
+        ASSERT (h. numeric);
+        ostringstream oss;
+        ONumber on (oss, h. decimals, h. scientific);
+        const double d1 = to [i]. empty () ? 0.0 : stod (to [i]);
+        const double d2 = i == countPos ? 1.0 : columns [colNums [i]]. numbers [row];
+        oss << (d1 + d2);
+        to [i] = oss. str ();
+      }
+      FOR_START (size_t, i, minStart, maxStart)
+      {
+        const ColNum col = colNums [i];
+        const string_view from (cell (row, col));
+        if (   to [i]. empty ()
+            || (! from. empty () && cmp (to [i], row, col) == 1)
+           )
+          to [i] = from;
+      }
+      FOR_START (size_t, i, maxStart, aggrStart)
+      {
+        const ColNum col = colNums [i];
+        const string_view from (cell (row, col));
+        if (   to [i]. empty ()
+            || (! from. empty () && cmp (to [i], row, col) == -1)
+           )
+          to [i] = from;
+      }
+      FOR_START (size_t, i, aggrStart, colNums. size ())
+      {
+        const string_view from (cell (row, colNums [i]));
+        if (from. empty ())
+          continue;
+        if (to [i]. empty ())
+          to [i] = from;
+        else
+        {
+          StringVector vec (to [i], TextTable::aggr_sep, true);
+          vec << string (from);
+          vec. sort ();
+          vec. uniq ();
+          to [i] = vec. toString (string (1, TextTable::aggr_sep));
+        }
+      }
+    }
+    else
+    {
+      groupRow = row;
+      StringVector values;  values. reserve (colNums. size ());
+      FFOR (size_t, i, colNums. size ())
+        if (i == countPos)
+          values << "1";
+        else
+          values << string (cell (row, colNums [i]));
+      out. rows << move (values);
+    }
+  }
+
+  return out;
+}
+
+
+
+void ColumnTextTable::getRow (RowNum row,
+                              string &s) const
+{
+  s. clear ();
+  FFOR (ColNum, i, columns. size ())
+  {
+    if (i)
+      s += '\t';
+    s += columns [i]. cells [row];
+  }
+}
+
+
+
+
+// ColumnTextTable::Index
+
+
+ColumnTextTable::Index::Index (const ColumnTextTable &tab_arg,
+                               const StringVector &columns)
+: tab (tab_arg)
+, colNums (tab. columns2nums (columns))
+{
+  hashes. resize (tab. rowsSize, 0);
+  nextRows. resize (tab. rowsSize, no_index);
+  {
+    size_t buckets_size = 1;
+    while (buckets_size < tab. rowsSize)
+      buckets_size *= 2;
+    buckets. resize (buckets_size, no_index);
+  }
+  
+  vector<Notype> notypes;
+  arrayThreads (true, setHashes, tab. rowsSize, notypes, ref (*this));
+
+  // Rows are partitioned by ranges of buckets, a range is processed by one thread
+  size_t parts = 1;
+  while (parts < threads_max && parts < buckets. size ())
+    parts *= 2;
+  const size_t bucketsPerPart = buckets. size () / parts;
+  const size_t mask = buckets. size () - 1;
+  Vector<Vector<RowNum>> partRows (parts);
+  for (Vector<RowNum>& rows : partRows)
+    rows. reserve (tab. rowsSize / parts + 1);
+  FFOR (RowNum, row, tab. rowsSize)
+    partRows [(hashes [row] & mask) / bucketsPerPart] << row;
+  arrayThreads (true, setBuckets, parts, notypes, ref (*this), cref (partRows));
+}
+
+
+
+void ColumnTextTable::Index::setHashes (size_t from,
+                                        size_t to,
+                                        Notype& /*res*/,
+                                        Index &index)
+{
+  vector<string_view> values (index. colNums. size ());
+  FOR_START (RowNum, row, from, to)
+  {
+    FFOR (size_t, i, values. size ())
+      values [i] = index. tab. cell (row, index. colNums [i]);
+    index. hashes [row] = values2hash (values);
+  }
+}
+
+
+
+void ColumnTextTable::Index::setBuckets (size_t from,
+                                         size_t to,
+                                         Notype& /*res*/,
+                                         Index &index,
+                                         const Vector<Vector<RowNum>> &partRows)
+// Update: index.buckets[], index.nextRows[] of partRows[from,to)
+{
+  const size_t mask = index. buckets. size () - 1;
+  FOR_START (size_t, part, from, to)
+  {
+    const Vector<RowNum>& rows = partRows [part];
+    FOR_REV (size_t, i, rows. size ())
+    {
+      const RowNum row = rows [i];
+      const size_t bucket = index. hashes [row] & mask;
+      index. nextRows [row] = index. buckets [bucket];
+      index. buckets [bucket] = row;
+    }
+  }
+}
+
+#endif
+
+
+
+}
@@ -69,6 +69,11 @@ struct TextTable : Named
       : Named (name_arg)
       {}
     void qc () const override;
+    void addField (string_view field);
+      // Update: null, len_max, choices, numeric, scientific, decimals
+    void addNumericLen (string_view field);
+      // Update: len_max
+      // Requires: addField() has been applied to all fields of the column
     void saveText (ostream& os) const override
       { os         << name 
            << '\t' << len_max 
@@ -89,7 +94,7 @@ struct TextTable : Named
     
   struct Error : runtime_error
   {
-    Error (const TextTable &tab,
+    Error (const Named &tab,
            const string &what)
       : runtime_error (what + "\nIn table file: " + tab. name)
       {}
@@ -106,6 +111,10 @@ struct TextTable : Named
     : pound (pound_arg)
     , header (header_arg)
     {}
+  static void renameColumns (Vector<Header> &header,
+                             const string &columnSynonymsFName,
+                             const string &tableName);
+    // Input: columnSynonymsFName: syn_format
 private:
   void setHeader ();
 public:
@@ -113,10 +122,14 @@ public:
   void saveText (ostream &os) const override;    
         
   
-  static bool getDecimals (string s,
+  static bool getDecimals (string_view s,
                            bool &hasPoint,
                            streamsize &decimals);
     // Return: true => scientific number
+  static bool str2number (string_view s,
+                          double &d);
+    // Return: strtod() consumes s entirely
+    // Output: d
   void printHeader (ostream &os) const;
   ColNum col2num_ (const string &columnName) const;
     // Retuirn: no_index <=> no columnName
@@ -126,9 +139,9 @@ public:
         throw Error (*this, "Table has no column " + strQuote (columnName));
       return i;
     }
-  Vector<ColNum> columns2nums (const StringVector &columns) const
-    { Vector<ColNum> nums;  nums. reserve (columns. size ());
-      for (const string &s : columns)
+  Vector<ColNum> columns2nums (const StringVector &columnNames) const
+    { Vector<ColNum> nums;  nums. reserve (columnNames. size ());
+      for (const string &s : columnNames)
         nums << col2num (s);
       return nums;
     }
@@ -216,6 +229,174 @@ public:
 };
 
 
+
+#ifndef _MSC_VER
+struct ColumnTextTable : Named
+// Read-only TextTable stored by columns
+// Cells are views into the memory-mapped table file
+// name: file name
+{
+  typedef  TextTable::Header  Header;
+  typedef  TextTable::ColNum  ColNum;
+  typedef  TextTable::RowNum  RowNum;
+
+  bool pound {false};
+    // '#' in the beginning of header
+  Vector<Header> header;
+    // size() = number of columns
+  struct Column
+  {
+    Vector<string_view> cells;
+      // size() = rowsSize
+      // Trimmed
+    Vector<double> numbers;
+      // empty() <=> !Header::numeric
+      // Empty cell => 0.0
+  };
+  Vector<Column> columns;
+    // size() = header.size()
+  RowNum rowsSize {0};
+private:
+  unique_ptr<const MappedFile> mf;
+public:
+
+
+  explicit ColumnTextTable (const string &tableFName,
+                            const string &columnSynonymsFName = string(),
+                            bool typed = true);
+    // columnSynonymsFName: TextTable::syn_format
+    // Cells and Header's are the same as in TextTable(tableFName,columnSynonymsFName)
+    // !typed => all columns are non-numeric, Header statistics are not computed
+  void qc () const override;
+
+  static void splitLine (string_view line,
+                         Vector<string_view> &fields);
+    // The same fields as StringVector(line,'\t',true)
+    // Output: fields
+
+
+  string_view cell (RowNum row,
+                    ColNum col) const
+    { return columns [col]. cells [row]; }
+  void printHeader (ostream &os) const;
+  ColNum col2num_ (const string &columnName) const;
+    // Return: no_index <=> no columnName
+  ColNum col2num (const string &columnName) const
+    { const ColNum i = col2num_ (columnName);
+      if (i == no_index)
+        throw TextTable::Error (*this, "Table has no column " + strQuote (columnName));
+      return i;
+    }
+  Vector<ColNum> columns2nums (const StringVector &columnNames) const
+    { Vector<ColNum> nums;  nums. reserve (columnNames. size ());
+      for (const string &s : columnNames)
+        nums << col2num (s);
+      return nums;
+    }
+  bool hasColumn (const string &columnName) const
+    { return col2num_ (columnName) != no_index; }
+  int compare (RowNum row1,
+               RowNum row2,
+               ColNum col) const;
+    // Return: -1, 0, 1
+    // Numeric columns are compared by Column::numbers
+  bool sameRow (RowNum row1,
+                RowNum row2,
+                const Vector<ColNum> &colNums) const
+    { for (const ColNum col : colNums)
+        if (cell (row1, col) != cell (row2, col))
+          return false;
+      return true;
+    }
+private:
+  Vector<double> getRanks (ColNum col) const;
+    // Return: ranks of the cells among the sorted distinct cells of col
+public:
+  Vector<RowNum> sort (const StringVector &by) const;
+    // Return: permutation of rows, the same order as TextTable::sort(by)
+  TextTable group (const StringVector &by,
+                   const StringVector &sum,
+                   const StringVector &minV,
+                   const StringVector &maxV,
+                   const StringVector &aggr,
+                   const string &countName) const;
+    // Return: columns: by + sum + countName + minV + maxV + aggr
+    //   sum, minV, maxV columns are renamed to <name>_sum, <name>_min, <name>_max
+    //   !countName.empty() => number of rows in a group is the countName column
+  void getRow (RowNum row,
+               string &s) const;
+    // Output: s: tab-delimited row without EOL
+
+
+  struct Index
+  // Hash index of the key tuples of columns
+  {
+    const ColumnTextTable &tab;
+    const Vector<ColNum> colNums;
+  private:
+    Vector<size_t> hashes;
+      // size() = tab.rowsSize
+    Vector<RowNum> buckets;
+      // First row of a bucket, no_index <=> empty bucket
+      // size() = power of 2
+    Vector<RowNum> nextRows;
+      // Next row of the same bucket, rows of a bucket are increasing
+      // size() = tab.rowsSize
+  public:
+
+    Index (const ColumnTextTable &tab_arg,
+           const StringVector &columns);
+      // Threads are used if available
+
+    static size_t values2hash (const vector<string_view> &values)
+      { size_t ret = 0;
+        for (const string_view s : values)
+          ret = ret * 1000003 + hash<string_view>() (s);
+        return ret;
+      }
+    RowNum findFirst (const vector<string_view> &values,
+                      size_t hash) const
+      { return matchFrom (buckets [hash & (buckets. size () - 1)], values, hash); }
+      // Return: no_index <=> values are not found
+      // Input: hash = values2hash(values)
+    RowNum findNext (RowNum row,
+                     const vector<string_view> &values,
+                     size_t hash) const
+      { return matchFrom (nextRows [row], values, hash); }
+      // Return: next row after row with the same values, or no_index
+      // Input: row = findFirst() or findNext()
+  private:
+    RowNum matchFrom (RowNum row,
+                      const vector<string_view> &values,
+                      size_t hash) const
+      { while (row != no_index)
+        { if (hashes [row] == hash && matches (row, values))
+            return row;
+          row = nextRows [row];
+        }
+        return no_index;
+      }
+    bool matches (RowNum row,
+                  const vector<string_view> &values) const
+      { FFOR (size_t, i, colNums. size ())
+          if (tab. cell (row, colNums [i]) != values [i])
+            return false;
+        return true;
+      }
+    static void setHashes (size_t from,
+                           size_t to,
+                           Notype &res,
+                           Index &index);
+    static void setBuckets (size_t from,
+                            size_t to,
+                            Notype &res,
+                            Index &index,
+                            const Vector<Vector<RowNum>> &partRows);
+  };
+};
+#endif
+
+
 		
 }
 
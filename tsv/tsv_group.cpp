@@ -73,39 +73,21 @@ struct ThisApplication : Application
 		const string aggrS  = getArg ("aggr");
 
 
-    TextTable tt (fName);
+    const ColumnTextTable tt (fName);
     tt. qc ();
     if (verbose ())
       tt. printHeader (cout);      
     
     const StringVector by   (byS,   ',', true);
-          StringVector sum  (sumS,  ',', true);    
-          StringVector minV (minS, ',', true);    
-          StringVector maxV (maxS, ',', true);    
+    const StringVector sum  (sumS,  ',', true);    
+    const StringVector minV (minS, ',', true);    
+    const StringVector maxV (maxS, ',', true);    
     const StringVector aggr (aggrS, ',', true);    
 
-    for (string& s : sum)
-      tt. substitueColumn (s, s + "_sum");
-    for (string& s : minV)
-      tt. substitueColumn (s, s + "_min");
-    for (string& s : maxV)
-      tt. substitueColumn (s, s + "_max");
-
-    if (! countS. empty ())
-    { 
-      if ( tt. hasColumn (countS))
-        throw runtime_error ("Table already has column " + strQuote (countS));
-      tt. header << TextTable::Header (countS);  // numeric
-      for (StringVector& row : tt. rows)
-        row << "1";
-      tt. qc ();
-      sum << countS;
-    }
+    const TextTable out (tt. group (by, sum, minV, maxV, aggr, countS));
+    out. qc ();
     
-    tt. group (by, sum, minV, maxV, aggr);
-    tt. qc ();
-    
-    tt. saveText (cout);
+    out. saveText (cout);
 	}
 };
 
@@ -34,6 +34,9 @@
 #undef NDEBUG
 #include "../common.inc"
 
+#include <queue>
+#include <unistd.h>
+
 #include "../common.hpp"
 #include "tsv.hpp"
 using namespace Common_sp;
@@ -45,10 +48,279 @@ namespace
 {
   
   
+typedef  TextTable::ColNum  ColNum;
+typedef  TextTable::RowNum  RowNum;
+
+  
+  
+Vector<TextTable::Header> readHeader (const string &fName,
+                                      const string &synFName,
+                                      bool &pound)
+// Output: pound
+{
+  LineInput f (fName);
+  if (! f. nextLine ())
+    throw TextTable::Error (Named (fName), "Cannot read the table header");
+  pound = false;
+  if (! f. line. empty () && f. line. front () == '#')
+  {
+    pound = true;
+    f. line. erase (0, 1);
+  }
+  Vector<TextTable::Header> header;
+  {
+    StringVector h (f. line, '\t', true);
+    for (string& s : h)
+      header << move (TextTable::Header (move (s)));
+  }
+  TextTable::renameColumns (header, synFName, fName);
+  return header;
+}
+
+
+
+ColNum header2num (const Vector<TextTable::Header> &header,
+                   const string &name)
+{
+  FFOR (ColNum, i, header. size ())
+    if (header [i]. name == name)
+      return i;
+  return no_index;
+}
+
+
+
+struct Join
+{
+  Vector<ColNum> keyColNums1;
+  Vector<ColNum> addedColNums2;
+  bool leftjoin {false};
+  bool remove {false};
+  string leftPadding;
+    // Empty fields of the columns added from table2
+
+  void joinRow (ostream &os,
+                string_view prefix,
+                string_view row1,
+                const vector<string_view> &key,
+                const ColumnTextTable &t2,
+                const ColumnTextTable::Index &index2) const
+    // Output: os: joined rows, each row is preceded by prefix
+    { const size_t hash = ColumnTextTable::Index::values2hash (key);
+      RowNum row2 = index2. findFirst (key, hash);
+      if (row2 == no_index)
+      { if (remove || leftjoin)
+        { os << prefix << row1;
+          if (leftjoin)
+            os << leftPadding;
+          os << '\n';
+        }
+        return;
+      }
+      if (remove)
+        return;
+      while (row2 != no_index)
+      { os << prefix << row1;
+        for (const ColNum col2 : addedColNums2)
+          os << '\t' << t2. cell (row2, col2);
+        os << '\n';
+        row2 = index2. findNext (row2, key, hash);
+      }
+    }
+};
+
+
+
+// In-memory hash join
+
+void joinRows (size_t from,
+               size_t to,
+               string &res,
+               RowNum rowStart,
+               const ColumnTextTable &t1,
+               const ColumnTextTable &t2,
+               const ColumnTextTable::Index &index2,
+               const Join &join)
+// Output: res: joined rows rowStart + [from,to) of t1
+{
+  ostringstream oss;
+  string row1;
+  vector<string_view> key (join. keyColNums1. size ());
+  FOR_START (RowNum, row, rowStart + from, rowStart + to)
+  {
+    FFOR (size_t, i, key. size ())
+      key [i] = t1. cell (row, join. keyColNums1 [i]);
+    t1. getRow (row, row1);
+    join. joinRow (oss, string_view (), row1, key, t2, index2);
+  }
+  res = oss. str ();
+}
+
+
+
+// Spill-to-disk join
+// Rows of both tables are partitioned by the key hash into temporary files, partitions are joined in parallel,
+// the joined partitions are merged by the row numbers of table1
+
+size_t hash2part (size_t hash,
+                  size_t parts)
+  { return (hash >> (sizeof (size_t) * 4)) % parts; }
+  // Index::findFirst() uses the low bits
+
+
+
+struct TmpDir : Nocopy
+// Temporary directory: ($TMPDIR or "/tmp") + "/" + programName + "XXXXXX"
+{
+  string name;
+  
+  explicit TmpDir (const string &programName)
+    { const char* s = getenv ("TMPDIR");
+      const string tmpDir (s ? s : "/tmp");
+      name = tmpDir + "/" + programName + ".XXXXXX";
+      if (! mkdtemp (& name [0]))
+        throw runtime_error ("Error creating a temporary directory in " + tmpDir);
+    }
+ ~TmpDir ()
+    { removeDirectory (name); }
+};
+
+
+
+void partitionTable (const string &fName,
+                     size_t columns,
+                     const Vector<ColNum> &keyColNums,
+                     bool isTable1,
+                     const string &headerLine,
+                     const string &partPrefix,
+                     size_t parts)
+// isTable1: rows start with the row number, rows with empty keys are errors
+// !isTable1: partitions have headerLine, rows with empty keys are skipped
+{
+  vector<unique_ptr<OFStream>> partFiles;  partFiles. reserve (parts);
+  FFOR (size_t, part, parts)
+  {
+    partFiles. push_back (unique_ptr<OFStream> (new OFStream (partPrefix + to_string (part))));
+    if (! isTable1)
+      *partFiles. back () << headerLine << '\n';
+  }
+
+  LineInput f (fName, 100000);  // PAR
+  EXEC_ASSERT (f. nextLine ());  // header
+  Vector<string_view> fields;
+  vector<string_view> key (keyColNums. size ());
+  RowNum rowNum = 0;
+  while (f. nextLine ())
+  {
+    ColumnTextTable::splitLine (f. line, fields);
+    rowNum++;
+    if (fields. size () != columns)
+      throw TextTable::Error (Named (fName), "Row " + to_string (rowNum) + " contains " + to_string (fields. size ()) + " columns whereas header has " + to_string (columns) + " columns");
+    bool emptyKey = false;
+    FFOR (size_t, i, key. size ())
+    {
+      key [i] = fields [keyColNums [i]];
+      if (key [i]. empty ())
+        emptyKey = true;
+    }
+    if (emptyKey)
+    {
+      if (isTable1)
+        throw TextTable::Error (Named (fName), "Empty value in index, in row " + to_string (rowNum));
+      continue;
+    }
+    OFStream& part = *partFiles [hash2part (ColumnTextTable::Index::values2hash (key), parts)];
+    if (isTable1)
+      part << rowNum - 1 << '\t';
+    FFOR (size_t, i, fields. size ())
+    {
+      if (i)
+        part << '\t';
+      part << fields [i];
+    }
+    part << '\n';
+  }
+  
+  for (const unique_ptr<OFStream>& part : partFiles)
+    if (! part->good ())
+      throw runtime_error ("Cannot write a temporary file " + strQuote (partPrefix + "*"));
+}
+
+
+
+void joinParts (size_t from,
+                size_t to,
+                Notype& /*res*/,
+                const string &partPrefix1,
+                const string &partPrefix2,
+                const string &partPrefixOut,
+                const StringVector &commonCols,
+                const Join &join)
+// Output: files partPrefixOut + <part> with rows: <row number in table1> <tab> <joined row>
+{
+  Vector<string_view> fields;
+  vector<string_view> key (join. keyColNums1. size ());
+  FOR_START (size_t, part, from, to)
+  {
+    const ColumnTextTable t2 (partPrefix2 + to_string (part), string (), false);
+    const ColumnTextTable::Index index2 (t2, commonCols);
+    LineInput f1 (partPrefix1 + to_string (part));
+    OFStream out (partPrefixOut + to_string (part));
+    while (f1. nextLine ())
+    {
+      const string_view line (f1. line);
+      const size_t tab = line. find ('\t');
+      QC_ASSERT (tab != string_view::npos);
+      const string_view prefix (line. substr (0, tab + 1));
+      const string_view row1   (line. substr (tab + 1));
+      ColumnTextTable::splitLine (row1, fields);
+      FFOR (size_t, i, key. size ())
+        key [i] = fields [join. keyColNums1 [i]];
+      join. joinRow (out, prefix, row1, key, t2, index2);
+    }
+    if (! out. good ())
+      throw runtime_error ("Cannot write a temporary file " + strQuote (partPrefixOut + to_string (part)));
+  }
+}
+
+
+
+void mergeParts (const string &partPrefixOut,
+                 size_t parts,
+                 ostream &os)
+{
+  vector<unique_ptr<LineInput>> partFiles;  partFiles. reserve (parts);
+  typedef  pair<RowNum,size_t/*part*/>  Item;
+  priority_queue<Item, vector<Item>, greater<Item>> heap;
+  const auto next = [&partFiles, &heap] (size_t part)
+    { LineInput& f = *partFiles [part];
+      if (f. nextLine ())
+        heap. push (Item ((RowNum) stoull (f. line), part));
+    };
+  FFOR (size_t, part, parts)
+  {
+    partFiles. push_back (unique_ptr<LineInput> (new LineInput (partPrefixOut + to_string (part))));
+    next (part);
+  }
+  // The rows of the same row number are consecutive in one part
+  while (! heap. empty ())
+  {
+    const size_t part = heap. top (). second;
+    heap. pop ();
+    const string& line = partFiles [part] -> line;
+    const size_t tab = line. find ('\t');
+    ASSERT (tab != string::npos);
+    os << line. c_str () + tab + 1 << '\n';
+    next (part);
+  }
+}
+
+
+  
 struct ThisApplication : Application
 {
   ThisApplication ()
-    : Application ("Join 2 tsv-tables by identical columns, print the result")
+    : Application ("Join 2 tsv-tables by identical columns, print the result.\nHash join in memory or, if the tables are larger than <memory>, join of the hash partitions of the tables in temporary files ($TMPDIR or \"/tmp\")")
   	{
       version = VERSION;
   	  addPositional ("table1", "tsv-table");
@@ -57,6 +329,7 @@ struct ThisApplication : Application
   	  addFlag ("left", "SQL left join");
   	  addFlag ("remove", "Remove the rows from <table1> which are in <table2>");
   	  addKey ("common", "Output file to print common columns");
+  	  addKey ("memory", "Max. size of the tables in Mb for the in-memory join. 0 - half of the physical memory", "0");
   	}
   	
   	
@@ -69,22 +342,45 @@ struct ThisApplication : Application
 		const bool   leftjoin    = getFlag ("left");
     const bool   remove      = getFlag ("remove");  
     const string commonFName = getArg ("common");
+          size_t memory_max  = (size_t) arg2uint ("memory") * 1024 * 1024;
     
     QC_IMPLY (remove, ! leftjoin);
+    
+    
+    if (! memory_max)
+      memory_max = (size_t) sysconf (_SC_PHYS_PAGES) * (size_t) sysconf (_SC_PAGE_SIZE) / 2;
+    const size_t tablesSize = (size_t) (getFileSize (tab1FName) + getFileSize (tab2FName));
+    const bool inMemory = tablesSize <= memory_max;
 		
 
-    const TextTable t1 (tab1FName, synFName);
-    t1. qc ();    
-    
-    const TextTable t2 (tab2FName, synFName);
-    t2. qc ();    
+    unique_ptr<const ColumnTextTable> t1;
+    unique_ptr<const ColumnTextTable> t2;
+    bool pound1 = false;
+    Vector<TextTable::Header> header1;
+    Vector<TextTable::Header> header2;
+    if (inMemory)
+    {
+      t1. reset (new ColumnTextTable (tab1FName, synFName, false));
+      t1->qc ();    
+      t2. reset (new ColumnTextTable (tab2FName, synFName, false));
+      t2->qc ();    
+      pound1  = t1->pound;
+      header1 = t1->header;
+      header2 = t2->header;
+    }
+    else
+    {
+      header1 = readHeader (tab1FName, synFName, pound1);
+      bool pound2 = false;
+      header2 = readHeader (tab2FName, synFName, pound2);
+    }
     
     StringVector commonCols;
     {
-      for (const TextTable::Header& h : t1. header)
+      for (const TextTable::Header& h : header1)
         commonCols << h. name;
       FOR_REV (size_t, i, commonCols. size ())
-        if (! t2. hasColumn (commonCols [i]))
+        if (header2num (header2, commonCols [i]) == no_index)
           commonCols. eraseAt (i);
       {
         StringVector s (commonCols);
@@ -93,7 +389,7 @@ struct ThisApplication : Application
         if (i != no_index)
           throw runtime_error ("Duplicate common column in " + strQuote (tab1FName) + ": " + s [i]);
         StringVector s2;
-        for (const TextTable::Header& h : t2. header)
+        for (const TextTable::Header& h : header2)
           if (s. containsFast (h. name))
             s2 << h. name;
         for (const string& name : s)
@@ -113,62 +409,80 @@ struct ThisApplication : Application
         f << endl;
       }
     }
-    ASSERT (commonCols. size () <= t1. header. size ());
-    ASSERT (commonCols. size () <= t2. header. size ());
-      
-    const TextTable::Index index (t2, commonCols);        
+    ASSERT (commonCols. size () <= header1. size ());
+    ASSERT (commonCols. size () <= header2. size ());
 
 
-    TextTable tOut (t1. pound, t1. header);
+    TextTable tOut (pound1, header1);
     tOut. name = "Output";
-    {
-      Vector<TextTable::ColNum> addedColNums;
-      if (! remove)
-        FOR (TextTable::ColNum, colNum, t2. header. size ())
+    Join join;
+    join. leftjoin = leftjoin;
+    join. remove = remove;
+    join. leftPadding = string (header2. size () - commonCols. size (), '\t');
+    if (! remove)
+      FOR (ColNum, colNum, header2. size ())
+      {
+        const TextTable::Header& h = header2 [colNum];
+        if (! commonCols. contains (h. name))
         {
-          const TextTable::Header& h = t2. header [colNum];
-          if (! commonCols. contains (h. name))
-          {
-            tOut. header << h;
-            addedColNums << colNum;
-          }
+          tOut. header << h;
+          join. addedColNums2 << colNum;
         }
+      }
+    tOut. qc ();    
+    for (const string& name : commonCols)
+      join. keyColNums1 << header2num (header1, name);
+      
+
+    if (inMemory)
+    {
+      FOR (RowNum, row1, t1->rowsSize)
+        for (const ColNum col1 : join. keyColNums1)
+          if (t1->cell (row1, col1). empty ())
+            throw TextTable::Error (*t1, "Empty value in index, in row " + to_string (row1 + 1));
+          
+      const ColumnTextTable::Index index2 (*t2, commonCols);        
 
-      const Vector<TextTable::ColNum> indexColNums1 (t1. columns2nums (commonCols));     
-      StringVector indexValues;
-      StringVector values2;
-      StringVector outValues;
-      FOR (TextTable::RowNum, rowNum1, t1. rows. size ())
+      tOut. saveText (cout);
+      // Rows of tOut are streamed
+      constexpr RowNum block_size = 1000000;  // PAR
+      for (RowNum rowStart = 0; rowStart < t1->rowsSize; rowStart += block_size)
       {
-        t1. colNumsRow2values (indexColNums1, rowNum1, indexValues);
-        for (const string& s : indexValues)
-          if (s. empty ())
-            throw TextTable::Error (t1, "Empty value in index, in row " + to_string (rowNum1 + 1));
-        if (const Vector<TextTable::RowNum>* rowNums2 = index. find (indexValues))
-        {
-          ASSERT (! rowNums2->empty ());
-          if (! remove)
-            for (TextTable::RowNum rowNum2 : *rowNums2)
-            {
-              t2. colNumsRow2values (addedColNums, rowNum2, values2);
-              outValues. clear ();
-              outValues << t1. rows [rowNum1] << values2;
-              tOut. rows << move (outValues);
-            }
-        }
-        else 
-        {
-          if (remove || leftjoin)
-          {
-            tOut. rows << move (t1. rows [rowNum1]);
-            if (leftjoin)
-              tOut. rows. back (). resize (t1. header. size () + t2. header. size () - commonCols. size ());
-          }
-        }
+        vector<string> blocks;
+        arrayThreads (true, joinRows, min (block_size, t1->rowsSize - rowStart), blocks, rowStart, cref (*t1), cref (*t2), cref (index2), cref (join));
+        for (const string& block : blocks)
+          cout << block;
       }
     }
-    tOut. qc ();    
-    tOut. saveText (cout);
+    else
+    {
+      Vector<ColNum> keyColNums2;
+      for (const string& name : commonCols)
+        keyColNums2 << header2num (header2, name);
+      string headerLine2;
+      for (const TextTable::Header& h : header2)
+      {
+        if (! headerLine2. empty ())
+          headerLine2 += '\t';
+        headerLine2 += h. name;
+      }
+      
+      // Partition in memory takes ~3 times its size
+      const size_t parts = min<size_t> (256, max<size_t> (threads_max, 3 * threads_max * tablesSize / memory_max + 1));  // PAR
+      const TmpDir tmp (programName);
+      const string partPrefix1   (tmp. name + "/t1.");
+      const string partPrefix2   (tmp. name + "/t2.");
+      const string partPrefixOut (tmp. name + "/out.");
+      partitionTable (tab1FName, header1. size (), join. keyColNums1, true,  string (),   partPrefix1, parts);
+      partitionTable (tab2FName, header2. size (), keyColNums2,       false, headerLine2, partPrefix2, parts);
+      {
+        vector<Notype> notypes;
+        arrayThreads (true, joinParts, parts, notypes, cref (partPrefix1), cref (partPrefix2), cref (partPrefixOut), cref (commonCols), cref (join));
+      }
+      
+      tOut. saveText (cout);
+      mergeParts (partPrefixOut, parts, cout);
+    }
 	}
 };
 
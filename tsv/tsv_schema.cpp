@@ -60,7 +60,7 @@ struct ThisApplication : Application
 	{
 		const string fName = getArg ("table");
 
-    const TextTable tt (fName);
+    const ColumnTextTable tt (fName);
     tt. qc ();
     tt. printHeader (cout);      
 	}
@@ -149,7 +149,7 @@ struct ThisApplication : Application
 		             consistent = getFlag ("consistent");
 
 
-    TextTable tt (tableFName);
+    ColumnTextTable tt (tableFName);
     tt. qc ();
     FFOR (size_t, i, tt. header. size ())
     {
@@ -157,7 +157,7 @@ struct ThisApplication : Application
       maximize (h. len_max, max (h. name. size (), to_string (i + 1). size ()));
     }
     
-    if (tt. rows. empty ())
+    if (! tt. rowsSize)
     {
       cout << "No data" << endl;
       return;
@@ -177,7 +177,7 @@ struct ThisApplication : Application
     NCurses nc (true);
     bool quit = false;
     Vector<bool> rowFound;
-    rowFound. resize (tt. rows. size (), false);
+    rowFound. resize (tt. rowsSize, false);
     while (! quit)
     {
       nc. resize ();
@@ -185,7 +185,7 @@ struct ThisApplication : Application
       const size_t fieldSize = nc. row_max - (headerSize + 1 /*menu row*/); 
       const size_t pageScroll = fieldSize - 1;
       const size_t bottomIndex_max = topIndex + fieldSize;
-      const size_t bottomIndex = min (tt. rows. size (), bottomIndex_max);
+      const size_t bottomIndex = min (tt. rowsSize, bottomIndex_max);
       ASSERT (topIndex <= curIndex);
       ASSERT (curIndex < bottomIndex);
       if (   nc. row_max > headerSize + 2
@@ -205,7 +205,7 @@ struct ThisApplication : Application
           StringVector values;
           FFOR_START (size_t, j, curCol, tt. header. size ())
             values << tt. header [j]. name;
-          curLastCol = printRow (true, values, curCol, tt. header, nc. col_max, tt. rows. size ());
+          curLastCol = printRow (true, values, curCol, tt. header, nc. col_max, tt. rowsSize);
         }        
         if (numP)
         {
@@ -214,7 +214,7 @@ struct ThisApplication : Application
           StringVector values;
           FFOR_START (size_t, j, curCol, tt. header. size ())
             values << to_string (j + 1);
-          printRow (true, values, curCol, tt. header, nc. col_max, tt. rows. size ()); 
+          printRow (true, values, curCol, tt. header, nc. col_max, tt. rowsSize); 
         }
         move ((int) (fieldSize + headerSize), 0);
       #if 0
@@ -232,9 +232,9 @@ struct ThisApplication : Application
                             );
             // Non-character keys may be intercepted by the terminal
         #ifdef NUM_P
-          const string posS ("  " + to_string (curIndex + 1) + " / " + to_string (tt. rows. size ()));
+          const string posS ("  " + to_string (curIndex + 1) + " / " + to_string (tt. rowsSize));
         #else
-          const string posS ("  [Row " + to_string (curIndex + 1) + "/" + to_string (tt. rows. size ()) + "  Col " + to_string (curCol + 1) + "/" + to_string (tt. header. size ()) + "]");
+          const string posS ("  [Row " + to_string (curIndex + 1) + "/" + to_string (tt. rowsSize) + "  Col " + to_string (curCol + 1) + "/" + to_string (tt. header. size ()) + "]");
         #endif
           if (nc. col_max > posS. size ())
             addstr ((pad (keyS, nc. col_max - posS. size (), etrue) + posS). c_str ());
@@ -249,8 +249,8 @@ struct ThisApplication : Application
           const NCAttr attrFound (A_BOLD, rowFound [i]);
           StringVector values;
           FFOR_START (size_t, j, curCol, tt. header. size ())
-            values << tt. rows [i] [j];
-          printRow (false, values, curCol, tt. header, nc. col_max, tt. rows. size ());
+            values << string (tt. cell (i, j));
+          printRow (false, values, curCol, tt. header, nc. col_max, tt. rowsSize);
         }
         FFOR_START (size_t, i, bottomIndex, bottomIndex_max)
         {
@@ -277,7 +277,7 @@ struct ThisApplication : Application
             quit = true;
             break;
           case KEY_DOWN:
-            if (curIndex + 1 < tt. rows. size ())
+            if (curIndex + 1 < tt. rowsSize)
             {
               curIndex++;
               if (curIndex == bottomIndex)
@@ -298,13 +298,13 @@ struct ThisApplication : Application
             break;
           case 'f':  
           case KEY_NPAGE:
-            if (curIndex + 1 == tt. rows. size ())
+            if (curIndex + 1 == tt. rowsSize)
               beep ();
             else if (curIndex + 1 < bottomIndex)
               curIndex = bottomIndex - 1;
             else
             {
-              curIndex = min (tt. rows. size (), bottomIndex + pageScroll) - 1;
+              curIndex = min (tt. rowsSize, bottomIndex + pageScroll) - 1;
               topIndex = curIndex - pageScroll;
             }
             break;
@@ -335,12 +335,12 @@ struct ThisApplication : Application
             break;
           case 'F':
           case KEY_END:
-            if (curIndex == tt. rows. size () - 1)
+            if (curIndex == tt. rowsSize - 1)
               beep ();
             else
             {
-              curIndex = tt. rows. size () - 1;
-              topIndex = tt. rows. size () >= fieldSize ? tt. rows. size () - fieldSize : 0;
+              curIndex = tt. rowsSize - 1;
+              topIndex = tt. rowsSize >= fieldSize ? tt. rowsSize - fieldSize : 0;
             }
             break;
           case KEY_LEFT:
@@ -390,12 +390,11 @@ struct ThisApplication : Application
               }
               bool globalFound = false;
               bool curIndexSet = false;
-              FFOR (size_t, i, tt. rows. size ())
+              FFOR (size_t, i, tt. rowsSize)
               {
                 bool found = false;
-                const StringVector& row = tt. rows [i];
-                for (const string& s : row)
-                  if (contains (s, what))
+                FFOR (size_t, j, tt. header. size ())
+                  if (tt. cell (i, j). find (what) != string_view::npos)
                   {
                     found = true;
                     break;
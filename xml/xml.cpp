@@ -244,6 +244,7 @@ void Schema::merge (Schema& other)
       var_cast (sch) -> merge (* var_cast (it. second));
     else
     {
+      var_cast (it. second) -> parent = this;
       name2schema [it. first] = it. second;
       it. second = nullptr;
     }
@@ -271,6 +272,38 @@ void Schema::merge (Schema& other)
 
 
 
+void Schema::addChild (const string &childName,
+                      Schema* other)
+{
+  ASSERT (other);
+  ASSERT (other != this);
+  
+  other->parent = this;
+  if (const Schema* childSch = findPtr (name2schema, childName))
+  {
+    var_cast (childSch) -> multiple = true;
+    var_cast (childSch) -> merge (*other);
+    delete other;
+  }
+  else
+    name2schema [childName] = other;
+}
+
+
+
+void Schema::addToken (const Token &token)
+{
+  if (token. empty ())
+    return;
+    
+  types << token. type;
+  if (tokensStored)
+    tokens << token;
+  len_max = token. name. size ();
+}
+
+
+
 void Schema::printTableDdl (ostream &os,
                             const Schema* curTable) const
 { 
@@ -341,6 +374,16 @@ void Schema::printColumnDdl (ostream &os,
 
 
 
+void Schema::getTableNames (StringVector &tableNames) const
+{
+  if (multiple)
+    tableNames << getColumnName (nullptr);
+  for (const auto& it : name2schema)
+    it. second->getTableNames (tableNames);
+}
+
+
+
 void Schema::setFlatTables (const string &dirName,
                             const Schema* curTable) 
 { 
@@ -459,71 +502,60 @@ void Data::readInput (TokenInput &ti)
     return;
   }
 
+  readTag (ti, ti. get ());
+}
+
+
+
+void Data::readTag (TokenInput &ti,
+                    Token &&nameT)
+{
   // name, isEnd
+  if (nameT. isDelimiter ('/'))
+  {
+    isEnd = true;
+    nameT = move (ti. get ());
+  }
+  else if (nameT. isDelimiter ('!'))        
   {
-    Token nameT (ti. get ());
-    if (nameT. isDelimiter ('/'))
+    if (ti. getNextChar () == '-')
     {
-      isEnd = true;
-      nameT = move (ti. get ());
+      name = "!--";
+      token = move (ti. getXmlComment ());
     }
-    else if (nameT. isDelimiter ('!'))        
-    {
-      if (ti. getNextChar () == '-')
-      {
-        name = "!--";
-        token = move (ti. getXmlComment ());
-      }
-      else
-      {
-        nameT = ti. get ();
-        name = "!" + nameT. name;
-        token = move (ti. getXmlMarkupDeclaration ());        
-      }
-      return;
-    }
-    else if (nameT. isDelimiter ('?'))  
+    else
     {
-      name = "ProcessingInstruction";
-      token = move (ti. getXmlProcessingInstruction ());
-      return;
+      nameT = ti. get ();
+      name = "!" + nameT. name;
+      token = move (ti. getXmlMarkupDeclaration ());        
     }
-    if (nameT. type != Token::eName)
-      ti. error ("Name");
-    name = move (nameT. name);
-    if (readColonName (ti, name))
-      colonInName = true;
+    return;
   }
+  else if (nameT. isDelimiter ('?'))  
+  {
+    name = "ProcessingInstruction";
+    token = move (ti. getXmlProcessingInstruction ());
+    return;
+  }
+  if (nameT. type != Token::eName)
+    ti. error ("Name");
+  name = move (nameT. name);
+  if (readColonName (ti, name))
+    colonInName = true;
+  
+  readBody (ti);
+}
+
+
+
+void Data::readBody (TokenInput &ti)
+{
+  ASSERT (! name. empty ());
   
   // children
   bool finished = false;
-  for (;;)
-  {
-    Token attr (ti. get ());
-    if (attr. isDelimiter ('/'))
-    {
-      finished = true;
-      ti. get ('>');
-      break;
-    }
-    if (attr. isDelimiter ('>'))
-      break;
-    if (attr. type != Token::eName)
-      ti. error ("Name");
-    bool colonInName_arg = false;
-    if (readColonName (ti, attr. name))
-      colonInName_arg = true;
-    ti. get ('=');
-    Token value (ti. get ());  
-    if (value. type != Token::eText)
-      ti. error ("Text");
-    trim (value. name);
-    for (char& c : value. name)
-      if ((uchar) c >= 127)
-        c = '?';
-    value. toNumberDate ();
-    children << new Data (this, true, colonInName_arg, move (attr. name), move (value));
-  }
+  while (Data* attr = readAttribute (ti, this, finished))
+    children << attr;
 
   if (isEnd)
   {
@@ -566,13 +598,7 @@ void Data::readInput (TokenInput &ti)
         children. deleteData ();
         delete xml;
         ti. get ('/');
-        Token end = move (ti. get ());
-        if (end. type != Token::eName)
-          ti. error ("Name");
-        readColonName (ti, end. name);
-        if (end. name != name)
-          ti. error ("Name " + strQuote (name));
-        ti. get ('>');
+        readEndTag (ti, name);
         break;
       }
       children << xml;
@@ -593,13 +619,7 @@ void Data::readInput (TokenInput &ti)
     }
   #endif
     ti. get ('/');
-    Token end (ti. get ());
-    if (end. type != Token::eName)
-      ti. error ("Name");
-    readColonName (ti, end. name);
-    if (end. name != name)
-      ti. error ("Name " + strQuote (name));
-    ti. get ('>');
+    readEndTag (ti, name);
   }
 }
 
@@ -627,6 +647,55 @@ bool Data::readColonName (TokenInput &ti,
 
 
 
+Data* Data::readAttribute (TokenInput &ti,
+                           Data* parent_arg,
+                           bool &finished)
+{
+  finished = false;
+  
+  Token attr (ti. get ());
+  if (attr. isDelimiter ('/'))
+  {
+    finished = true;
+    ti. get ('>');
+    return nullptr;
+  }
+  if (attr. isDelimiter ('>'))
+    return nullptr;
+  if (attr. type != Token::eName)
+    ti. error ("Name");
+  bool colonInName_arg = false;
+  if (readColonName (ti, attr. name))
+    colonInName_arg = true;
+  ti. get ('=');
+  Token value (ti. get ());  
+  if (value. type != Token::eText)
+    ti. error ("Text");
+  trim (value. name);
+  for (char& c : value. name)
+    if ((uchar) c >= 127)
+      c = '?';
+  value. toNumberDate ();
+  
+  return new Data (parent_arg, true, colonInName_arg, move (attr. name), move (value));
+}
+
+
+
+void Data::readEndTag (TokenInput &ti,
+                       const string &name_arg)
+{
+  Token end (ti. get ());
+  if (end. type != Token::eName)
+    ti. error ("Name");
+  readColonName (ti, end. name);
+  if (end. name != name_arg)
+    ti. error ("Name " + strQuote (name_arg));
+  ti. get ('>');
+}
+
+
+
 Data* Data::load (const string &fName,
                   VectorOwn<Data> &markupDeclarations)
 { 
@@ -784,13 +853,114 @@ bool Data::find (VectorPtr<Data> &path,
 
 TextTable Data::unify (const Data& query,
                        const string &variableTagName) const
+{
+  size_t columnTags_root = 0;
+  TextTable tt (unifyTable (query, variableTagName, columnTags_root));
+  
+  map<string,StringVector> tag2values;
+  unify_ (query, variableTagName, columnTags_root, tag2values, tt);
+  
+  return tt;
+}
+
+
+
+TextTable Data::unifyFile (const string &fName,
+                           const Data& query,
+                           const string &variableTagName)
+{
+  const Data* queryChild = nullptr;
+  bool streamable = query. token. empty () && ! query. name2child (variableTagName);
+  for (const Data* child : query. children)
+    if (child->name != variableTagName)
+    {
+      if (queryChild)
+        streamable = false;
+      queryChild = child;
+    }
+  if (! streamable)
+  {
+    // The order of the unified rows depends on the order of query.children
+	  VectorOwn<Data> markupDeclarations;
+	  unique_ptr<const Data> target (load (fName, markupDeclarations));
+    target->qc ();
+    return target->unify (query, variableTagName);
+  }
+  
+  
+  // = unify_() of the root
+  struct UnifyReader : Reader
+  {
+    const Data& query;
+    const Data* queryChild;
+    const string& variableTagName;
+    size_t columnTags_root {0};
+    TextTable tt;
+    map<string,StringVector> child_tag2values;
+    bool nameFound {false};
+    bool found {false};
+    
+    UnifyReader (const string &fName_arg,
+                 const Data& query_arg,
+                 const Data* queryChild_arg,
+                 const string& variableTagName_arg)
+      : Reader (fName_arg, "*/*")
+      , query (query_arg)
+      , queryChild (queryChild_arg)
+      , variableTagName (variableTagName_arg)
+      , tt (unifyTable (query_arg, variableTagName_arg, columnTags_root))
+      {}
+      
+    void elementStart (bool /*colonInName*/) final
+      { if (path. size () == 1)
+          nameFound = (path. front () == query. name);
+      }
+    void processSubtree (Data* data) final
+      { const unique_ptr<const Data> data_ (data);
+        if (path. size () != 1)
+          return;
+        data->qc ();
+        if (   nameFound
+            && queryChild
+            && data->unify_ (*queryChild, variableTagName, columnTags_root, child_tag2values, tt)
+           )
+          found = true;
+      }
+    void finish ()
+      { if (! nameFound)
+          return;
+        if (queryChild && ! found && ! queryChild->columnTags)
+          return;
+        if (   query. columnTags == columnTags_root
+            && ! child_tag2values. empty ()
+           )
+        {
+          StringVector row (tt. header. size ());
+          for (const auto& it : child_tag2values)
+            row [tt. col2num (it. first)] = it. second. toString ("; ");
+          tt. rows << move (row);
+        }
+      }
+  };
+  UnifyReader reader (fName, query, queryChild, variableTagName);
+  reader. run ();
+  reader. finish ();
+  
+  return move (reader. tt);
+}
+
+
+
+TextTable Data::unifyTable (const Data& query,
+                            const string &variableTagName,
+                            size_t &columnTags_root)
 {
   StringVector header (query. tagName2texts (variableTagName));
   ASSERT (header. size () == query. columnTags);
   if (header. empty ())  
     throw runtime_error ("No variable tags");
     
-  const size_t columnTags_root = header. size ();
+  columnTags_root = header. size ();
   
   header. sort ();
   header. uniq ();
@@ -801,9 +971,6 @@ TextTable Data::unify (const Data& query,
     tt. header << TextTable::Header (s);
   tt. qc ();
   
-  map<string,StringVector> tag2values;
-  unify_ (query, variableTagName, columnTags_root, tag2values, tt);
-  
   return tt;
 }
 
@@ -906,32 +1073,74 @@ Schema* Data::createSchema (bool storeTokens) const
   auto sch = new Schema (nullptr, storeTokens);
   
   for (const Data* child : children)
-  {
-    Schema* other = child->createSchema (storeTokens);
-    other->parent = sch;
-    if (const Schema* childSch = findPtr (sch->name2schema, child->name))
-    {
-      var_cast (childSch) -> multiple = true;
-      var_cast (childSch) -> merge (*other);
-      delete other;
-    }
-    else
-      sch->name2schema [child->name] = other;
-  }
+    sch->addChild (child->name, child->createSchema (storeTokens));
 
-  if (! token. empty ())
-  {
-    sch->types << token. type;
-    if (storeTokens)
-      sch->tokens << token;
-    sch->len_max = token. name. size ();
-  }
+  sch->addToken (token);
   
   return sch;
 }
 
 
 
+Schema* Data::createSchemaFile (const string &fName,
+                                bool storeTokens,
+                                string &name)
+{
+  struct SchemaReader : Reader
+  {
+    const bool storeTokens;
+    Vector<Schema*> schemas;
+      // Of path
+    unique_ptr<Schema> root;
+    string rootName;
+    
+    SchemaReader (const string &fName_arg,
+                  bool storeTokens_arg)
+      : Reader (fName_arg, "*/*")
+      , storeTokens (storeTokens_arg)
+      {}
+   ~SchemaReader ()
+      { for (const Schema* sch : schemas)
+          delete sch;
+      }
+      
+    void elementStart (bool /*colonInName*/) final
+      { if (path. size () == 1)
+          rootName = path. front ();
+        schemas << new Schema (nullptr, storeTokens); 
+      }
+    void processSubtree (Data* data) final
+      { const unique_ptr<const Data> data_ (data);
+        if (schemas. empty ())
+          return;
+        data->qc ();
+        schemas. back () -> addChild (data->name, data->createSchema (storeTokens));
+      }
+    void text (Token &&token) final
+      { schemas. back () -> addToken (token); }
+    void elementEnd () final
+      { Schema* sch = schemas. back ();
+        schemas. pop_back ();
+        if (schemas. empty ())
+        {
+          ASSERT (! root. get ());
+          root. reset (sch);
+        }
+        else
+          schemas. back () -> addChild (path. back (), sch);
+      }
+  };
+  SchemaReader reader (fName, storeTokens);
+  reader. run ();
+  ASSERT (reader. schemas. empty ());
+  QC_ASSERT (reader. root. get ());
+  
+  name = move (reader. rootName);
+  return reader. root. release ();
+}
+
+
+
 void Data::writeFiles (size_t xmlNum,
                        const Schema* sch,
                        FlatTable* flatTable) const
@@ -968,4 +1177,184 @@ void Data::writeFiles (size_t xmlNum,
 }
 
 
+
+
+
+void Data::writeFilesFile (const string &fName,
+                           size_t xmlNum,
+                           const Schema* sch)
+{
+  QC_ASSERT (sch);
+  QC_ASSERT (! sch->flatTable. get ());
+  
+  struct FlatReader : Reader
+  {
+    const size_t xmlNum;
+    const Schema* sch;
+    
+    FlatReader (const string &fName_arg,
+                size_t xmlNum_arg,
+                const Schema* sch_arg)
+      : Reader (fName_arg, "*/*")
+      , xmlNum (xmlNum_arg)
+      , sch (sch_arg)
+      {}
+      
+    void elementStart (bool colonInName) final
+      { if (path. size () == 1)  // = root Data::qc()
+          QC_IMPLY (! colonInName, isIdentifier (path. back (), true));
+      }
+    void processSubtree (Data* data) final
+      { const unique_ptr<const Data> data_ (data);
+        if (path. size () != 1)
+          return;
+        data->qc ();
+        if (const Schema* childSch = findPtr (sch->name2schema, data->name))
+          data->writeFiles (xmlNum, childSch, nullptr);
+        else
+          throw runtime_error ("Schema-XML mismatch: " + data->name);
+      }
+  };
+  FlatReader reader (fName, xmlNum, sch);
+  reader. run ();
+}
+
+
+
+
+// Reader
+
+Reader::Reader (const string &fName,
+                const string &subtreePath_arg)
+: ti (fName, '\0', true, false, 1000)  // PAR
+, subtreePath (subtreePath_arg, '/', true)
+{
+  QC_ASSERT (! subtreePath. empty ());
+  for (const string& s : subtreePath)
+    QC_ASSERT (! s. empty ());
+}
+
+
+
+void Reader::run ()
+{
+  ASSERT (path. empty ());
+  
+  Unverbose unv;
+  try
+  {
+    // = Data::Data(TokenInput&,VectorOwn<Data>&)
+    ti. get ('<');
+    ti. get ('?');
+    ti. get ("xml");
+    for (;;)
+    {
+      const Token t (ti. get ());
+      if (t. isDelimiter ('>'))
+        break;
+      if (t. empty ())
+        throw runtime_error ("XML header is not finished");
+    }
+    
+    for (;;)
+    {
+      if (ti. getNextChar () != '<')
+        ti. error ("'<'");
+      ti. get ('<');
+      Token nameT (ti. get ());
+      if (nameT. isDelimiter ('!'))
+        markupDeclarations << new Data (ti, move (nameT));
+      else
+      {
+        readElement (move (nameT));
+        break;
+      }
+    }
+  }
+  catch (const exception &e)
+    { ti. error (e. what (), false); }
+    
+  const Token t (ti. get ());
+  if (! t. empty ())
+    ti. error ("Token after the XML end: " + strQuote (t. str ()), false);
+}
+
+
+
+bool Reader::pathMatches (const StringVector &pattern) const
+{
+  if (pattern. size () != path. size ())
+    return false;
+  FFOR (size_t, i, path. size ())
+    if (   pattern [i] != "*"
+        && pattern [i] != path [i]
+       )
+      return false;
+  return true;
+}
+
+
+
+void Reader::readElement (Token &&nameT)
+{
+  if (   nameT. isDelimiter ('!')
+      || nameT. isDelimiter ('?')
+     )
+  {
+    processSubtree (new Data (ti, move (nameT)));
+    return;
+  }
+  if (nameT. type != Token::eName)
+    ti. error ("Name");
+    
+  string name (move (nameT. name));
+  const bool colonInName = Data::readColonName (ti, name);
+  
+  path << name;
+  if (pathMatches (subtreePath))
+  {
+    path. pop_back ();
+    processSubtree (new Data (ti, move (name), colonInName));
+    return;
+  }
+  
+  elementStart (colonInName);
+
+  bool finished = false;
+  while (Data* attr = Data::readAttribute (ti, nullptr, finished))
+    processSubtree (attr);
+
+  if (! finished)
+  {
+    if (ti. getNextChar () == '<')
+      for (;;)
+      {
+        ti. get ('<');
+        Token t (ti. get ());
+        if (t. isDelimiter ('/'))
+        {
+          Data::readEndTag (ti, name);
+          break;
+        }
+        readElement (move (t));
+        if (ti. getNextChar () != '<')
+          ti. error ("Text after child elements of a streamed element " + strQuote (name) + " is not supported", false);
+      }
+    else
+    {
+      Token token (ti. getXmlText ());
+      token. toNumberDate ();
+      ti. get ('/');
+      Data::readEndTag (ti, name);
+      if (! token. empty ())
+        text (move (token));
+    }
+  }
+  
+  elementEnd ();
+  path. pop_back ();
+}
+
+
+
 }
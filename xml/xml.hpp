@@ -129,6 +129,10 @@ public:
       throw logic_error ("Schema::schema2name()");
     }
   void merge (Schema& other);
+  void addChild (const string &childName,
+                 Schema* other);
+    // Input: other: new
+  void addToken (const Token &token);
 
   // SQL      
   string getColumnName (const Schema* rootTable) const
@@ -149,6 +153,8 @@ private:
 public:
   
   // Output: flatTable, column
+  void getTableNames (StringVector &tableNames) const;
+    // Update: tableNames: file names of flatTable's
   void setFlatTables (const string &dirName,
                       const Schema* curTable);
 private:
@@ -159,8 +165,14 @@ public:
 
 
 
+struct Reader;
+
+
+
 struct Data : Named
 {
+  friend Reader;
+
   // Tree
   const Data* parent {nullptr};
   VectorOwn<Data> children;
@@ -185,6 +197,17 @@ private:
     : parent (parent_arg)
     , attribute (false)
     { readInput (ti); }
+  Data (TokenInput &ti,
+        Token &&nameT)
+    : attribute (false)
+    { readTag (ti, move (nameT)); }
+  Data (TokenInput &ti,
+        string &&name_arg,
+        bool colonInName_arg)
+    : Named (move (name_arg))
+    , attribute (false)
+    , colonInName (colonInName_arg)
+    { readBody (ti); }
   Data (Data* parent_arg,
         bool attribute_arg,
         bool colonInName_arg,
@@ -205,9 +228,22 @@ private:
     // </tag>
     // <!-- comment -->
     // <? ProcessingInstruction ?>
+  void readTag (TokenInput &ti,
+                Token &&nameT);
+    // Input: nameT: the token after '<'
+  void readBody (TokenInput &ti);
+    // Input: name, isEnd
   static bool readColonName (TokenInput &ti,
                              string &name);
     // Update: name
+  static Data* readAttribute (TokenInput &ti,
+                              Data* parent_arg,
+                              bool &finished);
+    // Return: new; nullptr <=> end of the attributes
+    // Output: finished: "/>"
+  static void readEndTag (TokenInput &ti,
+                          const string &name_arg);
+    // Input: "</" has been read
 public:
   static Data* load (const string &fName,
                      VectorOwn<Data> &markupDeclarations);
@@ -257,7 +293,16 @@ public:
     }
   TextTable unify (const Data& query,
                    const string &variableTagName) const;
+  static TextTable unifyFile (const string &fName,
+                              const Data& query,
+                              const string &variableTagName);
+    // Streaming unify() with the target XML file fName
+    // If query cannot be unified by streaming then the target XML file is loaded in memory
 private:
+  static TextTable unifyTable (const Data& query,
+                               const string &variableTagName,
+                               size_t &columnTags_root);
+    // Output: columnTags_root
   StringVector tagName2texts (const string &tagName) const;
     // Output: columnTags
   bool unify_ (const Data& query,
@@ -269,9 +314,76 @@ private:
 public:
   Schema* createSchema (bool storeTokens) const;
     // Return: new
+  static Schema* createSchemaFile (const string &fName,
+                                   bool storeTokens,
+                                   string &name);
+    // Streaming createSchema() of XML file fName
+    // Return: new
+    // Output: name: root tag name
   void writeFiles (size_t xmlNum,
                    const Schema* sch,
                    FlatTable* flatTable) const;
+  static void writeFilesFile (const string &fName,
+                              size_t xmlNum,
+                              const Schema* sch);
+    // Streaming writeFiles() of XML file fName
+    // Input: sch: root
+};
+
+
+
+
+
+
+
+
+struct Reader : Nocopy
+// Streaming (SAX-style) XML reader
+// Memory: the open elements and one Data subtree
+{
+protected:
+  TokenInput ti;
+private:
+  const StringVector subtreePath;
+    // "*" matches any tag name
+public:
+  VectorOwn<Data> markupDeclarations;
+  StringVector path;
+    // Tag names of the open streamed elements, the root first
+
+
+  Reader (const string &fName,
+          const string &subtreePath_arg);
+    // Input: subtreePath_arg: tag names separated by '/', e.g. "PubmedArticleSet/PubmedArticle" or "*/*"
+    // Tag names may contain '-'
+  virtual ~Reader ()
+    {}
+
+
+  void run ();
+    // Invokes: event functions
+    // The exceptions of parsing and of the event functions are reported with the file position
+  bool pathMatches (const StringVector &pattern) const;
+    // Return: path matches pattern
+protected:
+  // Events
+  virtual void elementStart (bool /*colonInName*/) 
+    {}
+    // Input: path.back(): the element tag name
+  virtual void processSubtree (Data* data) = 0;
+    // Input: data: new, to be deleted
+    //              attribute, comment, processing instruction or an element whose path matches subtreePath
+    //        path: the open elements containing data
+  virtual void text (Token &&/*token*/) 
+    {}
+    // Input: path.back(): the element containing the text and no child elements
+  virtual void elementEnd () 
+    {}
+    // Input: path.back(): the element tag name
+private:
+  void readElement (Token &&nameT);
+    // Input: nameT: the token after '<'
+    // Text after child elements is not supported
 };
 
 
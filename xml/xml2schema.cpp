@@ -54,6 +54,7 @@ struct ThisApplication : Application
   	  addPositional ("xml", "XML file");
   	  addKey ("print", "Output XML file");
   	  addFlag ("store_values", "Store all field values in schema");
+  	  addFlag ("in_memory", "Load the whole XML file in memory, otherwise the XML file is streamed");
   	}
   	
   	
@@ -63,22 +64,32 @@ struct ThisApplication : Application
 		const string xmlFName   = getArg ("xml");
 		const string printFName = getArg ("print");
 		const bool storeValues  = getFlag ("store_values");
+		const bool inMemory     = getFlag ("in_memory");
 	
 	
-	  VectorOwn<Xml_sp::Data> markupDeclarations;
-	  unique_ptr<const Xml_sp::Data> xml (Xml_sp::Data::load (xmlFName, markupDeclarations));
-    xml->qc ();
-    
-    if (! printFName. empty ())
+    string name;
+    unique_ptr<Xml_sp::Schema> sch;
+    if (inMemory || ! printFName. empty ())
     {
-      Xml::File f (printFName, true, true, "XML");  // PAR
-      xml->saveXml (f);
-      cout << endl << endl;
+  	  VectorOwn<Xml_sp::Data> markupDeclarations;
+  	  unique_ptr<const Xml_sp::Data> xml (Xml_sp::Data::load (xmlFName, markupDeclarations));
+      xml->qc ();
+      
+      if (! printFName. empty ())
+      {
+        Xml::File f (printFName, true, true, "XML");  // PAR
+        xml->saveXml (f);
+        cout << endl << endl;
+      }
+  
+      sch. reset (xml->createSchema (storeValues));
+      name = xml->name;
     }
-
-    unique_ptr<Xml_sp::Schema> sch (xml->createSchema (storeValues));
+    else
+      sch. reset (Xml_sp::Data::createSchemaFile (xmlFName, storeValues, name));
     sch->qc ();
-    cout << xml->name;
+    
+    cout << name;
     sch->saveText (cout);
     cout << endl;
 	}
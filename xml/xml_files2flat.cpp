@@ -0,0 +1,226 @@
+// xml_files2flat.cpp
+
+/*===========================================================================
+*
+*                            PUBLIC DOMAIN NOTICE                          
+*               National Center for Biotechnology Information
+*                                                                          
+*  This software/database is a "United States Government Work" under the   
+*  terms of the United States Copyright Act.  It was written as part of    
+*  the author's official duties as a United States Government employee and 
+*  thus cannot be copyrighted.  This software/database is freely available 
+*  to the public for use. The National Library of Medicine and the U.S.    
+*  Government have not placed any restriction on its use or reproduction.  
+*                                                                          
+*  Although all reasonable efforts have been taken to ensure the accuracy  
+*  and reliability of the software and data, the NLM and the U.S.          
+*  Government do not and cannot warrant the performance or results that    
+*  may be obtained by using this software or data. The NLM and the U.S.    
+*  Government disclaim all warranties, express or implied, including       
+*  warranties of performance, merchantability or fitness for any particular
+*  purpose.                                                                
+*                                                                          
+*  Please cite the author in any work or product based on this material.   
+*
+* ===========================================================================
+*
+* Author: Vyacheslav Brover
+*
+* File Description:
+*   Generate tab-delimited files for SQL bulk insert from a list of XML files in parallel
+*
+*/
+
+#undef NDEBUG
+#include "../common.inc"
+
+#include "../common.hpp"
+using namespace Common_sp;
+#include "xml.hpp"
+#include "../version.inc"
+
+
+
+namespace
+{
+
+
+struct XmlFile
+{
+  string fName;
+  size_t num {0};
+  // Derived
+  unique_ptr<Xml_sp::Schema> schema;
+  string rootName;
+};
+
+
+
+void deriveSchemas (size_t from,
+                    size_t to,
+                    Notype /*&res*/,
+                    Vector<XmlFile> &xmlFiles)
+{
+  FOR_START (size_t, i, from, to)
+  {
+    XmlFile& xf = xmlFiles [i];
+    xf. schema. reset (Xml_sp::Data::createSchemaFile (xf. fName, false, xf. rootName));
+    xf. schema->qc ();
+  }
+}
+
+
+
+void writeFragments (size_t from,
+                     size_t to,
+                     Notype /*&res*/,
+                     const Vector<XmlFile> &xmlFiles,
+                     const string &schemaFName,
+                     const string &fragmentDirName)
+{
+  FOR_START (size_t, i, from, to)
+  {
+    const XmlFile& xf = xmlFiles [i];
+    string schemaName;
+    unique_ptr<Xml_sp::Schema> sch (Xml_sp::Schema::readSchema (schemaFName, schemaName));
+    const string dirName (fragmentDirName + to_string (i) + "/");
+    createDirectory (dirName);
+    sch->setFlatTables (dirName, nullptr);
+    sch->qc ();
+    Xml_sp::Data::writeFilesFile (xf. fName, xf. num, sch. get ());
+  }
+}
+
+
+
+void concatFragments (size_t from,
+                      size_t to,
+                      Notype /*&res*/,
+                      const StringVector &tableNames,
+                      size_t xmlFiles_size,
+                      const string &fragmentDirName,
+                      const string &outDirName)
+{
+  FOR_START (size_t, i, from, to)
+  {
+    const string& tableName = tableNames [i];
+    OFStream f (outDirName + tableName);
+    FFOR (size_t, j, xmlFiles_size)
+      copyText (fragmentDirName + to_string (j) + "/" + tableName, 0, f);
+  }
+}
+
+
+
+struct ThisApplication : Application
+{
+  ThisApplication ()
+    : Application ("Generate tab-delimited files for SQL bulk insert from a list of XML files in parallel. Each XML file is processed into its own fragments of the tab-delimited files, which are concatenated in the order of the list")
+  	{
+      version = VERSION;
+  	  addPositional ("xml_list", "List of XML files with optional XML file numbers: <XML file> [<XML file number>]. If the number is missing then the line number is used");
+  	  addPositional ("schema", "XML schema file");
+  	  addPositional ("out_dir", "Directory for output tab-delimited files");
+  	  addFlag ("derive_schema", "Derive the schema of each XML file, merge the schemas in the order of <xml_list> and save the merged schema into <schema>");
+  	}
+
+
+
+	void body () const final
+	{
+		const string xmlListFName = getArg ("xml_list");
+		const string schemaFName  = getArg ("schema");
+		      string outDirName   = getArg ("out_dir");
+		const bool deriveSchema   = getFlag ("derive_schema");
+
+		addDirSlash (outDirName);
+
+
+		Vector<XmlFile> xmlFiles;
+		{
+      LineInput f (xmlListFName);
+      Istringstream iss;
+      while (f. nextLine ())
+      {
+        trim (f. line);
+        if (f. line. empty ())
+          continue;
+        iss. reset (f. line);
+        XmlFile xf;
+        iss >> xf. fName;
+        if (iss. eof ())
+          xf. num = f. lineNum;
+        else
+          iss >> xf. num;
+        QC_ASSERT (! xf. fName. empty ());
+        QC_ASSERT (xf. num);
+        xmlFiles << move (xf);
+      }
+    }
+    if (xmlFiles. empty ())
+      throw runtime_error ("No XML files");
+
+
+    if (deriveSchema)
+    {
+      {
+        vector<Notype> notypes;
+        arrayThreads (true, deriveSchemas, xmlFiles. size (), notypes, ref (xmlFiles));
+      }
+      // Deterministic merge
+      XmlFile& first = xmlFiles. front ();
+      unique_ptr<Xml_sp::Schema> sch (move (first. schema));
+      for (XmlFile& xf : xmlFiles)
+        if (xf. schema. get ())
+        {
+          if (xf. rootName != first. rootName)
+            throw runtime_error ("XML file " + strQuote (xf. fName) + " has root " + strQuote (xf. rootName) + ", expected: " + strQuote (first. rootName));
+          sch->merge (*xf. schema);
+          xf. schema. reset ();
+        }
+      sch->qc ();
+      OFStream f (schemaFName);
+      f << first. rootName;
+      sch->saveText (f);
+      f << endl;
+    }
+
+
+    StringVector tableNames;
+    {
+  	  string schemaName;
+  	  unique_ptr<const Xml_sp::Schema> sch (Xml_sp::Schema::readSchema (schemaFName, schemaName));
+  	  sch->qc ();
+  	  sch->getTableNames (tableNames);
+  	}
+  	
+  	
+  	const string fragmentDirName (outDirName + ".fragments/");
+  	createDirectory (fragmentDirName);
+    {
+      vector<Notype> notypes;
+      arrayThreads (true, writeFragments, xmlFiles. size (), notypes, cref (xmlFiles), cref (schemaFName), cref (fragmentDirName));
+    }
+    {
+      vector<Notype> notypes;
+      arrayThreads (true, concatFragments, tableNames. size (), notypes, cref (tableNames), xmlFiles. size (), cref (fragmentDirName), cref (outDirName));
+    }
+    removeDirectory (fragmentDirName);
+	}
+};
+
+
+
+}  // namespace
+
+
+
+int main (int argc,
+          const char* argv[])
+{
+  ThisApplication app;
+  return app. run (argc, argv);
+}
+
+
+
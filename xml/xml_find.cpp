@@ -54,6 +54,7 @@ struct ThisApplication : Application
   	  addPositional ("target", "Target XML file");
   	  addPositional ("query", "Query XML file");
   	  addKey ("variable_tag", "Tag name in query indicating tsv-columns", "q");
+  	  addFlag ("in_memory", "Load the whole target XML file in memory, otherwise the target XML file is streamed");
   	}
   	
   	
@@ -63,14 +64,11 @@ struct ThisApplication : Application
 		const string targetFName = getArg ("target");
 		const string queryFName  = getArg ("query");
 		const string variableTag = getArg ("variable_tag");
+		const bool inMemory      = getFlag ("in_memory");
 		
 		QC_ASSERT (! variableTag. empty ());
 	
 	
-	  VectorOwn<Xml_sp::Data> targetMarkupDeclarations;
-	  unique_ptr<const Xml_sp::Data> target (Xml_sp::Data::load (targetFName, targetMarkupDeclarations));
-    target->qc ();
-
 	  VectorOwn<Xml_sp::Data> queryMarkupDeclarations;
 	  unique_ptr<const Xml_sp::Data> query (Xml_sp::Data::load (queryFName, queryMarkupDeclarations));
     query->qc ();
@@ -81,7 +79,16 @@ struct ThisApplication : Application
       cout << endl << endl;
     }
           
-    const TextTable tt (target->unify (*query, variableTag));
+    TextTable tt;
+    if (inMemory)
+    {
+  	  VectorOwn<Xml_sp::Data> targetMarkupDeclarations;
+  	  unique_ptr<const Xml_sp::Data> target (Xml_sp::Data::load (targetFName, targetMarkupDeclarations));
+      target->qc ();
+      tt = target->unify (*query, variableTag);
+    }
+    else
+      tt = Xml_sp::Data::unifyFile (targetFName, *query, variableTag);
     tt. qc ();
     tt. saveText (cout);
 	}
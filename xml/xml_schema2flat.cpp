@@ -74,21 +74,6 @@ struct ThisApplication : Application
 	  unique_ptr<Xml_sp::Schema> sch (Xml_sp::Schema::readSchema (schemaFName, schemaName));
 	  sch->qc ();
 	  
-	  unique_ptr<const Xml_sp::Data> xml;
-	  {
-  	  TokenInput ti (xmlFName, '\0', false, false, 1000);  // PAR 
-      try
-      {	  
-    	  VectorOwn<Xml_sp::Data> markupDeclarations;
-        xml. reset (new Xml_sp::Data (ti, markupDeclarations));	
-      }
-    //catch (const CharInput::Error &e)
-      //{ throw e; }
-      catch (const exception &e)
-        { ti. error (e. what (), false); }
-    }    
-    xml->qc ();
-    
     sch->setFlatTables (dirName, nullptr);
     sch->qc ();
     
@@ -98,7 +83,7 @@ struct ThisApplication : Application
     cout << endl;
   #endif
     
-    xml->writeFiles (xml_num, sch. get (), nullptr);
+    Xml_sp::Data::writeFilesFile (xmlFName, xml_num, sch. get ());
 	}
 };
 
@@ -0,0 +1,78 @@
+#!/bin/bash --noprofile
+THIS=`dirname $0`
+source $THIS/../bash_common.sh
+if [ $# -ne 1 ]; then
+  echo "Test streaming vs. in-memory XML processing and time them on a scaled-up pubmed_30217548.xml"
+  echo "#1: number of copies of the PubMed record"
+  exit 1
+fi
+COPIES=$1
+
+
+TMP=`mktemp`
+comment $TMP
+
+
+cat > $TMP.query << EOT
+<?xml version="1.0"?>
+<pub-one-record-set>
+<pub-one-record>
+<document-meta>
+<contrib-group><contrib><name><surname><q>surname</q></surname><given-names><q>given</q></given-names></name></contrib></contrib-group>
+</document-meta>
+</pub-one-record>
+</pub-one-record-set>
+EOT
+
+
+section "Scaled-up XML file"
+head -2 $THIS/pubmed_30217548.xml > $TMP.xml
+tail -n +3 $THIS/pubmed_30217548.xml | sed 's|</pub-one-record-set>||' > $TMP.record
+for ((i = 0; i < $COPIES; i++)); do
+  cat $TMP.record
+done >> $TMP.xml
+echo "</pub-one-record-set>" >> $TMP.xml
+ls -l $TMP.xml
+
+
+for XML in $THIS/pubmed.xml $THIS/pubmed_30217548.xml $TMP.xml; do
+  section "xml2schema: $XML"
+  time $THIS/xml2schema $XML -qc             > $TMP.stream
+  time $THIS/xml2schema $XML -qc  -in_memory > $TMP.mem
+  diff $TMP.stream $TMP.mem
+  section "xml_find: $XML"
+  time $THIS/xml_find $XML $TMP.query -qc             > $TMP.stream
+  time $THIS/xml_find $XML $TMP.query -qc  -in_memory > $TMP.mem
+  diff $TMP.stream $TMP.mem
+done
+
+
+section "xml_files2flat"
+# Line 3 is empty, so 3.xml gets number 4
+echo "$THIS/files2flat/1.xml"    >  $TMP.list
+echo "$THIS/files2flat/2.xml 7"  >> $TMP.list
+echo ""                          >> $TMP.list
+echo "$THIS/files2flat/3.xml"    >> $TMP.list
+mkdir $TMP.flat
+$THIS/xml_files2flat $TMP.list $TMP.schema $TMP.flat -derive_schema -qc -threads 3
+diff $TMP.schema $THIS/files2flat/expected/schema
+for TABLE in book book_author; do
+  diff $TMP.flat/$TABLE $THIS/files2flat/expected/$TABLE
+done
+[ ! -e $TMP.flat/.fragments ]
+section "xml_files2flat vs. xml_schema2flat"
+mkdir $TMP.single
+I=0
+for NUM in 1 7 4; do
+  I=$(( I + 1 ))
+  mkdir $TMP.single/$I
+  $THIS/xml_schema2flat $THIS/files2flat/$I.xml $NUM $TMP.schema $TMP.single/$I -qc
+done
+for TABLE in book book_author; do
+  cat $TMP.single/1/$TABLE $TMP.single/2/$TABLE $TMP.single/3/$TABLE > $TMP.concat
+  diff $TMP.flat/$TABLE $TMP.concat
+done
+
+
+rm -r $TMP*
+success